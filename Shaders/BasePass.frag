@@ -1,4 +1,5 @@
 #version 450 core
+#extension GL_EXT_nonuniform_qualifier : require
 
 layout(location = 0) in Vertex
 {
@@ -14,6 +15,7 @@ layout(location = 3) out vec4 gbufferD;
 
 layout(push_constant) uniform PushConstant {
     uint materialIndex;
+    uint feedbackFrame;
 } pushConstant;
 
 struct Material
@@ -23,11 +25,13 @@ struct Material
     uint metallicRoughnessTextureIndex;
     float roughnessScale;
     float metallicScale;
+    // keeps the 32 byte stride of GLTFMesh::Material
+    uint padding[3];
 };
 
 layout(set = 0, binding = 2) uniform sampler textureSampler;
-layout(set = 0, binding = 3) uniform MaterialBuffer {
-    Material materials[256];
+layout(std430, set = 0, binding = 3) readonly buffer MaterialBuffer {
+    Material materials[];
 };
 
 layout(set = 0, binding = 4) uniform PlaneDistance {
@@ -35,7 +39,14 @@ layout(set = 0, binding = 4) uniform PlaneDistance {
     float zFar;
 } planeDistance;
 
-layout(set = 1, binding = 0) uniform texture2D textureArray[75];
+// the global bindless table, indexed by the texture indices of the materials
+layout(set = 1, binding = 0) uniform texture2D bindlessTextures[];
+
+// finest mip level relative to the bound image each texture was sampled at, read back by
+// TextureResidency to stream levels in and out
+layout(std430, set = 0, binding = 5) buffer MipFeedback {
+    uint requestedMips[];
+};
 
 float LinearizeDepth(float depth) {
     float z = depth * 2.0 - 1.0;
@@ -44,10 +55,23 @@ float LinearizeDepth(float depth) {
 
 void main() {
     Material material = materials[pushConstant.materialIndex];
-    vec4 albedoColor = texture(sampler2D(textureArray[material.albedoTextureIndex], textureSampler), vin.texcoord);  
-    vec3 normal = texture(sampler2D(textureArray[material.normalTextureIndex], textureSampler), vin.texcoord).rgb;  
-    normal = vin.tangentBasis * (2 * normal - 1.0);
-    vec4 metallicRoughness = texture(sampler2D(textureArray[material.metallicRoughnessTextureIndex], textureSampler), vin.texcoord);     
+    vec4 albedoColor = texture(sampler2D(bindlessTextures[material.albedoTextureIndex], textureSampler), vin.texcoord);  
+    // normal maps are cooked to BC5, only xy is stored and z is rebuilt from the unit length
+    vec2 normalXY = texture(sampler2D(bindlessTextures[material.normalTextureIndex], textureSampler), vin.texcoord).rg * 2.0 - 1.0;
+    vec3 normal = vec3(normalXY, sqrt(max(1.0 - dot(normalXY, normalXY), 0.0)));
+    normal = vin.tangentBasis * normal;
+    vec4 metallicRoughness = texture(sampler2D(bindlessTextures[material.metallicRoughnessTextureIndex], textureSampler), vin.texcoord);     
+
+    // lods are queried in uniform control flow, one pixel of every 8x8 tile writes them per frame
+    vec2 albedoLod = textureQueryLod(sampler2D(bindlessTextures[material.albedoTextureIndex], textureSampler), vin.texcoord);
+    vec2 normalLod = textureQueryLod(sampler2D(bindlessTextures[material.normalTextureIndex], textureSampler), vin.texcoord);
+    vec2 metallicRoughnessLod = textureQueryLod(sampler2D(bindlessTextures[material.metallicRoughnessTextureIndex], textureSampler), vin.texcoord);
+    uint tilePixel = pushConstant.feedbackFrame & 63u;
+    if (all(equal(uvec2(gl_FragCoord.xy) & 7u, uvec2(tilePixel & 7u, tilePixel >> 3u)))) {
+        atomicMin(requestedMips[material.albedoTextureIndex], uint(max(albedoLod.y, 0.0)));
+        atomicMin(requestedMips[material.normalTextureIndex], uint(max(normalLod.y, 0.0)));
+        atomicMin(requestedMips[material.metallicRoughnessTextureIndex], uint(max(metallicRoughnessLod.y, 0.0)));
+    }
 
     gbufferA = vec4(vin.position, LinearizeDepth(gl_FragCoord.z));
     gbufferB = vec4(normal, 1.0);
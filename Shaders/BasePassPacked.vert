@@ -0,0 +1,49 @@
+#version 450 core
+
+// PackedVertex, see Source/Runtime/Resource/PackedVertex.h
+layout(location = 0) in vec4 packedPosition; // unorm16 in mesh bounds, w = tangent handedness
+layout(location = 1) in vec2 packedNormal;   // octahedral snorm16
+layout(location = 2) in vec2 packedTangent;  // octahedral snorm16
+layout(location = 3) in vec2 texCoord;       // half float
+
+layout(location = 0) out Vertex
+{
+	vec3 position;
+	vec2 texcoord;
+	mat3 tangentBasis;
+} vout;
+
+layout(set = 0, binding = 0) uniform CameraBuffer {   
+    mat4 view;
+    mat4 proj;
+	mat4 viewproj;
+	vec3 viewPos;
+} cameraData;
+
+layout(set = 0, binding = 1) uniform LightProjection {   
+    mat4 viewproj;
+} lightProjection;
+
+layout(push_constant) uniform PushConstant {
+    uint materialIndex;
+    vec4 positionOffset;
+    vec4 positionScale;
+} pushConstant;
+
+vec3 DecodeOctahedral(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+void main() {
+    vec3 normal = DecodeOctahedral(packedNormal);
+    vec3 tangent = DecodeOctahedral(packedTangent);
+    float handedness = packedPosition.w * 2.0 - 1.0;
+
+    vout.position = pushConstant.positionOffset.xyz + packedPosition.xyz * pushConstant.positionScale.xyz;
+    gl_Position = cameraData.viewproj * vec4(vout.position, 1.0);
+    vout.texcoord = texCoord;
+    vout.tangentBasis = mat3(tangent, cross(normal, tangent) * handedness, normal);
+}
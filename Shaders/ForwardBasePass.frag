@@ -108,7 +108,7 @@ vec3 iblCalc(Material material, vec3 f0, vec3 lo, vec3 li, vec3 lh) {
 	vec3 diffuseIBL = kd * material.albedo * irradiance;
 
 	int specularTextureLevels = textureQueryLevels(iblSepcTexture);
-	vec3 specularIrradiance = textureLod(iblSepcTexture, lr, material.roughness * specularTextureLevels).rgb;
+	vec3 specularIrradiance = textureLod(iblSepcTexture, lr, material.roughness * (specularTextureLevels - 1)).rgb;
 
 	vec2 specBRDF = texture(iblSpecBrdfLut, vec2(cosLo, material.roughness)).rg;
 
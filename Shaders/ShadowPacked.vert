@@ -0,0 +1,19 @@
+#version 450 core
+
+// PackedVertex, see Source/Runtime/Resource/PackedVertex.h. Only the position is needed here.
+layout(location = 0) in vec4 packedPosition;
+
+layout(set = 0, binding = 0) uniform LightProjection {   
+    mat4 viewproj;
+} lightProjection;
+
+layout(push_constant) uniform PushConstant {
+    uint materialIndex;
+    vec4 positionOffset;
+    vec4 positionScale;
+} pushConstant;
+
+void main() {
+    vec3 position = pushConstant.positionOffset.xyz + packedPosition.xyz * pushConstant.positionScale.xyz;
+    gl_Position = lightProjection.viewproj * vec4(position, 1.0f);
+}
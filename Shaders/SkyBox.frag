@@ -7,5 +7,5 @@ layout(location = 0) out vec4 outColor;
 layout(set = 0, binding = 1) uniform samplerCube SkyboxCubemap;
 
 void main() {
-    outColor = vec4(texture(SkyboxCubemap, normalize(viewPos)).rgb, 1.0);
+    outColor = vec4(textureLod(SkyboxCubemap, normalize(viewPos), 0.0).rgb, 1.0);
 }
\ No newline at end of file
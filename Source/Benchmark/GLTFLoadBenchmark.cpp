@@ -0,0 +1,61 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <string>
+
+#include "Runtime/Base/Macro.h"
+#include "Runtime/Base/Parallel.h"
+#include "Runtime/Resource/GLTFLoader.h"
+
+// Loads a glTF or glb file and cooks its textures, once with every ParallelFor run serially and
+// once on the thread pool, and reports the best time of each.
+// Usage: GLTFLoadBenchmark [path] [iterations], the path defaults to the Sponza scene.
+namespace wind {
+struct LoadTimes {
+    double load = 0.0;
+    double cook = 0.0;
+};
+
+static LoadTimes Measure(const std::string& path, uint32_t iterations) {
+    using Clock        = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+    LoadTimes best{std::numeric_limits<double>::max(), std::numeric_limits<double>::max()};
+    for (uint32_t i = 0; i < iterations; ++i) {
+        auto start = Clock::now();
+        auto model = gltf::GLTFLoader::LoadFromFile(path);
+        auto load  = Clock::now();
+        gltf::GLTFLoader::CookTextures(model);
+        auto cook = Clock::now();
+
+        best.load = std::min(best.load, Milliseconds(load - start).count());
+        best.cook = std::min(best.cook, Milliseconds(cook - load).count());
+    }
+    return best;
+}
+
+static void Run(const std::string& path, uint32_t iterations) {
+    auto& pool = utils::ThreadPool::Get();
+    // the first load also warms the file cache for both measurements
+    (void)gltf::GLTFLoader::LoadFromFile(path);
+
+    pool.SetThreadLimit(1);
+    LoadTimes serial = Measure(path, iterations);
+    pool.SetThreadLimit(SIZE_MAX);
+    LoadTimes parallel = Measure(path, iterations);
+
+    WIND_CORE_INFO("Load {}: serial {:.2f} ms, {} threads {:.2f} ms, {:.2f}x", path, serial.load,
+                   pool.GetThreadCount(), parallel.load, serial.load / parallel.load);
+    WIND_CORE_INFO("Cook textures: serial {:.2f} ms, {} threads {:.2f} ms, {:.2f}x", serial.cook,
+                   pool.GetThreadCount(), parallel.cook, serial.cook / parallel.cook);
+}
+} // namespace wind
+
+auto main(int argc, char** argv) -> int {
+    wind::Log::Init();
+    std::string path       = argc > 1 ? argv[1] : "Assets/Scene/Sponza/glTF/Sponza.gltf";
+    uint32_t    iterations = argc > 2 ? (uint32_t)std::atoi(argv[2]) : 3;
+    wind::Run(path, std::max(iterations, 1u));
+    return 0;
+}
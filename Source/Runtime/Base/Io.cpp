@@ -1,8 +1,14 @@
 #include "Io.h"
 
+#include <algorithm>
+#include <filesystem>
 #include <fstream>
 #include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 
+#include <assimp/DefaultIOSystem.h>
 #include <assimp/DefaultLogger.hpp>
 #include <assimp/Importer.hpp>
 #include <assimp/LogStream.hpp>
@@ -10,13 +16,127 @@
 #include <assimp/scene.h>
 
 #include "Runtime/Base/Macro.h"
+#include "Runtime/Base/Parallel.h"
+#include "Runtime/Resource/MeshCache.h"
+#include "Runtime/Resource/MeshOptimizer.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 static const unsigned int ImportFlags =
     aiProcess_CalcTangentSpace | aiProcess_Triangulate | aiProcess_SortByPType |
     aiProcess_PreTransformVertices | aiProcess_GenNormals | aiProcess_GenUVCoords |
-    aiProcess_OptimizeMeshes | aiProcess_Debone | aiProcess_ValidateDataStructure;
+    aiProcess_JoinIdenticalVertices | aiProcess_OptimizeMeshes | aiProcess_Debone |
+    aiProcess_ValidateDataStructure;
 
 namespace wind::io {
+MappedFile::MappedFile(std::string_view filename) {
+    std::string path{filename};
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        WIND_CORE_ERROR("Failed to open file {} for mapping!", filename);
+        return;
+    }
+
+    LARGE_INTEGER fileSize{};
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        WIND_CORE_ERROR("Failed to query size of file {}!", filename);
+        CloseHandle(file);
+        return;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        WIND_CORE_ERROR("Failed to create file mapping for {}!", filename);
+        CloseHandle(file);
+        return;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        WIND_CORE_ERROR("Failed to map view of file {}!", filename);
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return;
+    }
+
+    m_fileHandle    = file;
+    m_mappingHandle = mapping;
+    m_data          = static_cast<const uint8_t*>(view);
+    m_size          = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        WIND_CORE_ERROR("Failed to open file {} for mapping!", filename);
+        return;
+    }
+
+    struct stat fileStat {};
+    if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0) {
+        WIND_CORE_ERROR("Failed to query size of file {}!", filename);
+        close(file);
+        return;
+    }
+
+    void* view =
+        mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    // the mapping keeps its own reference to the file
+    close(file);
+    if (view == MAP_FAILED) {
+        WIND_CORE_ERROR("Failed to map file {}!", filename);
+        return;
+    }
+
+    m_data = static_cast<const uint8_t*>(view);
+    m_size = static_cast<size_t>(fileStat.st_size);
+#endif
+}
+
+MappedFile::~MappedFile() { Close(); }
+
+MappedFile::MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this == &other) return *this;
+    Close();
+    std::swap(m_data, other.m_data);
+    std::swap(m_size, other.m_size);
+#ifdef _WIN32
+    std::swap(m_fileHandle, other.m_fileHandle);
+    std::swap(m_mappingHandle, other.m_mappingHandle);
+#endif
+    return *this;
+}
+
+void MappedFile::Close() {
+    if (m_data == nullptr) return;
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_mappingHandle);
+    CloseHandle(m_fileHandle);
+    m_fileHandle    = nullptr;
+    m_mappingHandle = nullptr;
+#else
+    munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+    m_data = nullptr;
+    m_size = 0;
+}
+
 std::vector<char> ReadFile(std::string_view filename) {
     std::ifstream file(filename.data(), std::ios::ate | std::ios::binary);
 
@@ -48,40 +168,145 @@ std::vector<uint32_t> ReadSpirvBinaryFile(std::string_view filename) {
     return spv;
 }
 
-Model::Builder LoadModelFromFilePath(std::string_view filename) {
-    Model::Builder   builder;
-    Assimp::Importer importer;
-    auto             scene = importer.ReadFile(filename.data(), ImportFlags);
-    
-    if (!scene || !scene->HasMeshes()) { WIND_CORE_ERROR("Import mesh is broken!"); }
-    aiMesh*             mesh = scene->mMeshes[0];
-    std::vector<Vertex> vertices;
-
-    for (size_t i = 0; i < mesh->mNumVertices; ++i) {
-        Vertex vertex;
+// relative paths are resolved against the directory of the model, "*n" names an embedded texture
+static std::string GetTexturePath(const aiMaterial* material, aiTextureType type,
+                                  const std::filesystem::path& directory) {
+    aiString path;
+    if (material->GetTexture(type, 0, &path) != aiReturn_SUCCESS) return {};
+    if (path.length == 0 || path.C_Str()[0] == '*') return {};
+    return (directory / path.C_Str()).lexically_normal().string();
+}
+
+static Model::MaterialInfo ConvertMaterial(const aiMaterial*            material,
+                                           const std::filesystem::path& directory) {
+    auto texturePath = [&](aiTextureType type, aiTextureType fallback) {
+        auto path = GetTexturePath(material, type, directory);
+        return path.empty() ? GetTexturePath(material, fallback, directory) : path;
+    };
+    Model::MaterialInfo info;
+    info.name          = material->GetName().C_Str();
+    info.albedoPath    = texturePath(aiTextureType_BASE_COLOR, aiTextureType_DIFFUSE);
+    info.normalPath    = texturePath(aiTextureType_NORMALS, aiTextureType_HEIGHT);
+    info.metallicPath  = GetTexturePath(material, aiTextureType_METALNESS, directory);
+    info.roughnessPath = GetTexturePath(material, aiTextureType_DIFFUSE_ROUGHNESS, directory);
+    return info;
+}
+
+// Write one mesh into its pre-sized slot of the builder, indices are rebased to the shared buffer
+// after the in place optimization
+static MeshOptimizeResult ConvertMesh(const aiMesh* mesh, const Model::Submesh& submesh,
+                                      Model::Builder& builder) {
+    auto vertices = std::span<Vertex>(builder.vertices).subspan(submesh.firstVertex,
+                                                                 submesh.vertexCount);
+    auto indices =
+        std::span<uint32_t>(builder.indices).subspan(submesh.firstIndex, submesh.indexCount);
+
+    bool hasNormals  = mesh->HasNormals();
+    bool hasTangents = mesh->HasTangentsAndBitangents();
+    bool hasTexcoord = mesh->HasTextureCoords(0);
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        Vertex vertex{};
         vertex.position = {mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z};
-        vertex.normal   = {mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z};
-        if (mesh->HasTangentsAndBitangents()) {
+        if (hasNormals)
+            vertex.normal = {mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z};
+        if (hasTangents) {
             vertex.tangent   = {mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z};
             vertex.bitangent = {mesh->mBitangents[i].x, mesh->mBitangents[i].y,
                                 mesh->mBitangents[i].z};
         }
-        if (mesh->HasTextureCoords(0)) {
+        if (hasTexcoord)
             vertex.texcoord = {mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y};
-        }
-        vertices.push_back(vertex);
+        vertices[i] = vertex;
     }
 
-    std::vector<uint32_t> faces;
+    // SortByPType leaves one primitive type per mesh and only triangle meshes get here
     for (size_t i = 0; i < mesh->mNumFaces; ++i) {
-        faces.push_back(mesh->mFaces[i].mIndices[0]);
-        faces.push_back(mesh->mFaces[i].mIndices[1]);
-        faces.push_back(mesh->mFaces[i].mIndices[2]);
+        const auto& face   = mesh->mFaces[i];
+        indices[i * 3 + 0] = face.mIndices[0];
+        indices[i * 3 + 1] = face.mIndices[1];
+        indices[i * 3 + 2] = face.mIndices[2];
+    }
+
+    // assimp already joined identical vertices, reorder without welding so the slot size holds
+    auto result = MeshOptimizer::OptimizeInPlace(vertices, indices);
+    for (auto& index : indices) index += submesh.firstVertex;
+    return result;
+}
+
+// remembers every file the importer opens, e.g. the material library of an obj, so the mesh cache
+// notices when one of them changes
+class RecordingIOSystem : public Assimp::DefaultIOSystem {
+public:
+    explicit RecordingIOSystem(std::vector<std::string>& openedFiles)
+        : m_openedFiles(openedFiles) {}
+
+    Assimp::IOStream* Open(const char* file, const char* mode = "rb") override {
+        Assimp::IOStream* stream = DefaultIOSystem::Open(file, mode);
+        if (stream != nullptr &&
+            std::find(m_openedFiles.begin(), m_openedFiles.end(), file) == m_openedFiles.end())
+            m_openedFiles.emplace_back(file);
+        return stream;
+    }
+
+private:
+    std::vector<std::string>& m_openedFiles;
+};
+
+Model::Builder LoadModelFromFilePath(std::string_view filename) {
+    Model::Builder builder;
+    std::string    sourcePath{filename};
+    if (MeshCache::Load(sourcePath, builder)) return builder;
+
+    Assimp::Importer importer;
+    // owned by the importer
+    importer.SetIOHandler(new RecordingIOSystem(builder.dependencies));
+    auto scene = importer.ReadFile(filename.data(), ImportFlags);
+    std::erase(builder.dependencies, sourcePath);
+
+    if (!scene || !scene->HasMeshes()) {
+        WIND_CORE_ERROR("Import mesh {} is broken!", sourcePath);
+        return builder;
+    }
+
+    // size every mesh up front so the conversion can write straight into the final buffers
+    std::vector<const aiMesh*> meshes;
+    size_t                     vertexCount = 0, indexCount = 0;
+    for (uint32_t i = 0; i < scene->mNumMeshes; ++i) {
+        const aiMesh* mesh = scene->mMeshes[i];
+        if (mesh->mPrimitiveTypes != aiPrimitiveType_TRIANGLE || mesh->mNumFaces == 0) continue;
+
+        builder.submeshes.push_back({(uint32_t)indexCount, mesh->mNumFaces * 3,
+                                     (uint32_t)vertexCount, mesh->mNumVertices,
+                                     mesh->mMaterialIndex});
+        meshes.push_back(mesh);
+        vertexCount += mesh->mNumVertices;
+        indexCount += mesh->mNumFaces * 3;
+    }
+    builder.vertices.resize(vertexCount);
+    builder.indices.resize(indexCount);
+
+    const auto directory = std::filesystem::path(sourcePath).parent_path();
+    builder.materialInfos.resize(scene->mNumMaterials);
+    for (uint32_t i = 0; i < scene->mNumMaterials; ++i)
+        builder.materialInfos[i] = ConvertMaterial(scene->mMaterials[i], directory);
+
+    std::vector<MeshOptimizeResult> optimizeResults(meshes.size());
+    utils::ParallelFor(meshes.size(), [&](size_t i) {
+        optimizeResults[i] = ConvertMesh(meshes[i], builder.submeshes[i], builder);
+    });
+
+    MeshOptimizeResult total;
+    for (const auto& optimizeResult : optimizeResults) {
+        total.before += optimizeResult.before;
+        total.after += optimizeResult.after;
     }
+    WIND_CORE_INFO("Import {}: {} meshes, {} materials, {} vertices, ACMR {:.3f} -> {:.3f}, "
+                   "ATVR {:.3f} -> {:.3f}",
+                   sourcePath, builder.submeshes.size(), builder.materialInfos.size(),
+                   builder.vertices.size(), total.before.GetACMR(), total.after.GetACMR(),
+                   total.before.GetATVR(), total.after.GetATVR());
 
-    builder.vertices = vertices;
-    builder.indices  = faces;
-    
+    MeshCache::Save(sourcePath, builder);
     return builder;
 }
 
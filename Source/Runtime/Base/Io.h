@@ -1,11 +1,42 @@
 #pragma once
 
+#include <cstdint>
+#include <span>
 #include <string_view>
 #include <vector>
 
+#include "Runtime/Base/Macro.h"
 #include "Runtime/Resource/Mesh.h"
 
 namespace wind::io {
+// Read-only memory mapping of a whole file, the view stays valid until the object is destroyed
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(std::string_view filename);
+    ~MappedFile();
+
+    PERMIT_COPY(MappedFile)
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    [[nodiscard]] bool                     IsValid() const { return m_data != nullptr; }
+    [[nodiscard]] const uint8_t*           GetData() const { return m_data; }
+    [[nodiscard]] size_t                   GetSize() const { return m_size; }
+    [[nodiscard]] std::span<const uint8_t> GetView() const { return {m_data, m_size}; }
+
+private:
+    void Close();
+
+    const uint8_t* m_data = nullptr;
+    size_t         m_size = 0;
+#ifdef _WIN32
+    void* m_fileHandle    = nullptr;
+    void* m_mappingHandle = nullptr;
+#endif
+};
+
 std::vector<char>     ReadFile(std::string_view filename);
 std::vector<uint32_t> ReadSpirvBinaryFile(std::string_view filename);
 Model::Builder        LoadModelFromFilePath(std::string_view filename);
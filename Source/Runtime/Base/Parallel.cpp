@@ -0,0 +1,77 @@
+#include "Parallel.h"
+
+namespace wind::utils {
+ThreadPool& ThreadPool::Get() {
+    static ThreadPool pool(GetWorkerCount() - 1);
+    return pool;
+}
+
+ThreadPool::ThreadPool(size_t workerCount) : m_workerCount(workerCount) {
+    m_workers.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; ++i) m_workers.emplace_back([this] { WorkerLoop(); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wakeup.notify_all();
+    for (auto& worker : m_workers) worker.join();
+}
+
+void ThreadPool::Run(size_t count, void (*invoke)(void*, size_t), void* context) {
+    Job job;
+    job.invoke  = invoke;
+    job.context = context;
+    job.count   = count;
+    {
+        std::lock_guard lock(m_mutex);
+        m_jobs.push_back(&job);
+    }
+    m_wakeup.notify_all();
+
+    Work(job);
+
+    // every index is handed out, wait for the ones still running on workers
+    std::unique_lock lock(m_mutex);
+    std::erase(m_jobs, &job);
+    m_finished.wait(lock, [&job] { return job.users == 0; });
+    lock.unlock();
+    if (job.error) std::rethrow_exception(job.error);
+}
+
+ThreadPool::Job* ThreadPool::FindJob() {
+    size_t helperLimit = GetThreadCount() - 1;
+    for (Job* job : m_jobs) {
+        if (job->next < job->count && job->users < helperLimit) return job;
+    }
+    return nullptr;
+}
+
+void ThreadPool::Work(Job& job) {
+    for (size_t i = job.next.fetch_add(1); i < job.count; i = job.next.fetch_add(1)) {
+        if (job.failed) continue;
+        try {
+            job.invoke(job.context, i);
+        } catch (...) {
+            if (!job.failed.exchange(true)) job.error = std::current_exception();
+        }
+    }
+}
+
+void ThreadPool::WorkerLoop() {
+    std::unique_lock lock(m_mutex);
+    while (true) {
+        Job* job = nullptr;
+        m_wakeup.wait(lock, [this, &job] { return m_stopping || (job = FindJob()) != nullptr; });
+        if (m_stopping) return;
+
+        ++job->users;
+        lock.unlock();
+        Work(*job);
+        lock.lock();
+        if (--job->users == 0) m_finished.notify_all();
+    }
+}
+} // namespace wind::utils
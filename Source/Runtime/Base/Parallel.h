@@ -0,0 +1,79 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace wind::utils {
+inline size_t GetWorkerCount() {
+    return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+// Workers behind ParallelFor, one less than the hardware threads since the calling thread joins in.
+// Started on first use and kept until exit, so a loop only pays for waking them. A loop started
+// from inside another one is queued like any other and its caller works on it too, so nesting
+// never waits on a worker that is itself waiting.
+class ThreadPool {
+public:
+    static ThreadPool& Get();
+    ~ThreadPool();
+
+    // invoke(context, i) for every i in [0, count), returns once all of them ran. The first
+    // exception thrown is rethrown here, indices not started by then are skipped.
+    void Run(size_t count, void (*invoke)(void*, size_t), void* context);
+
+    // at most this many threads including the caller work on a loop, 1 runs loops serially
+    void   SetThreadLimit(size_t limit) { m_threadLimit = std::max<size_t>(1, limit); }
+    size_t GetThreadCount() const { return std::min(m_workerCount + 1, m_threadLimit.load()); }
+
+private:
+    struct Job {
+        void (*invoke)(void*, size_t);
+        void*               context;
+        size_t              count;
+        std::atomic<size_t> next{0};
+        std::atomic<bool>   failed{false};
+        std::exception_ptr  error;
+        // workers that took the job from the queue and have not left it yet, m_mutex held
+        size_t              users = 0;
+    };
+
+    explicit ThreadPool(size_t workerCount);
+    void        WorkerLoop();
+    // first queued job with indices left and room for another thread, m_mutex held
+    Job*        FindJob();
+    static void Work(Job& job);
+
+    // the workers read it while m_workers is still being filled
+    const size_t             m_workerCount;
+    std::vector<std::thread> m_workers;
+    std::mutex               m_mutex;
+    std::condition_variable  m_wakeup;
+    std::condition_variable  m_finished;
+    std::deque<Job*>         m_jobs;
+    std::atomic<size_t>      m_threadLimit{SIZE_MAX};
+    bool                     m_stopping = false;
+};
+
+// Run func(i) for every i in [0, count) on the thread pool, the calling thread joins in.
+// Each index is handed out exactly once, so writing to a pre-sized slot keeps the output ordered.
+// An exception thrown by func is rethrown on the calling thread.
+template <typename Func> void ParallelFor(size_t count, Func&& func) {
+    if (count == 0) return;
+    auto& pool = ThreadPool::Get();
+    if (count == 1 || pool.GetThreadCount() == 1) {
+        for (size_t i = 0; i < count; ++i) func(i);
+        return;
+    }
+
+    auto invoke = [](void* context, size_t i) { (*static_cast<decltype(&func)>(context))(i); };
+    pool.Run(count, invoke, const_cast<void*>(static_cast<const void*>(&func)));
+}
+} // namespace wind::utils
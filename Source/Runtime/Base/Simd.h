@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define WIND_SIMD_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WIND_SIMD_SSE2 1
+#endif
+
+#if defined(_MSC_VER)
+#define WIND_FORCE_INLINE __forceinline
+#else
+#define WIND_FORCE_INLINE inline __attribute__((always_inline))
+#endif
+
+// Minimal float lane abstraction. Kernels are written once as templates over the lane type and run
+// with FloatN for the bulk of the data and with plain float for the remainder.
+namespace wind::simd {
+template <typename T> T Load(const float* source);
+// source[2 * lane] + source[2 * lane + 1] for every lane, reads twice the lane width
+template <typename T> T LoadPairSum(const float* source);
+
+template <> inline float Load<float>(const float* source) { return *source; }
+template <> inline float LoadPairSum<float>(const float* source) { return source[0] + source[1]; }
+inline void  Store(float* destination, float value) { *destination = value; }
+inline float Sqrt(float value) { return std::sqrt(value); }
+inline float RSqrt(float value) { return 1.0f / std::sqrt(value); }
+inline float Min(float a, float b) { return a < b ? a : b; }
+inline float Max(float a, float b) { return a > b ? a : b; }
+inline bool  Greater(float a, float b) { return a > b; }
+inline float Select(bool mask, float a, float b) { return mask ? a : b; }
+
+#if defined(WIND_SIMD_AVX2)
+struct FloatN {
+    static constexpr size_t Width = 8;
+
+    FloatN() = default;
+    FloatN(__m256 value) : v(value) {}
+    FloatN(float value) : v(_mm256_set1_ps(value)) {}
+
+    __m256 v;
+};
+
+inline FloatN operator+(FloatN a, FloatN b) { return _mm256_add_ps(a.v, b.v); }
+inline FloatN operator-(FloatN a, FloatN b) { return _mm256_sub_ps(a.v, b.v); }
+inline FloatN operator*(FloatN a, FloatN b) { return _mm256_mul_ps(a.v, b.v); }
+inline FloatN operator/(FloatN a, FloatN b) { return _mm256_div_ps(a.v, b.v); }
+inline FloatN operator-(FloatN a) { return _mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f)); }
+
+template <> inline FloatN Load<FloatN>(const float* source) { return _mm256_loadu_ps(source); }
+template <> inline FloatN LoadPairSum<FloatN>(const float* source) {
+    // hadd interleaves the 128 bit halves of both inputs, the permute restores lane order
+    __m256 sums = _mm256_hadd_ps(_mm256_loadu_ps(source), _mm256_loadu_ps(source + 8));
+    return _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(sums), _MM_SHUFFLE(3, 1, 2, 0)));
+}
+inline void   Store(float* destination, FloatN value) { _mm256_storeu_ps(destination, value.v); }
+inline FloatN Sqrt(FloatN value) { return _mm256_sqrt_ps(value.v); }
+// hardware estimate refined by one Newton-Raphson step, about 22 bits of precision
+inline FloatN RSqrt(FloatN value) {
+    __m256 estimate = _mm256_rsqrt_ps(value.v);
+    __m256 halfX    = _mm256_mul_ps(value.v, _mm256_set1_ps(0.5f));
+    __m256 square   = _mm256_mul_ps(estimate, estimate);
+    return _mm256_mul_ps(estimate,
+                         _mm256_sub_ps(_mm256_set1_ps(1.5f), _mm256_mul_ps(halfX, square)));
+}
+inline FloatN Min(FloatN a, FloatN b) { return _mm256_min_ps(a.v, b.v); }
+inline FloatN Max(FloatN a, FloatN b) { return _mm256_max_ps(a.v, b.v); }
+inline FloatN Greater(FloatN a, FloatN b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ); }
+inline FloatN Select(FloatN mask, FloatN a, FloatN b) { return _mm256_blendv_ps(b.v, a.v, mask.v); }
+#elif defined(WIND_SIMD_SSE2)
+struct FloatN {
+    static constexpr size_t Width = 4;
+
+    FloatN() = default;
+    FloatN(__m128 value) : v(value) {}
+    FloatN(float value) : v(_mm_set1_ps(value)) {}
+
+    __m128 v;
+};
+
+inline FloatN operator+(FloatN a, FloatN b) { return _mm_add_ps(a.v, b.v); }
+inline FloatN operator-(FloatN a, FloatN b) { return _mm_sub_ps(a.v, b.v); }
+inline FloatN operator*(FloatN a, FloatN b) { return _mm_mul_ps(a.v, b.v); }
+inline FloatN operator/(FloatN a, FloatN b) { return _mm_div_ps(a.v, b.v); }
+inline FloatN operator-(FloatN a) { return _mm_xor_ps(a.v, _mm_set1_ps(-0.0f)); }
+
+template <> inline FloatN Load<FloatN>(const float* source) { return _mm_loadu_ps(source); }
+template <> inline FloatN LoadPairSum<FloatN>(const float* source) {
+    __m128 low  = _mm_loadu_ps(source);
+    __m128 high = _mm_loadu_ps(source + 4);
+    return _mm_add_ps(_mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0)),
+                      _mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1)));
+}
+inline void   Store(float* destination, FloatN value) { _mm_storeu_ps(destination, value.v); }
+inline FloatN Sqrt(FloatN value) { return _mm_sqrt_ps(value.v); }
+// hardware estimate refined by one Newton-Raphson step, about 22 bits of precision
+inline FloatN RSqrt(FloatN value) {
+    __m128 estimate = _mm_rsqrt_ps(value.v);
+    __m128 halfX    = _mm_mul_ps(value.v, _mm_set1_ps(0.5f));
+    __m128 square   = _mm_mul_ps(estimate, estimate);
+    return _mm_mul_ps(estimate, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(halfX, square)));
+}
+inline FloatN Min(FloatN a, FloatN b) { return _mm_min_ps(a.v, b.v); }
+inline FloatN Max(FloatN a, FloatN b) { return _mm_max_ps(a.v, b.v); }
+inline FloatN Greater(FloatN a, FloatN b) { return _mm_cmpgt_ps(a.v, b.v); }
+inline FloatN Select(FloatN mask, FloatN a, FloatN b) {
+    return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v));
+}
+#else
+struct FloatN {
+    static constexpr size_t Width = 1;
+
+    FloatN() = default;
+    FloatN(float value) : v(value) {}
+
+    float v;
+};
+
+inline FloatN operator+(FloatN a, FloatN b) { return a.v + b.v; }
+inline FloatN operator-(FloatN a, FloatN b) { return a.v - b.v; }
+inline FloatN operator*(FloatN a, FloatN b) { return a.v * b.v; }
+inline FloatN operator/(FloatN a, FloatN b) { return a.v / b.v; }
+inline FloatN operator-(FloatN a) { return -a.v; }
+
+template <> inline FloatN Load<FloatN>(const float* source) { return *source; }
+template <> inline FloatN LoadPairSum<FloatN>(const float* source) {
+    return source[0] + source[1];
+}
+inline void   Store(float* destination, FloatN value) { *destination = value.v; }
+inline FloatN Sqrt(FloatN value) { return std::sqrt(value.v); }
+inline FloatN RSqrt(FloatN value) { return 1.0f / std::sqrt(value.v); }
+inline FloatN Min(FloatN a, FloatN b) { return a.v < b.v ? a.v : b.v; }
+inline FloatN Max(FloatN a, FloatN b) { return a.v > b.v ? a.v : b.v; }
+inline bool   Greater(FloatN a, FloatN b) { return a.v > b.v; }
+inline FloatN Select(bool mask, FloatN a, FloatN b) { return mask ? a : b; }
+#endif
+} // namespace wind::simd
@@ -0,0 +1,186 @@
+#include "TlsfAllocator.h"
+
+#include <bit>
+#include <cassert>
+
+namespace wind {
+void TlsfAllocator::MapSize(uint32_t size, uint32_t& firstLevel, uint32_t& secondLevel) {
+    // sizes below SecondLevelCount get one exact bin each in the first row
+    if (size < SecondLevelCount) {
+        firstLevel  = 0;
+        secondLevel = size;
+        return;
+    }
+    uint32_t log2 = (uint32_t)std::bit_width(size) - 1;
+    firstLevel    = log2 - SecondLevelLog2 + 1;
+    secondLevel   = (size >> (log2 - SecondLevelLog2)) - SecondLevelCount;
+}
+
+void TlsfAllocator::Init(uint32_t size) {
+    m_nodes.clear();
+    m_unusedNodes.clear();
+    m_firstLevelBitmap = 0;
+    m_secondLevelBitmaps.fill(0);
+    m_freeHeads.fill(InvalidNode);
+    m_size     = size;
+    m_usedSize = 0;
+    m_lastNode = InvalidNode;
+    if (size == 0) return;
+
+    m_lastNode = CreateNode(0, size);
+    InsertFree(m_lastNode);
+}
+
+uint32_t TlsfAllocator::CreateNode(uint32_t offset, uint32_t size) {
+    uint32_t index;
+    if (!m_unusedNodes.empty()) {
+        index = m_unusedNodes.back();
+        m_unusedNodes.pop_back();
+    } else {
+        index = (uint32_t)m_nodes.size();
+        m_nodes.emplace_back();
+    }
+    m_nodes[index]        = Node{};
+    m_nodes[index].offset = offset;
+    m_nodes[index].size   = size;
+    return index;
+}
+
+void TlsfAllocator::DestroyNode(uint32_t node) { m_unusedNodes.push_back(node); }
+
+void TlsfAllocator::InsertFree(uint32_t node) {
+    uint32_t firstLevel, secondLevel;
+    MapSize(m_nodes[node].size, firstLevel, secondLevel);
+    uint32_t& head = m_freeHeads[firstLevel * SecondLevelCount + secondLevel];
+
+    m_nodes[node].isUsed   = false;
+    m_nodes[node].prevFree = InvalidNode;
+    m_nodes[node].nextFree = head;
+    if (head != InvalidNode) m_nodes[head].prevFree = node;
+    head = node;
+    m_firstLevelBitmap |= 1u << firstLevel;
+    m_secondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+}
+
+void TlsfAllocator::RemoveFree(uint32_t node) {
+    uint32_t firstLevel, secondLevel;
+    MapSize(m_nodes[node].size, firstLevel, secondLevel);
+    uint32_t& head = m_freeHeads[firstLevel * SecondLevelCount + secondLevel];
+
+    auto& entry = m_nodes[node];
+    if (entry.prevFree != InvalidNode) m_nodes[entry.prevFree].nextFree = entry.nextFree;
+    if (entry.nextFree != InvalidNode) m_nodes[entry.nextFree].prevFree = entry.prevFree;
+    if (head == node) head = entry.nextFree;
+    entry.prevFree = entry.nextFree = InvalidNode;
+
+    if (head == InvalidNode) {
+        m_secondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+        if (m_secondLevelBitmaps[firstLevel] == 0) m_firstLevelBitmap &= ~(1u << firstLevel);
+    }
+}
+
+uint32_t TlsfAllocator::FindFree(uint32_t size) const {
+    uint32_t firstLevel, secondLevel;
+    // round up to the next bin boundary, every block of that bin and above is large enough
+    uint32_t roundedSize = size;
+    if (size >= SecondLevelCount) {
+        uint32_t roundUp = (1u << ((uint32_t)std::bit_width(size) - 1 - SecondLevelLog2)) - 1;
+        roundedSize      = size > UINT32_MAX - roundUp ? UINT32_MAX : size + roundUp;
+    }
+    MapSize(roundedSize, firstLevel, secondLevel);
+
+    uint32_t secondLevelMap = m_secondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+    if (secondLevelMap == 0 && firstLevel + 1 < FirstLevelCount) {
+        uint32_t firstLevelMap = m_firstLevelBitmap & (~0u << (firstLevel + 1));
+        if (firstLevelMap != 0) {
+            firstLevel     = (uint32_t)std::countr_zero(firstLevelMap);
+            secondLevelMap = m_secondLevelBitmaps[firstLevel];
+        }
+    }
+    if (secondLevelMap != 0) {
+        secondLevel = (uint32_t)std::countr_zero(secondLevelMap);
+        return m_freeHeads[firstLevel * SecondLevelCount + secondLevel];
+    }
+
+    // the bin of size itself may still hold a block that is large enough, e.g. the whole range
+    MapSize(size, firstLevel, secondLevel);
+    uint32_t node = m_freeHeads[firstLevel * SecondLevelCount + secondLevel];
+    while (node != InvalidNode && m_nodes[node].size < size) node = m_nodes[node].nextFree;
+    return node;
+}
+
+TlsfAllocator::Allocation TlsfAllocator::Allocate(uint32_t size) {
+    if (size == 0) size = 1;
+    uint32_t node = FindFree(size);
+    if (node == InvalidNode) return {};
+    RemoveFree(node);
+
+    // the tail beyond size goes back to the bins as its own block
+    if (m_nodes[node].size > size) {
+        uint32_t rest = CreateNode(m_nodes[node].offset + size, m_nodes[node].size - size);
+        m_nodes[rest].prevPhysical = node;
+        m_nodes[rest].nextPhysical = m_nodes[node].nextPhysical;
+        if (m_nodes[node].nextPhysical != InvalidNode)
+            m_nodes[m_nodes[node].nextPhysical].prevPhysical = rest;
+        m_nodes[node].nextPhysical = rest;
+        m_nodes[node].size         = size;
+        if (m_lastNode == node) m_lastNode = rest;
+        InsertFree(rest);
+    }
+    m_nodes[node].isUsed = true;
+    m_usedSize += size;
+    return Allocation{m_nodes[node].offset, node};
+}
+
+void TlsfAllocator::Free(Allocation allocation) {
+    if (!allocation.IsValid()) return;
+    uint32_t node = allocation.node;
+    assert(m_nodes[node].isUsed);
+    m_usedSize -= m_nodes[node].size;
+
+    uint32_t prev = m_nodes[node].prevPhysical;
+    if (prev != InvalidNode && !m_nodes[prev].isUsed) {
+        RemoveFree(prev);
+        m_nodes[prev].size += m_nodes[node].size;
+        m_nodes[prev].nextPhysical = m_nodes[node].nextPhysical;
+        if (m_nodes[node].nextPhysical != InvalidNode)
+            m_nodes[m_nodes[node].nextPhysical].prevPhysical = prev;
+        if (m_lastNode == node) m_lastNode = prev;
+        DestroyNode(node);
+        node = prev;
+    }
+    uint32_t next = m_nodes[node].nextPhysical;
+    if (next != InvalidNode && !m_nodes[next].isUsed) {
+        RemoveFree(next);
+        m_nodes[node].size += m_nodes[next].size;
+        m_nodes[node].nextPhysical = m_nodes[next].nextPhysical;
+        if (m_nodes[next].nextPhysical != InvalidNode)
+            m_nodes[m_nodes[next].nextPhysical].prevPhysical = node;
+        if (m_lastNode == next) m_lastNode = node;
+        DestroyNode(next);
+    }
+    InsertFree(node);
+}
+
+void TlsfAllocator::Grow(uint32_t size) {
+    assert(size >= m_size);
+    if (size == m_size) return;
+    if (m_lastNode == InvalidNode) {
+        Init(size);
+        return;
+    }
+    uint32_t extra = size - m_size;
+    m_size         = size;
+    if (!m_nodes[m_lastNode].isUsed) {
+        RemoveFree(m_lastNode);
+        m_nodes[m_lastNode].size += extra;
+        InsertFree(m_lastNode);
+        return;
+    }
+    uint32_t node                    = CreateNode(m_size - extra, extra);
+    m_nodes[node].prevPhysical       = m_lastNode;
+    m_nodes[m_lastNode].nextPhysical = node;
+    m_lastNode                       = node;
+    InsertFree(node);
+}
+} // namespace wind
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace wind {
+// Two level segregated fit allocator of offsets into a range of abstract units, e.g. vertices or
+// indices of a GPU buffer; it never touches the memory itself. Free blocks are binned by the
+// power of two of their size and sixteen linear steps within it, a bitmap per level finds a block
+// of at least the requested size in constant time. Freed blocks merge with their free neighbours
+// right away, so fragmentation stays bounded by the bin granularity.
+class TlsfAllocator {
+public:
+    static constexpr uint32_t InvalidOffset = UINT32_MAX;
+
+    struct Allocation {
+        uint32_t offset = InvalidOffset;
+        uint32_t node   = InvalidOffset;
+
+        [[nodiscard]] bool IsValid() const { return offset != InvalidOffset; }
+    };
+
+    explicit TlsfAllocator(uint32_t size = 0) { Init(size); }
+
+    // forgets every allocation
+    void       Init(uint32_t size);
+    // an invalid allocation when no free block is large enough
+    Allocation Allocate(uint32_t size);
+    void       Free(Allocation allocation);
+    // appends [GetSize(), size) as free space, merged with a free block at the end
+    void       Grow(uint32_t size);
+
+    [[nodiscard]] uint32_t GetSize() const { return m_size; }
+    [[nodiscard]] uint32_t GetUsedSize() const { return m_usedSize; }
+    [[nodiscard]] uint32_t GetSizeOf(Allocation allocation) const {
+        return m_nodes[allocation.node].size;
+    }
+
+private:
+    static constexpr uint32_t SecondLevelLog2  = 4;
+    static constexpr uint32_t SecondLevelCount = 1u << SecondLevelLog2;
+    static constexpr uint32_t FirstLevelCount  = 32;
+    static constexpr uint32_t InvalidNode      = UINT32_MAX;
+
+    struct Node {
+        uint32_t offset       = 0;
+        uint32_t size         = 0;
+        uint32_t prevPhysical = InvalidNode;
+        uint32_t nextPhysical = InvalidNode;
+        uint32_t prevFree     = InvalidNode;
+        uint32_t nextFree     = InvalidNode;
+        bool     isUsed       = false;
+    };
+
+    static void MapSize(uint32_t size, uint32_t& firstLevel, uint32_t& secondLevel);
+
+    uint32_t CreateNode(uint32_t offset, uint32_t size);
+    void     DestroyNode(uint32_t node);
+    void     InsertFree(uint32_t node);
+    void     RemoveFree(uint32_t node);
+    // a free node of at least size, InvalidNode when there is none
+    uint32_t FindFree(uint32_t size) const;
+
+    std::vector<Node>     m_nodes;
+    std::vector<uint32_t> m_unusedNodes;
+
+    uint32_t                                                 m_firstLevelBitmap = 0;
+    std::array<uint32_t, FirstLevelCount>                    m_secondLevelBitmaps{};
+    std::array<uint32_t, FirstLevelCount * SecondLevelCount> m_freeHeads{};
+
+    // the node at the end of the range, Grow extends it
+    uint32_t m_lastNode = InvalidNode;
+    uint32_t m_size     = 0;
+    uint32_t m_usedSize = 0;
+};
+} // namespace wind
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <cstdint>
+#include <cstring>
 #include <functional>
 #include <span>
+#include <string_view>
 #include <vector>
 
 namespace wind::utils {
@@ -12,6 +15,25 @@ template <typename T> constexpr auto MakeView(T&& v) {
     return std::span<Ret>{v.data(), v.size()};
 }
 
+// FNV-1a over 64 bit words, enough to notice changed files and to key caches by content
+inline uint64_t HashBytes(std::span<const uint8_t> bytes) {
+    constexpr uint64_t prime = 1099511628211ull;
+    uint64_t           hash  = 14695981039346656037ull;
+
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= bytes.size(); i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, bytes.data() + i, sizeof(word));
+        hash = (hash ^ word) * prime;
+    }
+    for (; i < bytes.size(); ++i) hash = (hash ^ bytes[i]) * prime;
+    return hash;
+}
+
+inline uint64_t HashBytes(std::string_view text) {
+    return HashBytes({(const uint8_t*)text.data(), text.size()});
+}
+
 template <typename StartFunc, typename EndFunc> struct ScopeGuard {
     ScopeGuard() {
         StartFunc();
@@ -165,7 +165,7 @@ void EngineImpl::LoadGameObject() {
         ImageLoader::FillImage(*material.roughnessTexture, roughnessData, ImageOptions::MIPMAPS);
 
         builder.material = material;
-        world.AddModel(builder);
+        world.AddModel(std::move(builder));
         break;
     }
     case ShowCase::Sponza: {
@@ -44,7 +44,7 @@ void AddBloomSetupPass(RenderGraphBuilder& graphBuilder) {
         renderProcessBuilder.SetBlendState(false)
             .SetShader(shader.get())
             .SetNeedVerTex(false)
-            .SetRenderPass(passNode->renderPass)
+            .SetRenderPass(passNode->renderPass, passNode->renderPassHash)
             .SetDepthSetencilTestState(false, false, false, vk::CompareOp::eLessOrEqual);
 
         passNode->graphicsShader = shader;
@@ -100,7 +100,7 @@ void AddBloomBlurPass(RenderGraphBuilder& graphBuilder) {
         renderProcessBuilder.SetBlendState(false)
             .SetShader(shader.get())
             .SetNeedVerTex(false)
-            .SetRenderPass(passNode->renderPass)
+            .SetRenderPass(passNode->renderPass, passNode->renderPassHash)
             .SetDepthSetencilTestState(false, false, false, vk::CompareOp::eLessOrEqual);
 
         passNode->graphicsShader = shader;
@@ -139,7 +139,7 @@ void AddBloomBlurPass(RenderGraphBuilder& graphBuilder) {
         renderProcessBuilder.SetBlendState(false)
             .SetShader(shader.get())
             .SetNeedVerTex(false)
-            .SetRenderPass(passNode->renderPass)
+            .SetRenderPass(passNode->renderPass, passNode->renderPassHash)
             .SetDepthSetencilTestState(false, false, false, vk::CompareOp::eLessOrEqual);
       
         passNode->graphicsShader = shader;
@@ -1,6 +1,7 @@
 #include "PassRendering.h"
 
 #include "Runtime/Render/RHI/Sampler.h"
+#include "Runtime/Render/MeshletCulling.h"
 #include "Runtime/Render/RHI/Shader.h"
 #include "Runtime/Render/RenderGraph/RenderPass.h"
 #include "Runtime/Resource/GLTFLoader.h"
@@ -10,21 +11,11 @@
 #include <stdint.h>
 
 namespace wind {
+// largest simplification error in pixels that may show up on screen
+static constexpr float LodErrorThreshold = 1.0f;
+
 void AddDeferedBasePass(RenderGraphBuilder& graphBuilder) {
     const auto [width, height] = RenderBackend::GetInstance().GetSurfaceExtent();
-    // Allocate shader resource
-    std::shared_ptr<Buffer> cameraBuffer = std::make_shared<Buffer>(
-        sizeof(CameraUnifoirmBuffer), BufferUsage::UNIFORM_BUFFER, MemoryUsage::CPU_TO_GPU);
-    std::shared_ptr<Buffer> lightProjectionBuffer = std::make_shared<Buffer>(
-        sizeof(LightProjectionBuffer), BufferUsage::UNIFORM_BUFFER, MemoryUsage::CPU_TO_GPU);
-    std::shared_ptr<Buffer> projectPlaneBuffer = std::make_shared<Buffer>(
-        sizeof(ProjectPlane), BufferUsage::UNIFORM_BUFFER, MemoryUsage::CPU_TO_GPU);
-    // Buffer Desc
-    ShaderBufferDesc camearaShaderBufferDesc{cameraBuffer, 0, sizeof(CameraUnifoirmBuffer)};
-    ShaderBufferDesc lightProjectionBufferDesc{lightProjectionBuffer, 0,
-                                               sizeof(LightProjectionBuffer)};
-    ShaderBufferDesc planeBufferDesc = {projectPlaneBuffer, 0, sizeof(ProjectPlane)};
-
     std::shared_ptr<Sampler> BasicSampler =
         std::make_shared<Sampler>(Sampler::MinFilter::LINEAR, Sampler::MagFilter::LINEAR,
                                   Sampler::AddressMode::REPEAT, Sampler::MipFilter::LINEAR);
@@ -61,8 +52,10 @@ void AddDeferedBasePass(RenderGraphBuilder& graphBuilder) {
 
         RenderProcessBuilder renderProcessBuilder;
 
-        std::shared_ptr<GraphicsShader> BasePassShader =
-            ShaderFactory::CreateGraphicsShader("BasePass.vert.spv", "BasePass.frag.spv");
+        constexpr bool UsePackedVertex = gltf::GLTFMesh::UsePackedVertex;
+
+        std::shared_ptr<GraphicsShader> BasePassShader = ShaderFactory::CreateGraphicsShader(
+            UsePackedVertex ? "BasePassPacked.vert.spv" : "BasePass.vert.spv", "BasePass.frag.spv");
 
         std::vector<vk::PipelineColorBlendAttachmentState> colorBlendStates(colorBufferCount);
 
@@ -71,56 +64,105 @@ void AddDeferedBasePass(RenderGraphBuilder& graphBuilder) {
                 ColorWriteMask<true, true, true, true>::GetRHI());
         }
 
+        if constexpr (UsePackedVertex) {
+            renderProcessBuilder.SetVertexFactory<PackedVertex>();
+        } else {
+            renderProcessBuilder.SetVertexFactory<gltf::GLTFVertex>();
+        }
         renderProcessBuilder.SetBlendState(colorBlendStates)
             .SetShader(BasePassShader.get())
-            .SetVertexFactory<gltf::GLTFVertex>()
-            .SetRenderPass(passNode->renderPass)
+            .SetRenderPass(passNode->renderPass, passNode->renderPassHash)
             .SetDepthSetencilTestState(true, true, false, vk::CompareOp::eLessOrEqual);
 
+        // single sided materials cull back faces, the same triangles their meshlet cones drop, the
+        // double sided variant shares the layout so bound sets and push constants stay valid
         passNode->graphicsShader = BasePassShader;
-        passNode->pipelineState  = renderProcessBuilder.BuildGraphicProcess();
+        passNode->pipelineState =
+            renderProcessBuilder.SetCullMode(vk::CullModeFlagBits::eBack).BuildGraphicProcess();
+        std::shared_ptr<RenderProcess> doubleSidedProcess =
+            renderProcessBuilder.SetCullMode(vk::CullModeFlagBits::eNone).BuildGraphicProcess();
 
         return [=](CommandBuffer& cmdBuffer, RenderGraphRegister* graphRegister) {
             auto*      scene      = passNode->renderScene->GetOwnScene();
             SceneView* sceneView  = passNode->renderScene;
             auto&      sponzaMesh = scene->GetRequiredGLTFModel("Sponza");
 
-            BasePassShader->Bind("CameraBuffer", camearaShaderBufferDesc);
+            // uniform data lives in slices of the current frame
+            auto& uniformAllocator = RenderBackend::GetInstance().GetUniformAllocator();
+            BasePassShader->Bind("CameraBuffer",
+                                 uniformAllocator.Allocate(*sceneView->cameraBuffer));
             BasePassShader->Bind("MaterialBuffer", {sponzaMesh.materialBuffer, 0,
-                                                    sizeof(gltf::GLTFMesh::Material) *
-                                                        gltf::GLTFMesh::MaxMaterialCount});
+                                                    sponzaMesh.materialBuffer->GetByteSize()});
             BasePassShader->Bind("textureSampler", BasicSampler);
-            BasePassShader->Bind("textureArray", sponzaMesh.textures);
-            BasePassShader->Bind("LightProjection", lightProjectionBufferDesc);
-            BasePassShader->Bind("PlaneDistance", planeBufferDesc);
-
+            BasePassShader->Bind("bindlessTextures",
+                                 RenderBackend::GetInstance().GetTextureRegistry());
+            BasePassShader->Bind("LightProjection",
+                                 uniformAllocator.Allocate(*sceneView->lightProjectionBuffer));
+            BasePassShader->Bind("PlaneDistance",
+                                 uniformAllocator.Allocate(*sceneView->projectPlaneBuffer));
+            auto& residency      = scene->GetTextureResidency();
+            auto& feedbackBuffer = residency.GetFeedbackBuffer();
+            BasePassShader->Bind("MipFeedback", {feedbackBuffer, 0, feedbackBuffer->GetByteSize()});
+
+            // the packed vertex shader also reads the dequantization bounds of the submesh
             struct ConstantData {
-                uint32_t materialIndex;
+                uint32_t           materialIndex;
+                uint32_t           feedbackFrame;
+                uint32_t           padding[2];
+                PackedVertexBounds bounds;
             };
 
             auto& pso = passNode->pipelineState->GetPipeline();
 
-            cameraBuffer->CopyData((uint8_t*)sceneView->cameraBuffer.get(),
-                                   camearaShaderBufferDesc.range, camearaShaderBufferDesc.offset);
-            projectPlaneBuffer->CopyData((uint8_t*)sceneView->projectPlaneBuffer.get(),
-                                   planeBufferDesc.range, planeBufferDesc.offset);
-
-            lightProjectionBuffer->CopyData((uint8_t*)sceneView->lightProjectionBuffer.get(),
-                                            lightProjectionBufferDesc.range,
-                                            lightProjectionBufferDesc.offset);
-
             // cmdBuffer.PushConstant(passNode, &constantData);
             cmdBuffer.BindDescriptorSet(pso.bindPoint, pso.pipelineLayout,
-                                        BasePassShader->GetDescriptorSet());
-
+                                        BasePassShader->GetDescriptorSet(),
+                                        BasePassShader->GetDynamicOffsets());
+
+            // only the meshlets of the selected lod inside the view frustum and facing the camera
+            // are drawn
+            const auto& viewProjection = sceneView->cameraBuffer->viewproj;
+            Frustum     frustum        = Frustum::FromViewProjection(viewProjection);
+            glm::vec3   viewer         = sceneView->cameraBuffer->cameraPos;
+            std::vector<MeshletDrawRange> drawRanges;
+
+            // every submesh lives in the scene geometry pool, bound once for the whole pass
+            auto& geometryPool = scene->GetGeometryPool();
+            geometryPool.Bind(cmdBuffer);
+            // the render graph bound the single sided pipeline
+            bool boundDoubleSided = false;
             for (auto& subMesh : sponzaMesh.submeshes) {
-                size_t indexCount = subMesh.indexBuffer.GetByteSize() / sizeof(uint32_t);
-
-                ConstantData constantData{subMesh.materialIndex};
+                const auto& geometry   = geometryPool.Get(subMesh.geometry);
+                uint32_t    indexCount = geometry.indexCount;
+
+                drawRanges.clear();
+                if (subMesh.lods.empty()) {
+                    drawRanges.push_back({0, indexCount});
+                } else {
+                    uint32_t lodIndex = SelectMeshLod(subMesh.lods, subMesh.boundingSphere,
+                                                      viewProjection, (float)height,
+                                                      LodErrorThreshold);
+                    const auto& lod   = subMesh.lods[lodIndex];
+                    auto meshlets = std::span<const Meshlet>(subMesh.meshlets)
+                                        .subspan(lod.firstMeshlet, lod.meshletCount);
+                    CullMeshlets(meshlets, frustum, viewer, drawRanges);
+                    if (drawRanges.empty()) continue;
+                }
+
+                if (subMesh.doubleSided != boundDoubleSided) {
+                    const auto& process = subMesh.doubleSided ? doubleSidedProcess->GetPipeline()
+                                                              : pso;
+                    cmdBuffer.GetNativeHandle().bindPipeline(process.bindPoint, process.pipeline);
+                    boundDoubleSided = subMesh.doubleSided;
+                }
+
+                ConstantData constantData{subMesh.materialIndex, residency.GetFeedbackFrame(),
+                                          {}, subMesh.bounds};
                 cmdBuffer.PushConstant(passNode, &constantData);
-                cmdBuffer.BindVertexBuffers(subMesh.vertexBuffer);
-                cmdBuffer.BindIndexBufferUInt32(subMesh.indexBuffer);
-                cmdBuffer.DrawIndexed(indexCount, 1);
+                for (const auto& range : drawRanges)
+                    cmdBuffer.DrawIndexed(range.indexCount, 1,
+                                          geometry.firstIndex + range.firstIndex,
+                                          geometry.vertexOffset, 0);
             }
         };
     });
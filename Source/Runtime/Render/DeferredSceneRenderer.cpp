@@ -25,6 +25,8 @@ void DeferedSceneRenderer::Init() {
         graphBuilder.Compile();
         ++index;
     }
+    // the graphs of the other swapchain images reuse the processes of the first one
+    backend.GetPipelineCache().LogStats();
 }
 
 void DeferedSceneRenderer::InitView(Scene& scene) { 
@@ -33,6 +35,10 @@ void DeferedSceneRenderer::InitView(Scene& scene) {
 
 void DeferedSceneRenderer::Render(Scene& scene) {
     m_backend.StartFrame();
+    scene.GetTextureStreamer().Update(m_backend.GetCurrentCommands());
+    scene.GetTextureResidency().Update(m_backend.GetCurrentCommands());
+    scene.GetGeometryPool().Update();
+    scene.GetModelGeometryPool().Update();
     InitView(scene);
     auto               currentImageIndex = m_backend.GetCurrentImageIndex();
     RenderGraphBuilder graphBuilder{m_renderGraphs[currentImageIndex].get()};
@@ -9,21 +9,10 @@ void AddForwardBasePass(RenderGraphBuilder& graphBuilder) {
     const auto [width, height] = RenderBackend::GetInstance().GetSurfaceExtent();
 
     // Allocate shader resource
-    std::shared_ptr<Buffer> cameraBuffer = std::make_shared<Buffer>(
-        sizeof(CameraUnifoirmBuffer), BufferUsage::UNIFORM_BUFFER, MemoryUsage::CPU_TO_GPU);
-    std::shared_ptr<Buffer> objectBuffer = std::make_shared<Buffer>(
-        sizeof(ObjectUniformBuffer), BufferUsage::UNIFORM_BUFFER, MemoryUsage::CPU_TO_GPU);
-    std::shared_ptr<Buffer> lightBuffer = std::make_shared<Buffer>(
-        sizeof(SunUniformBuffer), BufferUsage::UNIFORM_BUFFER, MemoryUsage::CPU_TO_GPU);
-
     std::shared_ptr<Sampler> BasicSampler =
         std::make_shared<Sampler>(Sampler::MinFilter::LINEAR, Sampler::MagFilter::LINEAR,
                                   Sampler::AddressMode::REPEAT, Sampler::MipFilter::LINEAR);
 
-    ShaderBufferDesc camearaShaderBufferDesc{cameraBuffer, 0, sizeof(CameraUnifoirmBuffer)};
-    ShaderBufferDesc objectShaderBufferDesc{objectBuffer, 0, sizeof(ObjectUniformBuffer)};
-    ShaderBufferDesc lightBufferDesc{lightBuffer, 0, sizeof(SunUniformBuffer)};
-
     graphBuilder.AddRenderPass("OpaquePass", [=](PassNode* passNode) {
         // Setup part
         TextureOps loadops{vk::AttachmentLoadOp::eLoad, vk::AttachmentStoreOp::eStore,
@@ -49,7 +38,7 @@ void AddForwardBasePass(RenderGraphBuilder& graphBuilder) {
             .SetShader(BasePassShader.get())
             .SetNeedVerTex(true)
             .SetVertexFactory<Vertex>()
-            .SetRenderPass(passNode->renderPass)
+            .SetRenderPass(passNode->renderPass, passNode->renderPassHash)
             .SetDepthSetencilTestState(true, true, false, vk::CompareOp::eLessOrEqual);
 
         passNode->graphicsShader = BasePassShader;
@@ -68,15 +57,10 @@ void AddForwardBasePass(RenderGraphBuilder& graphBuilder) {
 
             glm::mat4 model = glm::mat4(1.0);
 
-            cameraBuffer->CopyData((uint8_t*)sceneView->cameraBuffer.get(),
-                                   camearaShaderBufferDesc.range, camearaShaderBufferDesc.offset);
-            objectBuffer->CopyData((uint8_t*)&model, objectShaderBufferDesc.range,
-                                   objectShaderBufferDesc.offset);
-            lightBuffer->CopyData((uint8_t*)sceneView->sunBuffer.get(), lightBufferDesc.range,
-                                  lightBufferDesc.offset);
-
-            cmdBuffer.BindDescriptorSet(pso.bindPoint, pso.pipelineLayout,
-                                        shader->GetDescriptorSet());
+            auto& uniformAllocator = RenderBackend::GetInstance().GetUniformAllocator();
+            shader->Bind("CameraBuffer", uniformAllocator.Allocate(*sceneView->cameraBuffer));
+            shader->Bind("LightBuffer", uniformAllocator.Allocate(*sceneView->sunBuffer));
+            shader->Bind("ObjectBuffer", uniformAllocator.Allocate(ObjectUniformBuffer{model}));
 
             shader->Bind("iblSepcTexture", ShaderImageDesc{skyBox->skyBoxImage,
                                                            ImageUsage::SHADER_READ, BasicSampler});
@@ -86,24 +70,32 @@ void AddForwardBasePass(RenderGraphBuilder& graphBuilder) {
                                                   ImageUsage::SHADER_READ, BasicSampler});
 
             for (auto& gameObject : scene->GetWorld().GetWorldGameObjects()) {
-                auto& model    = gameObject.model;
-                auto& material = model->GetMaterial();
-
-                // Get shader binding
-                shader->Bind("CameraBuffer", camearaShaderBufferDesc);
-                shader->Bind("LightBuffer", lightBufferDesc);
-                shader->Bind("ObjectBuffer", objectShaderBufferDesc);
-                shader->Bind("albedoTexture",
-                             {material.albedoTexture, ImageUsage::SHADER_READ, BasicSampler});
-                shader->Bind("normalTexture",
-                             {material.normalTexture, ImageUsage::SHADER_READ, BasicSampler});
-                shader->Bind("metallicTexture",
-                             {material.metallicTexture, ImageUsage::SHADER_READ, BasicSampler});
-                shader->Bind("roughnessTexture",
-                             {material.roughnessTexture, ImageUsage::SHADER_READ, BasicSampler});
-
+                auto& model = gameObject.model;
                 model->Bind(cmdBuffer);
-                model->Draw(cmdBuffer);
+
+                const Material* boundMaterial = nullptr;
+                for (const auto& submesh : model->GetSubmeshes()) {
+                    const auto& material = model->GetMaterial(submesh);
+                    if (&material != boundMaterial) {
+                        // Get shader binding
+                        shader->Bind("albedoTexture", {material.albedoTexture,
+                                                       ImageUsage::SHADER_READ, BasicSampler});
+                        shader->Bind("normalTexture", {material.normalTexture,
+                                                       ImageUsage::SHADER_READ, BasicSampler});
+                        shader->Bind("metallicTexture", {material.metallicTexture,
+                                                         ImageUsage::SHADER_READ, BasicSampler});
+                        shader->Bind("roughnessTexture", {material.roughnessTexture,
+                                                          ImageUsage::SHADER_READ, BasicSampler});
+
+                        // the binds are written when the sets are fetched, each material gets the
+                        // version of the sets holding its textures
+                        cmdBuffer.BindDescriptorSet(pso.bindPoint, pso.pipelineLayout,
+                                                    shader->GetDescriptorSet(),
+                                                    shader->GetDynamicOffsets());
+                        boundMaterial = &material;
+                    }
+                    model->Draw(cmdBuffer, submesh);
+                }
             }
         };
     });
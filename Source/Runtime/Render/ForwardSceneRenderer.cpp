@@ -28,10 +28,16 @@ void ForwardRenderer::Init() {
         graphBuilder.Compile();
         ++index;
     }
+    // the graphs of the other swapchain images reuse the processes of the first one
+    backend.GetPipelineCache().LogStats();
 }
 
 void ForwardRenderer::Render(Scene& scene) {
     m_backend.StartFrame();
+    scene.GetTextureStreamer().Update(m_backend.GetCurrentCommands());
+    scene.GetTextureResidency().Update(m_backend.GetCurrentCommands());
+    scene.GetGeometryPool().Update();
+    scene.GetModelGeometryPool().Update();
     InitView(scene);
     auto               currentImageIndex = m_backend.GetCurrentImageIndex();
     RenderGraphBuilder graphBuilder{m_renderGraphs[currentImageIndex].get()};
@@ -5,19 +5,6 @@
 namespace wind {
 void AddLightPass(RenderGraphBuilder& graphBuilder) {
     const auto [width, height] = RenderBackend::GetInstance().GetSurfaceExtent();
-    // Allocate uniform buffer resource
-    std::shared_ptr<Buffer> cameraBuffer = std::make_shared<Buffer>(
-        sizeof(CameraUnifoirmBuffer), BufferUsage::UNIFORM_BUFFER, MemoryUsage::CPU_TO_GPU);
-    std::shared_ptr<Buffer> sunBuffer = std::make_shared<Buffer>(
-        sizeof(SunUniformBuffer), BufferUsage::UNIFORM_BUFFER, MemoryUsage::CPU_TO_GPU);
-    std::shared_ptr<Buffer> lightProjectionBuffer = std::make_shared<Buffer>(
-        sizeof(LightProjectionBuffer), BufferUsage::UNIFORM_BUFFER, MemoryUsage::CPU_TO_GPU);
-
-    ShaderBufferDesc camearaShaderBufferDesc{cameraBuffer, 0, sizeof(CameraUnifoirmBuffer)};
-    ShaderBufferDesc sunBufferDesc{sunBuffer, 0, sizeof(SunUniformBuffer)};
-    ShaderBufferDesc lightProjectionBufferDesc{lightProjectionBuffer, 0,
-                                               sizeof(LightProjectionBuffer)};
-    // Buffer Desc
     std::shared_ptr<Sampler> BasicSampler =
         std::make_shared<Sampler>(Sampler::MinFilter::LINEAR, Sampler::MagFilter::LINEAR,
                                   Sampler::AddressMode::REPEAT, Sampler::MipFilter::LINEAR);
@@ -47,7 +34,7 @@ void AddLightPass(RenderGraphBuilder& graphBuilder) {
         renderProcessBuilder.SetBlendState(false)
             .SetShader(lightShader.get())
             .SetNeedVerTex(false)
-            .SetRenderPass(passNode->renderPass)
+            .SetRenderPass(passNode->renderPass, passNode->renderPassHash)
             .SetDepthSetencilTestState(true, false, false, vk::CompareOp::eLessOrEqual);
 
         passNode->graphicsShader = lightShader;
@@ -66,8 +53,10 @@ void AddLightPass(RenderGraphBuilder& graphBuilder) {
             auto gbufferD  = graphRegister->GetResource("GBufferD");
             auto shadowMap = graphRegister->GetResource("SunShadow");
 
-            lightShader->Bind("Sun", sunBufferDesc);
-            lightShader->Bind("CameraBuffer", camearaShaderBufferDesc);
+            // uniform data lives in slices of the current frame
+            auto& uniformAllocator = RenderBackend::GetInstance().GetUniformAllocator();
+            lightShader->Bind("Sun", uniformAllocator.Allocate(*sceneView->sunBuffer));
+            lightShader->Bind("CameraBuffer", uniformAllocator.Allocate(*sceneView->cameraBuffer));
 
             lightShader->Bind("gbufferA",
                               {gbufferA->imageHandle, ImageUsage::SHADER_READ, BasicSampler});
@@ -86,31 +75,24 @@ void AddLightPass(RenderGraphBuilder& graphBuilder) {
                 ShaderImageDesc{sceneView->iblBrdfLut, ImageUsage::SHADER_READ, BasicSampler});
             lightShader->Bind("iblIrradianceTexture", {sceneView->skyBoxIrradianceTexture,
                                                        ImageUsage::SHADER_READ, BasicSampler});
-            lightShader->Bind("LightProjection", lightProjectionBufferDesc);
+            lightShader->Bind("LightProjection",
+                              uniformAllocator.Allocate(*sceneView->lightProjectionBuffer));
 
             lightShader->Bind("shadowMap",
                               {shadowMap->imageHandle, ImageUsage::SHADER_READ, BasicSampler});
 
-            lightShader->Bind("PointLights", {sceneView->pointLightBuffers, 0,
-                                              sceneView->pointLightBuffers->GetByteSize()});
-            // update uniform data
-            cameraBuffer->CopyData((uint8_t*)sceneView->cameraBuffer.get(),
-                                   camearaShaderBufferDesc.range, camearaShaderBufferDesc.offset);
-
-            sunBuffer->CopyData((uint8_t*)sceneView->sunBuffer.get(), sunBufferDesc.range,
-                                sunBufferDesc.offset);
-
-            lightProjectionBuffer->CopyData((uint8_t*)sceneView->lightProjectionBuffer.get(),
-                                            lightProjectionBufferDesc.range,
-                                            lightProjectionBufferDesc.offset);
-            auto& pointLightArray = scene->GetPointLightArray();
-            sceneView->pointLightBuffers->CopyData((uint8_t*)pointLightArray.data(),
-                                                   sizeof(PointLight) * pointLightArray.size(), 0);
+            // the block is declared with MaxPointLight entries, only the live ones are copied
+            auto&  pointLightArray = scene->GetPointLightArray();
+            size_t pointLightSize  = sizeof(PointLight) * pointLightArray.size();
+            size_t blockSize       = sizeof(PointLight) * SceneView::MaxPointLight;
+            lightShader->Bind("PointLights", uniformAllocator.Allocate(pointLightArray.data(),
+                                                                       pointLightSize, blockSize));
             int pointLightCnt = scene->GetPointLightCnt();
             cmdBuffer.PushConstant(passNode, &pointLightCnt);
 
             cmdBuffer.BindDescriptorSet(pso.bindPoint, pso.pipelineLayout,
-                                        lightShader->GetDescriptorSet());
+                                        lightShader->GetDescriptorSet(),
+                                        lightShader->GetDynamicOffsets());
 
             cmdBuffer.Draw(3, 1);
         };
@@ -0,0 +1,86 @@
+#include "MeshletCulling.h"
+
+#include <cmath>
+
+namespace wind {
+Frustum Frustum::FromViewProjection(const glm::mat4& viewProjection) {
+    // Gribb/Hartmann plane extraction, glm is column major so row i is m[*][i]. The near plane is
+    // taken for a -w..w depth range, which is conservative for the zero to one convention.
+    auto row = [&](int i) {
+        return glm::vec4{viewProjection[0][i], viewProjection[1][i], viewProjection[2][i],
+                         viewProjection[3][i]};
+    };
+
+    Frustum frustum;
+    frustum.planes[0] = row(3) + row(0);
+    frustum.planes[1] = row(3) - row(0);
+    frustum.planes[2] = row(3) + row(1);
+    frustum.planes[3] = row(3) - row(1);
+    frustum.planes[4] = row(3) + row(2);
+    frustum.planes[5] = row(3) - row(2);
+    for (auto& plane : frustum.planes) {
+        float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+        if (length > 0.0f) plane /= length;
+    }
+    return frustum;
+}
+
+bool Frustum::IntersectsSphere(const glm::vec3& center, float radius) const {
+    for (const auto& plane : planes) {
+        if (plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -radius)
+            return false;
+    }
+    return true;
+}
+
+static bool IsBackfacing(const Meshlet& meshlet, const glm::vec3& viewer) {
+    if (meshlet.coneCutoff >= 1.0f) return false;
+    glm::vec3 direction = meshlet.coneApex - viewer;
+    float     length    = std::sqrt(glm::dot(direction, direction));
+    return glm::dot(direction, meshlet.coneAxis) >= meshlet.coneCutoff * length;
+}
+
+void CullMeshlets(std::span<const Meshlet> meshlets, const Frustum& frustum,
+                  std::optional<glm::vec3> viewer, std::vector<MeshletDrawRange>& ranges) {
+    bool extendLast = false;
+    for (const auto& meshlet : meshlets) {
+        bool visible = frustum.IntersectsSphere(meshlet.center, meshlet.radius) &&
+                       !(viewer.has_value() && IsBackfacing(meshlet, *viewer));
+        if (!visible) {
+            extendLast = false;
+            continue;
+        }
+
+        if (extendLast) {
+            ranges.back().indexCount += meshlet.indexCount;
+        } else {
+            ranges.push_back({meshlet.firstIndex, meshlet.indexCount});
+            extendLast = true;
+        }
+    }
+}
+
+uint32_t SelectMeshLod(std::span<const MeshLod> lods, const glm::vec4& boundingSphere,
+                       const glm::mat4& viewProjection, float viewportHeight,
+                       float maxErrorPixels) {
+    // clip w is the view depth for a perspective projection and 1 for an orthographic one, the
+    // length of the y row is the clip space size of one world unit at w = 1
+    glm::vec4 rowY{viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], 0.0f};
+    glm::vec4 rowW{viewProjection[0][3], viewProjection[1][3], viewProjection[2][3],
+                   viewProjection[3][3]};
+    glm::vec4 center{boundingSphere.x, boundingSphere.y, boundingSphere.z, 1.0f};
+
+    float unitScale = std::sqrt(glm::dot(rowY, rowY)) * viewportHeight * 0.5f;
+    float depth     = glm::dot(rowW, center);
+    // for perspective take the nearest point of the sphere, inside it always use full detail
+    if (rowW.x != 0.0f || rowW.y != 0.0f || rowW.z != 0.0f) depth -= boundingSphere.w;
+    if (depth <= 0.0f) return 0;
+
+    uint32_t selected = 0;
+    for (uint32_t i = 1; i < lods.size(); ++i) {
+        if (lods[i].error * unitScale / depth > maxErrorPixels) break;
+        selected = i;
+    }
+    return selected;
+}
+} // namespace wind
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Runtime/Resource/MeshSimplifier.h"
+#include "Runtime/Resource/Meshlet.h"
+
+namespace wind {
+struct Frustum {
+    // inward facing, normalized planes: left, right, bottom, top, near, far
+    glm::vec4 planes[6];
+
+    static Frustum FromViewProjection(const glm::mat4& viewProjection);
+    [[nodiscard]] bool IntersectsSphere(const glm::vec3& center, float radius) const;
+};
+
+struct MeshletDrawRange {
+    uint32_t firstIndex;
+    uint32_t indexCount;
+};
+
+// Append the index ranges of all meshlets inside the frustum. With a viewer position the normal
+// cone test also rejects backfacing meshlets. Neighbouring visible meshlets are merged, so the
+// result is usually a handful of draws per submesh.
+void CullMeshlets(std::span<const Meshlet> meshlets, const Frustum& frustum,
+                  std::optional<glm::vec3> viewer, std::vector<MeshletDrawRange>& ranges);
+
+// Pick the coarsest LOD whose simplification error, projected at the nearest point of the bounding
+// sphere (xyz center, w radius), stays below maxErrorPixels. Works for perspective and orthographic
+// view projections alike. Returns the index into lods, 0 when lods is empty.
+uint32_t SelectMeshLod(std::span<const MeshLod> lods, const glm::vec4& boundingSphere,
+                       const glm::mat4& viewProjection, float viewportHeight, float maxErrorPixels);
+} // namespace wind
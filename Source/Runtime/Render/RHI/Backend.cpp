@@ -1,6 +1,9 @@
 #include "Backend.h"
 
+#include <algorithm>
+#include <cstring>
 #include <functional>
+#include <stdexcept>
 #include <unordered_set>
 #include <vector>
 
@@ -75,8 +78,13 @@ void RenderBackend::CreateInstance() {
 RenderBackend::~RenderBackend() {
     m_device.waitIdle();
     m_virtualFrames.Destroy();
+    m_uploadContext->CleanUp();
+    m_stageBuffer.reset();
+    m_uniformAllocator->CleanUp();
     m_swapchainImages.clear();
     m_descriptorAllocator->CleanUp();
+    m_textureRegistry->CleanUp();
+    m_pipelineCache->CleanUp();
 
     m_device.destroySemaphore(m_renderingFinishedSemaphore);
     m_device.destroySemaphore(m_imageAvailableSemaphore);
@@ -99,14 +107,80 @@ void RenderBackend::PickupPhysicalDevice() {
     WIND_CORE_INFO(m_physicalDevice.getProperties().deviceName);
 }
 
+// the device extensions, features and limits CreateDevice enables, missing support is fatal
+void RenderBackend::CheckDeviceSupport(std::span<const char* const> extensions) {
+    auto supportedExtensions = m_physicalDevice.enumerateDeviceExtensionProperties();
+    for (const char* extension : extensions) {
+        if (std::none_of(supportedExtensions.begin(), supportedExtensions.end(),
+                         [extension](const vk::ExtensionProperties& properties) {
+                             return std::strcmp(extension, properties.extensionName) == 0;
+                         })) {
+            WIND_CORE_ERROR("Device extension {} is not supported by {}", extension,
+                            m_physicalDeviceProperties.deviceName);
+            throw std::runtime_error("Missing required device extension");
+        }
+    }
+
+    // the 1.0 loader does not export the properties2 entry points, fetch them from the instance
+    vk::DispatchLoaderDynamic dispatch(m_vkInstance, vkGetInstanceProcAddr);
+    auto featureChain = m_physicalDevice.getFeatures2KHR<
+        vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceDescriptorIndexingFeaturesEXT>(dispatch);
+    const auto& features         = featureChain.get<vk::PhysicalDeviceFeatures2>().features;
+    const auto& indexingFeatures =
+        featureChain.get<vk::PhysicalDeviceDescriptorIndexingFeaturesEXT>();
+
+    std::pair<const char*, bool> requiredFeatures[] = {
+        {"runtimeDescriptorArray", indexingFeatures.runtimeDescriptorArray},
+        {"descriptorBindingPartiallyBound", indexingFeatures.descriptorBindingPartiallyBound},
+        {"descriptorBindingSampledImageUpdateAfterBind",
+         indexingFeatures.descriptorBindingSampledImageUpdateAfterBind},
+        {"shaderSampledImageArrayNonUniformIndexing",
+         indexingFeatures.shaderSampledImageArrayNonUniformIndexing},
+        {"fragmentStoresAndAtomics", features.fragmentStoresAndAtomics},
+    };
+    for (const auto& [name, isSupported] : requiredFeatures) {
+        if (isSupported) continue;
+        WIND_CORE_ERROR("Device feature {} is not supported by {}", name,
+                        m_physicalDeviceProperties.deviceName);
+        throw std::runtime_error("Missing required device feature");
+    }
+
+    auto propertyChain = m_physicalDevice.getProperties2KHR<
+        vk::PhysicalDeviceProperties2, vk::PhysicalDeviceDescriptorIndexingPropertiesEXT>(dispatch);
+    const auto& indexingProperties =
+        propertyChain.get<vk::PhysicalDeviceDescriptorIndexingPropertiesEXT>();
+    // the table is visible to every stage, so the per stage limit applies to it as a whole
+    m_textureTableSize =
+        std::min({TextureRegistry::MaxTextureCount,
+                  indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                  indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages});
+    if (m_textureTableSize < TextureRegistry::MaxTextureCount)
+        WIND_CORE_WARN("Device limits the bindless texture table to {} of {} slots",
+                       m_textureTableSize, TextureRegistry::MaxTextureCount);
+}
+
 void RenderBackend::CreateDevice() {
-    std::array           extensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+    // descriptor indexing is core in 1.2, the 1.0 device enables it through the extension
+    std::array extensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME, VK_KHR_MAINTENANCE3_EXTENSION_NAME,
+                             VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME};
+    CheckDeviceSupport(extensions);
     vk::DeviceCreateInfo createInfo;
 
+    // the bindless texture table, see TextureRegistry
+    vk::PhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexingFeatures;
+    descriptorIndexingFeatures.setRuntimeDescriptorArray(true)
+        .setDescriptorBindingPartiallyBound(true)
+        .setDescriptorBindingSampledImageUpdateAfterBind(true)
+        .setShaderSampledImageArrayNonUniformIndexing(true);
+    // the base pass writes the mip feedback of TextureResidency
+    vk::PhysicalDeviceFeatures features;
+    features.setFragmentStoresAndAtomics(true);
+
     std::vector<vk::DeviceQueueCreateInfo> queueCreateInfos;
     std::unordered_set<uint32_t> uniqueQueueIndices{m_queueIndices.graphicsQueueIndex.value(),
                                                     m_queueIndices.presentQueueIndex.value(),
-                                                    m_queueIndices.computeQueueIndex.value()};
+                                                    m_queueIndices.computeQueueIndex.value(),
+                                                    m_queueIndices.transferQueueIndex.value()};
     float                        queuePriority = 1.0f;
 
     for (auto index : uniqueQueueIndices) {
@@ -118,7 +192,10 @@ void RenderBackend::CreateDevice() {
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
-    createInfo.setQueueCreateInfos(queueCreateInfos).setPEnabledExtensionNames(extensions);
+    createInfo.setQueueCreateInfos(queueCreateInfos)
+        .setPEnabledExtensionNames(extensions)
+        .setPEnabledFeatures(&features)
+        .setPNext(&descriptorIndexingFeatures);
 
     m_device = m_physicalDevice.createDevice(createInfo);
 }
@@ -142,6 +219,18 @@ void RenderBackend::QueryQueueFamilyIndices() {
         if (m_queueIndices.IsComplete()) break;
         ++i;
     }
+
+    // uploads run on a copy engine when there is one, beside the graphics work
+    m_queueIndices.transferQueueIndex = m_queueIndices.graphicsQueueIndex;
+    for (uint32_t i = 0; i < properties.size(); ++i) {
+        auto flags = properties[i].queueFlags;
+        if (properties[i].queueCount > 0 && (flags & vk::QueueFlagBits::eTransfer) &&
+            !(flags & (vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute))) {
+            WIND_CORE_INFO("Transfer queue index is {}", i);
+            m_queueIndices.transferQueueIndex = i;
+            break;
+        }
+    }
 }
 
 std::vector<const char*> RenderBackend::GetRequiredExtensions() {
@@ -153,6 +242,19 @@ std::vector<const char*> RenderBackend::GetRequiredExtensions() {
         extensions[i] = glfwExtensions[i];
         WIND_CORE_INFO(extensions[i]);
     }
+    // VK_EXT_descriptor_indexing depends on it, and the device support is queried through it
+    extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+
+    auto supportedExtensions = vk::enumerateInstanceExtensionProperties();
+    for (const char* extension : extensions) {
+        if (std::none_of(supportedExtensions.begin(), supportedExtensions.end(),
+                         [extension](const vk::ExtensionProperties& properties) {
+                             return std::strcmp(extension, properties.extensionName) == 0;
+                         })) {
+            WIND_CORE_ERROR("Instance extension {} is not supported", extension);
+            throw std::runtime_error("Missing required instance extension");
+        }
+    }
     return extensions;
 }
 
@@ -169,6 +271,7 @@ void RenderBackend::GetQueue() {
     m_graphicsQueue = m_device.getQueue(m_queueIndices.graphicsQueueIndex.value(), 0);
     m_presentQueue  = m_device.getQueue(m_queueIndices.presentQueueIndex.value(), 0);
     m_computeQueue  = m_device.getQueue(m_queueIndices.computeQueueIndex.value(), 0);
+    m_transferQueue = m_device.getQueue(m_queueIndices.transferQueueIndex.value(), 0);
 }
 
 void RenderBackend::CreateCmdPool() {
@@ -281,6 +384,10 @@ void RenderBackend::CreateDescriptorCacheAndAllocator() {
 
     m_descriptorAllocator = std::make_shared<DescriptorAllocator>();
     m_descriptorAllocator->Init(m_device);
+
+    m_textureRegistry = std::make_shared<TextureRegistry>();
+    m_textureRegistry->Init(m_device, m_createSetting.maxFrameInflight,
+                            m_textureTableSize);
 }
 
 CommandBuffer RenderBackend::BeginSingleTimeCommand() {
@@ -293,12 +400,67 @@ CommandBuffer RenderBackend::BeginSingleTimeCommand() {
 
 void RenderBackend::SubmitSingleTimeCommand(vk::CommandBuffer cmdBuffer) {
     cmdBuffer.end();
+    m_stageBuffer->Flush();
     vk::SubmitInfo submitInfo;
     submitInfo.setCommandBuffers(cmdBuffer);
     m_graphicsQueue.submit(submitInfo, m_immediateFence);
     auto waitResult = m_device.waitForFences(m_immediateFence, false, UINT64_MAX);
     assert(waitResult == vk::Result::eSuccess);
     m_device.resetFences(m_immediateFence);
+
+    uint64_t submissionValue = AcquireSubmissionValue();
+    m_stageBuffer->Close(cmdBuffer, submissionValue);
+    CompleteSubmission(submissionValue);
+}
+
+void RenderBackend::InitVirtualFrame() {
+    m_stageBuffer = std::make_shared<StageBuffer>(m_createSetting.maxStageBufferSize);
+    m_virtualFrames.Init(m_createSetting.maxFrameInflight);
+    m_uploadContext = std::make_shared<UploadContext>();
+    m_uploadContext->Init(m_device, m_queueIndices.transferQueueIndex.value(), m_transferQueue);
+    m_uniformAllocator = std::make_shared<UniformAllocator>();
+    m_uniformAllocator->Init(
+        m_createSetting.maxFrameUniformSize, m_createSetting.maxFrameInflight,
+        (uint32_t)m_physicalDeviceProperties.limits.minUniformBufferOffsetAlignment);
+    m_pipelineCache = std::make_shared<PipelineCache>();
+    m_pipelineCache->Init(m_device, m_physicalDeviceProperties, m_createSetting.pipelineCachePath);
+}
+
+void RenderBackend::RestartCommandBuffer(CommandBuffer& commandBuffer) {
+    if (m_uploadContext->IsRecording(commandBuffer.GetNativeHandle())) {
+        m_uploadContext->Wait(m_uploadContext->Submit());
+        (void)m_uploadContext->GetCommandBuffer();
+        return;
+    }
+    commandBuffer.End();
+    SubmitCommandBuffer(commandBuffer);
+    commandBuffer.Begin();
+}
+
+uint64_t RenderBackend::TrackSubmission(vk::Fence fence) {
+    uint64_t value              = AcquireSubmissionValue();
+    m_pendingSubmissions[value] = fence;
+    return value;
+}
+
+void RenderBackend::CompleteSubmission(uint64_t value) { m_pendingSubmissions.erase(value); }
+
+uint64_t RenderBackend::PollCompletedSubmission() {
+    std::erase_if(m_pendingSubmissions, [this](const auto& submission) {
+        return m_device.getFenceStatus(submission.second) == vk::Result::eSuccess;
+    });
+    // everything before the oldest pending submission
+    return m_pendingSubmissions.empty() ? m_submittedValue
+                                        : m_pendingSubmissions.begin()->first - 1;
+}
+
+void RenderBackend::WaitForSubmission(uint64_t value) {
+    while (value > PollCompletedSubmission()) {
+        auto [oldest, fence] = *m_pendingSubmissions.begin();
+        auto waitResult      = m_device.waitForFences(fence, false, UINT64_MAX);
+        assert(waitResult == vk::Result::eSuccess);
+        CompleteSubmission(oldest);
+    }
 }
 
 [[nodiscard]] std::vector<CommandBuffer> RenderBackend::RequestMultiCommandBuffer(uint32_t count) {
@@ -326,11 +488,16 @@ void RenderBackend::SubmitCommands(std::vector<CommandBuffer>& commandVecs) {
 }
 
 void RenderBackend::SubmitCommandBuffer(const CommandBuffer& cmdBuffer) {
+    m_stageBuffer->Flush();
     vk::SubmitInfo submitInfo;
     submitInfo.setCommandBuffers(cmdBuffer.GetNativeHandle());
     m_graphicsQueue.submit(submitInfo, m_immediateFence);
     auto waitResult = m_device.waitForFences(m_immediateFence, false, UINT64_MAX);
     assert(waitResult == vk::Result::eSuccess);
     m_device.resetFences(m_immediateFence);
+
+    uint64_t submissionValue = AcquireSubmissionValue();
+    m_stageBuffer->Close(cmdBuffer.GetNativeHandle(), submissionValue);
+    CompleteSubmission(submissionValue);
 }
 } // namespace wind
\ No newline at end of file
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <iostream>
+#include <map>
 #include <memory>
 #include <optional>
+#include <span>
 #include <unordered_map>
 
 #include <vulkan/vulkan.hpp>
@@ -11,7 +13,12 @@
 #include "Runtime/Render/RHI/CommandBuffer.h"
 #include "Runtime/Render/RHI/Descriptors.h"
 #include "Runtime/Render/RHI/Frame.h"
+#include "Runtime/Render/RHI/PipelineCache.h"
 #include "Runtime/Render/RHI/Shader.h"
+#include "Runtime/Render/RHI/StageBuffer.h"
+#include "Runtime/Render/RHI/TextureRegistry.h"
+#include "Runtime/Render/RHI/UniformAllocator.h"
+#include "Runtime/Render/RHI/UploadContext.h"
 #include "Runtime/Render/Window.h"
 
 #include "Runtime/Scene/SceneView.h"
@@ -22,6 +29,8 @@ struct QueueIndices {
     std::optional<uint32_t> graphicsQueueIndex;
     std::optional<uint32_t> presentQueueIndex;
     std::optional<uint32_t> computeQueueIndex;
+    // a transfer only family when the device has one, the graphics family otherwise
+    std::optional<uint32_t> transferQueueIndex;
 
     bool IsComplete() {
         return graphicsQueueIndex.has_value() && presentQueueIndex.has_value() &&
@@ -33,6 +42,10 @@ struct BackendCreateSetting {
     Window&  window;
     uint32_t maxFrameInflight{2};
     uint32_t maxStageBufferSize{64 * 1024 * 1024};
+    // uniform data every frame may allocate
+    uint32_t maxFrameUniformSize{256 * 1024};
+    // compiled pipelines kept between runs, relative to the working directory
+    std::string pipelineCachePath{"PipelineCache.wpso"};
 };
 
 class RenderBackend {
@@ -51,21 +64,39 @@ public:
     }
 
     void RecreateSwapchain(uint32_t surfaceWidth, uint32_t surfaceHeight);
-    void StartFrame() { m_virtualFrames.StartFrame(); }
+    void StartFrame() {
+        m_virtualFrames.StartFrame();
+        m_textureRegistry->BeginFrame(GetCurrentFrameIndex());
+        m_uniformAllocator->BeginFrame(GetCurrentFrameIndex());
+    }
     void EndFrame() { m_virtualFrames.EndFrame(); }
 
     CommandBuffer BeginSingleTimeCommand();
     void          SubmitSingleTimeCommand(vk::CommandBuffer cmdBuffer);
     void          SubmitCommandBuffer(const CommandBuffer& cmdBuffer);
-    void InitVirtualFrame() {
-        m_virtualFrames.Init(m_createSetting.maxFrameInflight, m_createSetting.maxStageBufferSize);
-    }
+    void          InitVirtualFrame();
+
+    // Every queue submission gets an increasing value, a CPU side timeline over the fences of all
+    // queues. Queues retire their submissions in any order relative to each other, so a value is
+    // completed once it and every value before it were observed signaled.
+    [[nodiscard]] uint64_t AcquireSubmissionValue() { return ++m_submittedValue; }
+    // the value of a submission that signals fence, pending until the fence is seen signaled
+    [[nodiscard]] uint64_t TrackSubmission(vk::Fence fence);
+    // the fence of a tracked submission was waited on
+    void                   CompleteSubmission(uint64_t value);
+    // checks the fences of the pending submissions without waiting
+    [[nodiscard]] uint64_t PollCompletedSubmission();
+    void                   WaitForSubmission(uint64_t value);
 
     [[nodiscard]] const auto& GetCommandPool() const noexcept { return m_coomandPool; }
     [[nodiscard]] const auto& GetDevice() const noexcept { return m_device; }
     [[nodiscard]] const auto& GetPhyDevice() const noexcept { return m_physicalDevice; }
     [[nodiscard]] const auto& GetPresentQueue() const noexcept { return m_presentQueue; }
     [[nodiscard]] const auto& GetGraphicsQueue() const noexcept { return m_graphicsQueue; }
+    [[nodiscard]] const auto& GetQueueIndices() const noexcept { return m_queueIndices; }
+    [[nodiscard]] bool        HasDedicatedTransferQueue() const noexcept {
+        return m_queueIndices.transferQueueIndex != m_queueIndices.graphicsQueueIndex;
+    }
     [[nodiscard]] const auto& GetVkInstance() const noexcept { return m_vkInstance; }
 
     // get swapchain related things
@@ -102,11 +133,19 @@ public:
         return m_virtualFrames.GetPresentImageIndex();
     }
     [[nodiscard]] auto&       GetCurrentFrame() const { return m_virtualFrames.GetCurrentFrame(); }
+    [[nodiscard]] uint32_t    GetCurrentFrameIndex() const {
+        return (uint32_t)m_virtualFrames.GetCurrentFrameIndex();
+    }
+    [[nodiscard]] uint64_t    GetFrameNumber() const { return m_virtualFrames.GetFrameNumber(); }
     [[nodiscard]] const auto& GetDescriptorLayoutCache() const { return m_descriptorLayoutCache; }
     [[nodiscard]] const auto& GetDescriptorAllocator() const { return m_descriptorAllocator; }
-    [[nodiscard]] auto&       GetStagingBuffer() {
-        return m_virtualFrames.GetCurrentFrame().StagingBuffer;
-    }
+    [[nodiscard]] auto&       GetTextureRegistry() { return *m_textureRegistry; }
+    [[nodiscard]] auto&       GetStagingBuffer() { return *m_stageBuffer; }
+    [[nodiscard]] auto&       GetUploadContext() { return *m_uploadContext; }
+    [[nodiscard]] auto&       GetUniformAllocator() { return *m_uniformAllocator; }
+    [[nodiscard]] auto&       GetPipelineCache() { return *m_pipelineCache; }
+    // submits what commandBuffer recorded so far on its queue, waits for it and begins it again
+    void                      RestartCommandBuffer(CommandBuffer& commandBuffer);
     [[nodiscard]] auto& GetCurrentCommands() {return m_virtualFrames.GetCurrentFrame().Commands;}
     
     [[nodiscard]] auto GetMaxFrameInFlight() { return m_createSetting.maxFrameInflight; }
@@ -118,6 +157,7 @@ private:
     std::vector<const char*> GetRequiredExtensions();
     void                     CreateInstance();
     void                     PickupPhysicalDevice();
+    void                     CheckDeviceSupport(std::span<const char* const> extensions);
     void                     CreateDevice();
     void                     CreateSuface();
     void                     QueryQueueFamilyIndices();
@@ -133,11 +173,14 @@ private:
     vk::Instance                 m_vkInstance;
     vk::PhysicalDevice           m_physicalDevice;
     vk::PhysicalDeviceProperties m_physicalDeviceProperties;
+    // slots of the bindless texture table the device limits allow
+    uint32_t                     m_textureTableSize = TextureRegistry::MaxTextureCount;
     vk::Device                   m_device;
 
     vk::Queue m_graphicsQueue;
     vk::Queue m_presentQueue;
     vk::Queue m_computeQueue;
+    vk::Queue m_transferQueue;
 
     QueueIndices m_queueIndices;
 
@@ -166,6 +209,14 @@ private:
 
     std::shared_ptr<DescriptorAllocator>   m_descriptorAllocator;
     std::shared_ptr<DescriptorLayoutCache> m_descriptorLayoutCache;
+    std::shared_ptr<TextureRegistry>       m_textureRegistry;
+    std::shared_ptr<StageBuffer>           m_stageBuffer;
+    std::shared_ptr<UploadContext>         m_uploadContext;
+    std::shared_ptr<UniformAllocator>      m_uniformAllocator;
+    std::shared_ptr<PipelineCache>         m_pipelineCache;
+
+    std::map<uint64_t, vk::Fence> m_pendingSubmissions;
+    uint64_t                      m_submittedValue = 0;
 
     uint32_t                              m_presentImageCnt;
     bool                                  m_renderingEnabled{true};
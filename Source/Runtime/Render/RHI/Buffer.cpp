@@ -20,6 +20,16 @@ void Buffer::Init(size_t byteSize, BufferUsage::Value usage, MemoryUsage memoryU
         .setSharingMode(vk::SharingMode::eExclusive)
         .setQueueFamilyIndices(BufferQueueFamiliyIndicies);
 
+    // buffers the UploadContext fills on a transfer queue are shared with the graphics queue
+    // instead of transferring their ownership after every upload
+    auto&                   backend = RenderBackend::GetInstance();
+    const auto&             indices = backend.GetQueueIndices();
+    std::array<uint32_t, 2> sharedQueueFamilies{indices.graphicsQueueIndex.value(),
+                                                indices.transferQueueIndex.value()};
+    if ((usage & BufferUsage::TRANSFER_DESTINATION) && backend.HasDedicatedTransferQueue())
+        bufferCreateInfo.setSharingMode(vk::SharingMode::eConcurrent)
+            .setQueueFamilyIndices(sharedQueueFamilies);
+
     m_allocation = AllocateBuffer(bufferCreateInfo, memoryUsage, &m_handle);
 }
 
@@ -41,6 +51,10 @@ void Buffer::FlushMemory(size_t byteSize, size_t offset) {
     wind::FlushMemory(m_allocation, byteSize, offset);
 }
 
+void Buffer::InvalidateMemory(size_t byteSize, size_t offset) {
+    wind::InvalidateMemory(m_allocation, byteSize, offset);
+}
+
 void Buffer::CopyData(const uint8_t* data, size_t byteSize, size_t offset) {
     assert(byteSize + offset <= m_byteSize);
 
@@ -55,6 +55,8 @@ public:
     void     UnmapMemory();
     void     FlushMemory();
     void     FlushMemory(size_t byteSize, size_t offset);
+    // before reading memory the GPU wrote, a no-op on host coherent memory
+    void     InvalidateMemory(size_t byteSize, size_t offset);
     void     CopyData(const uint8_t* data, size_t byteSize, size_t offset);
     void     CopyDataWithFlush(const uint8_t* data, size_t byteSize, size_t offset);
 
@@ -1,5 +1,7 @@
 #include "CommandBuffer.h"
 
+#include <algorithm>
+
 #include "Runtime/Render/RHI/CommandBuffer.h"
 #include "Runtime/Render/RenderGraph/Node.h"
 
@@ -207,6 +209,12 @@ void CommandBuffer::DrawIndirect(BufferInfo bufferInfo, uint32_t offset, uint32_
 }
 
 void CommandBuffer::CopyBufferToImage(const BufferInfo& source, const ImageInfo& distance) {
+    CopyBufferToImage(source, distance, 0,
+                      distance.resource.get().GetMipLevelHeight(distance.mipLevel));
+}
+
+void CommandBuffer::CopyBufferToImage(const BufferInfo& source, const ImageInfo& distance,
+                                      uint32_t firstRow, uint32_t rowCount) {
     if (distance.usage != ImageUsage::TRANSFER_DESTINATION) {
         auto distanceRange = GetDefaultImageSubresourceRange(distance.resource.get());
 
@@ -229,16 +237,17 @@ void CommandBuffer::CopyBufferToImage(const BufferInfo& source, const ImageInfo&
 
     auto distanceLayers = GetDefaultImageSubresourceLayers(distance.resource.get(),
                                                            distance.mipLevel, distance.layer);
+    uint32_t levelHeight = distance.resource.get().GetMipLevelHeight(distance.mipLevel);
+    assert(firstRow < levelHeight);
 
     vk::BufferImageCopy bufferToImageCopyInfo;
     bufferToImageCopyInfo.setBufferOffset(source.offset)
         .setBufferImageHeight(0)
         .setBufferRowLength(0)
         .setImageSubresource(distanceLayers)
-        .setImageOffset(vk::Offset3D{0, 0, 0})
+        .setImageOffset(vk::Offset3D{0, (int32_t)firstRow, 0})
         .setImageExtent(vk::Extent3D{distance.resource.get().GetMipLevelWidth(distance.mipLevel),
-                                     distance.resource.get().GetMipLevelHeight(distance.mipLevel),
-                                     1});
+                                     std::min(rowCount, levelHeight - firstRow), 1});
 
     m_handle.copyBufferToImage(source.resource.get().GetNativeHandle(),
                                distance.resource.get().GetNativeHandle(),
@@ -256,6 +265,14 @@ void CommandBuffer::CopyBuffer(const BufferInfo& source, const BufferInfo& dista
                         distance.resource.get().GetNativeHandle(), bufferCopyInfo);
 }
 
+void CommandBuffer::TransferBarrier() {
+    vk::MemoryBarrier barrier;
+    barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+        .setDstAccessMask(vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eTransferWrite);
+    m_handle.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                             vk::PipelineStageFlagBits::eTransfer, {}, barrier, {}, {});
+}
+
 void CommandBuffer::BlitImage(const Image& source, ImageUsage::Bits sourceUsage,
                               const Image& distance, ImageUsage::Bits distanceUsage,
                               BlitFilter filter) {
@@ -464,8 +481,10 @@ void CommandBuffer::TransferLayout(std::span<Image> images, ImageUsage::Bits old
 }
 
 
-void CommandBuffer::BindDescriptorSet(vk::PipelineBindPoint bindPoint, vk::PipelineLayout layout, std::vector<vk::DescriptorSet>& descriptorSets) {
-    m_handle.bindDescriptorSets(bindPoint, layout, 0, descriptorSets, {});
+void CommandBuffer::BindDescriptorSet(vk::PipelineBindPoint bindPoint, vk::PipelineLayout layout,
+                                      std::vector<vk::DescriptorSet>& descriptorSets,
+                                      const std::vector<uint32_t>&    dynamicOffsets) {
+    m_handle.bindDescriptorSets(bindPoint, layout, 0, descriptorSets, dynamicOffsets);
 }
 
 void CommandBuffer::PushConstants(const PassNode* passNode, const uint8_t* data, size_t size) {
@@ -47,7 +47,7 @@ struct ImageInfo {
 
 struct BufferInfo {
     BufferReference resource;
-    uint32_t        offset = 0;
+    vk::DeviceSize  offset = 0;
 };
 
 class CommandBuffer {
@@ -82,13 +82,20 @@ public:
     void BeginRenderPass(PassNode* passNode);
     void EndRenderPass();
 
+    // dynamicOffsets holds one offset per dynamic descriptor of the sets, in set and binding order
     void BindDescriptorSet(vk::PipelineBindPoint bindPoint, vk::PipelineLayout layout,
-                           std::vector<vk::DescriptorSet>& descriptorSets);
+                           std::vector<vk::DescriptorSet>& descriptorSets,
+                           const std::vector<uint32_t>&    dynamicOffsets = {});
 
     void CopyImage(const ImageInfo& source, const ImageInfo& distance);
     void CopyBufferToImage(const BufferInfo& source, const ImageInfo& distance);
+    // texel rows [firstRow, firstRow + rowCount) of the level, clamped to its height
+    void CopyBufferToImage(const BufferInfo& source, const ImageInfo& distance, uint32_t firstRow,
+                           uint32_t rowCount);
     void CopyImageToBuffer(const ImageInfo& source, const BufferInfo& distance);
     void CopyBuffer(const BufferInfo& source, const BufferInfo& distance, size_t byteSize);
+    // orders the transfers submitted before it on this queue with the ones recorded after it
+    void TransferBarrier();
 
     void BlitImage(const Image& source, ImageUsage::Bits sourceUsage, const Image& distance,
                    ImageUsage::Bits distanceUsage, BlitFilter filter);
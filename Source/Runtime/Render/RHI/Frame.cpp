@@ -1,10 +1,9 @@
 #include "Frame.h"
 
 #include "Runtime/Render/RHI/Backend.h"
-#include "Runtime/Render/RHI/StageBuffer.h"
 
 namespace wind {
-void VirtualFrameProvider::Init(size_t frameCount, size_t stageBufferSize) {
+void VirtualFrameProvider::Init(size_t frameCount) {
     auto& vulkanContext = RenderBackend::GetInstance();
     m_virtualFrames.reserve(frameCount);
 
@@ -22,7 +21,6 @@ void VirtualFrameProvider::Init(size_t frameCount, size_t stageBufferSize) {
 
         m_virtualFrames.push_back(VirtualFrame{
             CommandBuffer{commandBuffers[i]},
-            StageBuffer(stageBufferSize),
             fence,
         });
     }
@@ -43,6 +41,7 @@ void VirtualFrameProvider::StartFrame() {
     vk::Result waitFenceResult =
         vulkanContext.GetDevice().waitForFences(frame.CommandQueueFence, false, UINT64_MAX);
     assert(waitFenceResult == vk::Result::eSuccess);
+    vulkanContext.CompleteSubmission(frame.SubmissionValue);
     vulkanContext.GetDevice().resetFences(frame.CommandQueueFence);
 
     auto acquireNextImage = vulkanContext.GetDevice().acquireNextImageKHR(
@@ -61,18 +60,30 @@ void VirtualFrameProvider::EndFrame() {
 
     frame.Commands.End();
 
-    frame.StagingBuffer.Flush();
-    frame.StagingBuffer.Reset();
-
-    std::array waitDstStageMask = {(vk::PipelineStageFlags)vk::PipelineStageFlagBits::eColorAttachmentOutput};
+    auto& stageBuffer = backend.GetStagingBuffer();
+    stageBuffer.Flush();
+    backend.GetUniformAllocator().Flush();
+
+    // besides the swapchain image, wait for the uploads the frame may read
+    auto&                               uploadContext  = backend.GetUploadContext();
+    std::vector<vk::Semaphore>          waitSemaphores = {backend.GetImageAvailableSemaphore()};
+    std::vector<vk::PipelineStageFlags> waitDstStageMask = {
+        vk::PipelineStageFlagBits::eColorAttachmentOutput};
+    for (auto semaphore : uploadContext.GetWaitSemaphores()) {
+        waitSemaphores.push_back(semaphore);
+        waitDstStageMask.push_back(vk::PipelineStageFlagBits::eAllCommands);
+    }
 
     vk::SubmitInfo submitInfo;
-    submitInfo.setWaitSemaphores(backend.GetImageAvailableSemaphore())
+    submitInfo.setWaitSemaphores(waitSemaphores)
         .setWaitDstStageMask(waitDstStageMask)
         .setSignalSemaphores(backend.GetRenderingFinishedSemaphore())
         .setCommandBuffers(frame.Commands.GetNativeHandle());
 
     backend.GetGraphicsQueue().submit(std::array{submitInfo}, frame.CommandQueueFence);
+    frame.SubmissionValue = backend.TrackSubmission(frame.CommandQueueFence);
+    uploadContext.ReleaseWaitSemaphores(frame.SubmissionValue);
+    stageBuffer.Close(frame.Commands.GetNativeHandle(), frame.SubmissionValue);
 
     vk::PresentInfoKHR presentInfo;
     presentInfo.setWaitSemaphores(backend.GetRenderingFinishedSemaphore())
@@ -83,6 +94,7 @@ void VirtualFrameProvider::EndFrame() {
     assert(presetSucceeded == vk::Result::eSuccess);
 
     m_currentFrame = (m_currentFrame + 1) % m_virtualFrames.size();
+    ++m_frameNumber;
     m_isFrameRunning = false;
 }
 
@@ -3,19 +3,19 @@
 #include <vulkan/vulkan.hpp>
 
 #include "Runtime/Render/RHI/CommandBuffer.h"
-#include "Runtime/Render/RHI/StageBuffer.h"
 
 namespace wind {
 
 struct VirtualFrame {
     CommandBuffer Commands{vk::CommandBuffer{}};
-    StageBuffer   StagingBuffer;
     vk::Fence     CommandQueueFence;
+    // the value of the last submission signaling CommandQueueFence
+    uint64_t      SubmissionValue = 0;
 };
 
 class VirtualFrameProvider {
 public:
-    void Init(size_t frameCount, size_t stageBufferSize);
+    void Init(size_t frameCount);
     void Destroy();
 
     void                              StartFrame();
@@ -25,6 +25,9 @@ public:
     [[nodiscard]] const VirtualFrame& GetNextFrame() const;
     [[nodiscard]] uint32_t            GetPresentImageIndex() const;
     [[nodiscard]] size_t              GetFrameCount() const;
+    [[nodiscard]] size_t              GetCurrentFrameIndex() const { return m_currentFrame; }
+    // frames ended so far, the one being recorded has this number
+    [[nodiscard]] uint64_t            GetFrameNumber() const { return m_frameNumber; }
     void                              EndFrame();
 
 private:
@@ -32,5 +35,6 @@ private:
     uint32_t                  m_presentImageIndex = 0;
     bool                      m_isFrameRunning    = false;
     size_t                    m_currentFrame      = 0;
+    uint64_t                  m_frameNumber       = 0;
 };
 } // namespace wind
\ No newline at end of file
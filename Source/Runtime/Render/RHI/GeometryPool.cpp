@@ -0,0 +1,175 @@
+#include "GeometryPool.h"
+
+#include <algorithm>
+#include <bit>
+
+#include "Runtime/Render/RHI/Backend.h"
+
+namespace wind {
+GeometryPool::GeometryPool(uint32_t vertexStride, uint32_t vertexCapacity, uint32_t indexCapacity)
+    : m_vertexStride(vertexStride), m_vertexAllocator(vertexCapacity),
+      m_indexAllocator(indexCapacity) {}
+
+void GeometryPool::CreateBuffers(uint32_t vertexCapacity, uint32_t indexCapacity) {
+    constexpr auto CopyUsage = BufferUsage::TRANSFER_SOURCE | BufferUsage::TRANSFER_DESTINATION;
+    m_vertexBuffer = std::make_shared<Buffer>((size_t)vertexCapacity * m_vertexStride,
+                                              BufferUsage::VERTEX_BUFFER | CopyUsage,
+                                              MemoryUsage::GPU_ONLY);
+    m_indexBuffer  = std::make_shared<Buffer>((size_t)indexCapacity * sizeof(uint32_t),
+                                              BufferUsage::INDEX_BUFFER | CopyUsage,
+                                              MemoryUsage::GPU_ONLY);
+}
+
+bool GeometryPool::IsRetired(uint64_t frame) const {
+    auto& backend = RenderBackend::GetInstance();
+    return frame + backend.GetMaxFrameInFlight() < backend.GetFrameNumber();
+}
+
+void GeometryPool::ReleaseRetired() {
+    std::erase_if(m_pendingFrees, [this](const PendingFree& pending) {
+        if (!IsRetired(pending.frame)) return false;
+        m_vertexAllocator.Free(pending.vertexAllocation);
+        m_indexAllocator.Free(pending.indexAllocation);
+        return true;
+    });
+    auto& uploadContext = RenderBackend::GetInstance().GetUploadContext();
+    std::erase_if(m_retiredBuffers, [this, &uploadContext](const RetiredBuffers& retired) {
+        return IsRetired(retired.frame) && uploadContext.IsComplete(retired.ticket);
+    });
+}
+
+GeometryPool::Handle GeometryPool::Allocate(std::span<const std::byte> vertices,
+                                            std::span<const uint32_t> indices) {
+    assert(vertices.size() % m_vertexStride == 0);
+    // created on first use, pools may be constructed before the render backend
+    if (!m_vertexBuffer) CreateBuffers(m_vertexAllocator.GetSize(), m_indexAllocator.GetSize());
+    ReleaseRetired();
+    auto vertexCount = uint32_t(vertices.size() / m_vertexStride);
+    auto indexCount  = (uint32_t)indices.size();
+
+    auto vertexAllocation = m_vertexAllocator.Allocate(vertexCount);
+    auto indexAllocation  = m_indexAllocator.Allocate(indexCount);
+    if (!vertexAllocation.IsValid() || !indexAllocation.IsValid()) {
+        m_vertexAllocator.Free(vertexAllocation);
+        m_indexAllocator.Free(indexAllocation);
+        // the space appended at the end is enough on its own, whatever the fragmentation
+        uint32_t vertexCapacity = m_vertexAllocator.GetSize();
+        uint32_t indexCapacity  = m_indexAllocator.GetSize();
+        if (!vertexAllocation.IsValid())
+            vertexCapacity = std::bit_ceil(vertexCapacity + std::max(vertexCount, 1u));
+        if (!indexAllocation.IsValid())
+            indexCapacity = std::bit_ceil(indexCapacity + std::max(indexCount, 1u));
+        WIND_CORE_INFO("Grow geometry pool to {} vertices and {} indices", vertexCapacity,
+                       indexCapacity);
+        Rebuild(vertexCapacity, indexCapacity, false);
+
+        vertexAllocation = m_vertexAllocator.Allocate(vertexCount);
+        indexAllocation  = m_indexAllocator.Allocate(indexCount);
+        assert(vertexAllocation.IsValid() && indexAllocation.IsValid());
+    }
+
+    Handle handle;
+    if (!m_freeHandles.empty()) {
+        handle = m_freeHandles.back();
+        m_freeHandles.pop_back();
+    } else {
+        handle = (Handle)m_entries.size();
+        m_entries.emplace_back();
+    }
+    auto& entry            = m_entries[handle];
+    entry.range            = {vertexAllocation.offset, vertexCount, indexAllocation.offset,
+                              indexCount};
+    entry.vertexAllocation = vertexAllocation;
+    entry.indexAllocation  = indexAllocation;
+    entry.isLive           = true;
+
+    auto& uploadContext = RenderBackend::GetInstance().GetUploadContext();
+    uploadContext.CopyToBuffer(vertices, *m_vertexBuffer,
+                               (size_t)vertexAllocation.offset * m_vertexStride);
+    uploadContext.CopyToBuffer(std::as_bytes(indices), *m_indexBuffer,
+                               (size_t)indexAllocation.offset * sizeof(uint32_t));
+    return handle;
+}
+
+void GeometryPool::Free(Handle handle) {
+    if (handle == InvalidHandle) return;
+    auto& entry = m_entries[handle];
+    assert(entry.isLive);
+    // frames in flight may still draw the range
+    m_pendingFrees.push_back({entry.vertexAllocation, entry.indexAllocation,
+                              RenderBackend::GetInstance().GetFrameNumber()});
+    entry = Entry{};
+    m_freeHandles.push_back(handle);
+}
+
+void GeometryPool::Update() {
+    if (m_pendingFrees.empty() && m_retiredBuffers.empty()) return;
+    ReleaseRetired();
+}
+
+void GeometryPool::Defragment() {
+    if (!m_vertexBuffer) return;
+    ReleaseRetired();
+    Rebuild(m_vertexAllocator.GetSize(), m_indexAllocator.GetSize(), true);
+    WIND_CORE_INFO("Defragment geometry pool, {} vertices and {} indices live",
+                   m_vertexAllocator.GetUsedSize(), m_indexAllocator.GetUsedSize());
+}
+
+void GeometryPool::Rebuild(uint32_t vertexCapacity, uint32_t indexCapacity, bool compact) {
+    auto& backend       = RenderBackend::GetInstance();
+    auto& uploadContext = backend.GetUploadContext();
+    auto  vertexBuffer  = m_vertexBuffer;
+    auto  indexBuffer   = m_indexBuffer;
+    CreateBuffers(vertexCapacity, indexCapacity);
+
+    auto& commandBuffer = uploadContext.GetCommandBuffer();
+    // uploads into the old buffers must land before they are copied out
+    commandBuffer.TransferBarrier();
+    if (!compact) {
+        commandBuffer.CopyBuffer(BufferInfo{*vertexBuffer, 0}, BufferInfo{*m_vertexBuffer, 0},
+                                 vertexBuffer->GetByteSize());
+        commandBuffer.CopyBuffer(BufferInfo{*indexBuffer, 0}, BufferInfo{*m_indexBuffer, 0},
+                                 indexBuffer->GetByteSize());
+        m_vertexAllocator.Grow(vertexCapacity);
+        m_indexAllocator.Grow(indexCapacity);
+    } else {
+        // ranges waiting to be freed are not copied, only frames reading the old buffers use them
+        m_pendingFrees.clear();
+        m_vertexAllocator.Init(vertexCapacity);
+        m_indexAllocator.Init(indexCapacity);
+        for (auto& entry : m_entries) {
+            if (!entry.isLive) continue;
+            auto& range            = entry.range;
+            entry.vertexAllocation = m_vertexAllocator.Allocate(range.vertexCount);
+            entry.indexAllocation  = m_indexAllocator.Allocate(range.indexCount);
+            assert(entry.vertexAllocation.IsValid() && entry.indexAllocation.IsValid());
+
+            uint32_t vertexStart = entry.vertexAllocation.offset;
+            uint32_t indexStart  = entry.indexAllocation.offset;
+            // byte offsets pass 4 GiB long before the vertex and index counts overflow
+            if (range.vertexCount > 0)
+                commandBuffer.CopyBuffer(
+                    BufferInfo{*vertexBuffer, (vk::DeviceSize)range.vertexOffset * m_vertexStride},
+                    BufferInfo{*m_vertexBuffer, (vk::DeviceSize)vertexStart * m_vertexStride},
+                    (size_t)range.vertexCount * m_vertexStride);
+            if (range.indexCount > 0)
+                commandBuffer.CopyBuffer(
+                    BufferInfo{*indexBuffer, (vk::DeviceSize)range.firstIndex * sizeof(uint32_t)},
+                    BufferInfo{*m_indexBuffer, (vk::DeviceSize)indexStart * sizeof(uint32_t)},
+                    (size_t)range.indexCount * sizeof(uint32_t));
+            range.vertexOffset = vertexStart;
+            range.firstIndex   = indexStart;
+        }
+    }
+    // frames recorded so far keep drawing from the old buffers
+    m_retiredBuffers.push_back(
+        {std::move(vertexBuffer), std::move(indexBuffer), backend.GetFrameNumber(),
+         uploadContext.Submit()});
+}
+
+void GeometryPool::Bind(CommandBuffer& commandBuffer) const {
+    if (!m_vertexBuffer) return;
+    commandBuffer.BindVertexBuffers(*m_vertexBuffer);
+    commandBuffer.BindIndexBufferUInt32(*m_indexBuffer);
+}
+} // namespace wind
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "Runtime/Base/Macro.h"
+#include "Runtime/Base/TlsfAllocator.h"
+#include "Runtime/Render/RHI/Buffer.h"
+#include "Runtime/Render/RHI/CommandBuffer.h"
+
+namespace wind {
+// Device local vertex and index mega buffers shared by every mesh of one vertex layout. Meshes
+// hold a handle to a range of both, allocated with a TLSF offset allocator in units of vertices
+// and indices, and draw with its firstIndex and vertexOffset after the pass bound the pool once.
+// Buffers are created on the first allocation and written through the UploadContext. When a range
+// does not fit, the buffers grow to the next power of two and the old contents are copied over;
+// Defragment compacts the live ranges to the front of new buffers. Freed ranges and replaced
+// buffers are kept until every frame that may still read them retired. Ranges move only during
+// Defragment, so read them through Get at draw time. Render thread only.
+class GeometryPool {
+public:
+    using Handle                          = uint32_t;
+    static constexpr Handle InvalidHandle = UINT32_MAX;
+
+    struct Range {
+        uint32_t vertexOffset = 0;
+        uint32_t vertexCount  = 0;
+        uint32_t firstIndex   = 0;
+        uint32_t indexCount   = 0;
+    };
+
+    GeometryPool(uint32_t vertexStride, uint32_t vertexCapacity, uint32_t indexCapacity);
+    PERMIT_COPY(GeometryPool)
+    PERMIT_MOVE(GeometryPool)
+
+    // vertices holds vertexStride bytes per vertex, the indices are relative to the first one.
+    // The copies join the open UploadContext batch, submitting it is up to the caller.
+    Handle Allocate(std::span<const std::byte> vertices, std::span<const uint32_t> indices);
+    void   Free(Handle handle);
+    // moves every live range to the front of new buffers, call it before recording any draw of
+    // the frame
+    void   Defragment();
+    // releases the ranges and buffers no frame in flight reads any more, call it once per frame
+    void   Update();
+
+    [[nodiscard]] const Range& Get(Handle handle) const { return m_entries[handle].range; }
+    // binds the vertex buffer to binding 0 and the uint32 index buffer
+    void                       Bind(CommandBuffer& commandBuffer) const;
+
+    [[nodiscard]] uint32_t GetVertexStride() const { return m_vertexStride; }
+    [[nodiscard]] uint32_t GetUsedVertexCount() const { return m_vertexAllocator.GetUsedSize(); }
+    [[nodiscard]] uint32_t GetUsedIndexCount() const { return m_indexAllocator.GetUsedSize(); }
+
+private:
+    struct Entry {
+        Range                     range;
+        TlsfAllocator::Allocation vertexAllocation;
+        TlsfAllocator::Allocation indexAllocation;
+        bool                      isLive = false;
+    };
+
+    struct PendingFree {
+        TlsfAllocator::Allocation vertexAllocation;
+        TlsfAllocator::Allocation indexAllocation;
+        uint64_t                  frame;
+    };
+
+    struct RetiredBuffers {
+        std::shared_ptr<Buffer> vertexBuffer;
+        std::shared_ptr<Buffer> indexBuffer;
+        uint64_t                frame;
+        // the upload that copied out of them
+        uint64_t                ticket;
+    };
+
+    void CreateBuffers(uint32_t vertexCapacity, uint32_t indexCapacity);
+    // replaces both buffers, growing keeps every offset while compacting reassigns them
+    void Rebuild(uint32_t vertexCapacity, uint32_t indexCapacity, bool compact);
+    void ReleaseRetired();
+    [[nodiscard]] bool IsRetired(uint64_t frame) const;
+
+    uint32_t                m_vertexStride;
+    std::shared_ptr<Buffer> m_vertexBuffer;
+    std::shared_ptr<Buffer> m_indexBuffer;
+    TlsfAllocator           m_vertexAllocator;
+    TlsfAllocator           m_indexAllocator;
+
+    std::vector<Entry>          m_entries;
+    std::vector<Handle>         m_freeHandles;
+    std::vector<PendingFree>    m_pendingFrees;
+    std::vector<RetiredBuffers> m_retiredBuffers;
+};
+} // namespace wind
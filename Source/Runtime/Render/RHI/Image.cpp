@@ -135,16 +135,37 @@ static vk::Format FormatTable[] = {
     vk::Format::eD16UnormS8Uint,
     vk::Format::eD24UnormS8Uint,
     vk::Format::eD32SfloatS8Uint,
+    vk::Format::eBc1RgbUnormBlock,
+    vk::Format::eBc1RgbSrgbBlock,
+    vk::Format::eBc1RgbaUnormBlock,
+    vk::Format::eBc1RgbaSrgbBlock,
+    vk::Format::eBc2UnormBlock,
+    vk::Format::eBc2SrgbBlock,
+    vk::Format::eBc3UnormBlock,
+    vk::Format::eBc3SrgbBlock,
+    vk::Format::eBc4UnormBlock,
+    vk::Format::eBc4SnormBlock,
+    vk::Format::eBc5UnormBlock,
+    vk::Format::eBc5SnormBlock,
+    vk::Format::eBc6HUfloatBlock,
+    vk::Format::eBc6HSfloatBlock,
+    vk::Format::eBc7UnormBlock,
+    vk::Format::eBc7SrgbBlock,
 };
 
 const vk::Format& ToNative(Format format) { return FormatTable[(size_t)format]; }
 
 Format FromNative(const vk::Format& format) {
+    Format result = TryFromNative(format);
+    assert(result != Format::UNDEFINED || format == vk::Format::eUndefined);
+    return result;
+}
+
+Format TryFromNative(const vk::Format& format) {
     for (size_t i = 0; i < std::size(FormatTable); i++) {
         if (FormatTable[i] == format) return (Format)i;
     }
-    assert(false);
-    return (Format)0;
+    return Format::UNDEFINED;
 }
 
 vk::ImageViewType GetImageViewType(const Image& image) {
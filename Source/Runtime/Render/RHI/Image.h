@@ -145,10 +145,28 @@ enum class Format : uint32_t {
     D16_UNORM_S8_UINT,
     D24_UNORM_S8_UINT,
     D32_SFLOAT_S8_UINT,
+    BC1_RGB_UNORM_BLOCK,
+    BC1_RGB_SRGB_BLOCK,
+    BC1_RGBA_UNORM_BLOCK,
+    BC1_RGBA_SRGB_BLOCK,
+    BC2_UNORM_BLOCK,
+    BC2_SRGB_BLOCK,
+    BC3_UNORM_BLOCK,
+    BC3_SRGB_BLOCK,
+    BC4_UNORM_BLOCK,
+    BC4_SNORM_BLOCK,
+    BC5_UNORM_BLOCK,
+    BC5_SNORM_BLOCK,
+    BC6H_UFLOAT_BLOCK,
+    BC6H_SFLOAT_BLOCK,
+    BC7_UNORM_BLOCK,
+    BC7_SRGB_BLOCK,
 };
 
 const vk::Format& ToNative(Format format);
 Format FromNative(const vk::Format& format);
+// UNDEFINED for formats Format has no entry for, for formats read from files
+Format TryFromNative(const vk::Format& format);
 
 struct ImageUsage {
     using Value = uint32_t;
@@ -0,0 +1,109 @@
+#include "PipelineCache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "Runtime/Base/Io.h"
+#include "Runtime/Base/Macro.h"
+#include "Runtime/Base/Utils.h"
+
+namespace wind {
+static constexpr uint32_t PipelineCacheMagic   = 0x4F535057; // "WPSO"
+static constexpr uint32_t PipelineCacheVersion = 1;
+
+PipelineCache::Header PipelineCache::MakeHeader() const {
+    Header header{};
+    header.magic         = PipelineCacheMagic;
+    header.version       = PipelineCacheVersion;
+    header.vendorID      = m_properties.vendorID;
+    header.deviceID      = m_properties.deviceID;
+    header.driverVersion = m_properties.driverVersion;
+    std::memcpy(header.pipelineCacheUUID, m_properties.pipelineCacheUUID, VK_UUID_SIZE);
+    return header;
+}
+
+void PipelineCache::Init(vk::Device device, const vk::PhysicalDeviceProperties& properties,
+                         std::string path) {
+    m_device     = device;
+    m_properties = properties;
+    m_path       = std::move(path);
+
+    // a missing cache is the normal first-run case
+    io::MappedFile  file;
+    std::error_code ec;
+    if (std::filesystem::exists(m_path, ec)) file = io::MappedFile(m_path);
+
+    vk::PipelineCacheCreateInfo createInfo{};
+    if (file.IsValid() && file.GetSize() >= sizeof(Header)) {
+        Header header{}, expected = MakeHeader();
+        std::memcpy(&header, file.GetData(), sizeof(Header));
+        auto data = file.GetView().subspan(sizeof(Header));
+        // the driver also checks its own header, this one catches driver updates and other GPUs
+        // before handing it a blob at all
+        if (header.magic == expected.magic && header.version == expected.version &&
+            header.vendorID == expected.vendorID && header.deviceID == expected.deviceID &&
+            header.driverVersion == expected.driverVersion &&
+            std::memcmp(header.pipelineCacheUUID, expected.pipelineCacheUUID, VK_UUID_SIZE) == 0 &&
+            header.dataSize == data.size() && header.dataHash == utils::HashBytes(data)) {
+            createInfo.setInitialDataSize(data.size()).setPInitialData(data.data());
+            m_isLoaded = true;
+        } else {
+            WIND_CORE_WARN("Pipeline cache {} is stale or belongs to another device, rebuild it",
+                           m_path);
+        }
+    }
+    m_cache = m_device.createPipelineCache(createInfo);
+    if (m_isLoaded)
+        WIND_CORE_INFO("Load pipeline cache {} with {} bytes", m_path, createInfo.initialDataSize);
+}
+
+void PipelineCache::CleanUp() {
+    if (!m_cache) return;
+    Save();
+    m_device.destroyPipelineCache(m_cache);
+    m_cache = nullptr;
+}
+
+// write into a temporary file first so a crash never leaves a half written cache behind
+void PipelineCache::Save() {
+    auto data = m_device.getPipelineCacheData(m_cache);
+    if (data.empty()) return;
+
+    Header header   = MakeHeader();
+    header.dataSize = data.size();
+    header.dataHash = utils::HashBytes(data);
+
+    const auto tempPath = m_path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            WIND_CORE_WARN("Can not write pipeline cache {}, skip saving", m_path);
+            return;
+        }
+        file.write((const char*)&header, sizeof(Header));
+        file.write((const char*)data.data(), (std::streamsize)data.size());
+        if (!file.good()) {
+            WIND_CORE_WARN("Failed to write pipeline cache {}", m_path);
+            return;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, m_path, ec);
+    if (ec) {
+        WIND_CORE_WARN("Failed to move pipeline cache into place {}: {}", m_path, ec.message());
+        std::filesystem::remove(tempPath, ec);
+    }
+}
+
+void PipelineCache::RecordCreated(float milliseconds) {
+    ++m_createdCount;
+    m_creationTime += milliseconds;
+}
+
+void PipelineCache::LogStats() const {
+    WIND_CORE_INFO("Pipeline cache: {} pipelines created in {:.2f} ms, {} reused, {} start",
+                   m_createdCount, m_creationTime, m_reusedCount, m_isLoaded ? "warm" : "cold");
+}
+} // namespace wind
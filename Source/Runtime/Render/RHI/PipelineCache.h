@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <vulkan/vulkan.hpp>
+
+namespace wind {
+// The driver side cache of compiled pipelines, kept on disk between runs. The blob is written with
+// a header naming the vendor, device, driver version and pipeline cache UUID it came from and is
+// only handed back to a matching driver, anything else starts from an empty cache. Also counts the
+// pipelines the render passes create and the time they take, the bulk of renderer startup.
+class PipelineCache {
+public:
+    void Init(vk::Device device, const vk::PhysicalDeviceProperties& properties,
+              std::string path);
+    // saves the cache to disk and destroys it
+    void CleanUp();
+
+    [[nodiscard]] vk::PipelineCache GetNativeHandle() const { return m_cache; }
+
+    // pipelines built by the driver and ones shared from the in-memory cache of render processes
+    void RecordCreated(float milliseconds);
+    void RecordReused() { ++m_reusedCount; }
+    void LogStats() const;
+
+private:
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t vendorID;
+        uint32_t deviceID;
+        uint32_t driverVersion;
+        uint8_t  pipelineCacheUUID[VK_UUID_SIZE];
+        uint64_t dataSize;
+        uint64_t dataHash;
+    };
+
+    [[nodiscard]] Header MakeHeader() const;
+    void                 Save();
+
+    vk::Device                   m_device;
+    vk::PhysicalDeviceProperties m_properties;
+    vk::PipelineCache            m_cache;
+    std::string                  m_path;
+
+    bool     m_isLoaded     = false;
+    uint32_t m_createdCount = 0;
+    uint32_t m_reusedCount  = 0;
+    float    m_creationTime = 0.0f;
+};
+} // namespace wind
@@ -1,5 +1,6 @@
 #include "Shader.h"
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <optional>
@@ -8,6 +9,7 @@
 
 #include "Runtime/Base/Io.h"
 #include "Runtime/Base/Macro.h"
+#include "Runtime/Base/Utils.h"
 #include "Runtime/Render/RHI/Backend.h"
 #include "Runtime/Render/RHI/Image.h"
 #include "Runtime/Render/RHI/Shader.h"
@@ -38,14 +40,53 @@ void GraphicsShader::GenerateVulkanDescriptorSetLayout() {
         m_setGroups[set].push_back(binding);
     }
 
+    // dynamic offsets are consumed in set and then binding order
+    std::map<std::pair<uint32_t, uint32_t>, BindMetaData*> dynamicBuffers;
+    for (auto& [resourceName, metaData] : m_reflectionDatas) {
+        if (metaData.descriptorType == vk::DescriptorType::eUniformBufferDynamic)
+            dynamicBuffers[{metaData.set, metaData.binding}] = &metaData;
+    }
+    for (auto& [setBinding, metaData] : dynamicBuffers) {
+        metaData->dynamicIndex = (uint32_t)m_dynamicOffsets.size();
+        m_dynamicOffsets.resize(m_dynamicOffsets.size() + metaData->count, 0);
+    }
+
     for (const auto& [setIndex, bindingVecs] : m_setGroups) {
+        bool isBindless =
+            std::any_of(bindingVecs.begin(), bindingVecs.end(),
+                        [](const auto& binding) { return binding.descriptorCount == 0; });
+        if (isBindless) {
+            // an unsized texture array is the global table, its set holds nothing else
+            assert(bindingVecs.size() == 1 &&
+                   bindingVecs.front().descriptorType == vk::DescriptorType::eSampledImage);
+            auto& textureRegistry = RenderBackend::GetInstance().GetTextureRegistry();
+            m_bindlessSet         = setIndex;
+            m_descriptorSetLayouts.push_back(textureRegistry.GetDescriptorSetLayout());
+            m_descriptorSets.push_back(textureRegistry.GetDescriptorSet());
+            continue;
+        }
         vk::DescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo;
         descriptorSetLayoutCreateInfo.setBindingCount(bindingVecs.size()).setBindings(bindingVecs);
         vk::DescriptorSetLayout setLayout =
             device.createDescriptorSetLayout(descriptorSetLayoutCreateInfo);
 
         m_descriptorSetLayouts.push_back(setLayout);
-        m_descriptorSets.push_back(allocater->Allocate(setLayout));
+        // filled with the version of the current frame by GetDescriptorSet
+        m_descriptorSets.push_back(vk::DescriptorSet{});
+    }
+
+    // one version of every set per frame in flight to begin with, more are allocated on demand
+    auto setCount = (uint32_t)m_descriptorSets.size();
+    m_stagedBindings.resize(setCount);
+    m_frameSets.resize(RenderBackend::GetInstance().GetMaxFrameInFlight());
+    for (auto& frameSets : m_frameSets) {
+        frameSets.versions.resize(setCount);
+        frameSets.current.resize(setCount, 0);
+        frameSets.isBound.resize(setCount, false);
+        for (uint32_t set = 0; set < setCount; ++set) {
+            if (set == m_bindlessSet) continue;
+            frameSets.versions[set].push_back({allocater->Allocate(m_descriptorSetLayouts[set])});
+        }
     }
 }
 
@@ -81,8 +122,13 @@ void GraphicsShader::CollectSpirvMetaData(std::vector<uint32_t> spivrBinary,
         }
     };
 
+    // per frame data comes from the UniformAllocator, a slice is selected by its dynamic offset
     for (auto& resource : resources.uniform_buffers) {
-        collectResource(resource, vk::DescriptorType::eUniformBuffer);
+        collectResource(resource, vk::DescriptorType::eUniformBufferDynamic);
+    }
+
+    for (auto& resource : resources.storage_buffers) {
+        collectResource(resource, vk::DescriptorType::eStorageBuffer);
     }
 
     for (auto& resource : resources.sampled_images) {
@@ -97,14 +143,23 @@ void GraphicsShader::CollectSpirvMetaData(std::vector<uint32_t> spivrBinary,
         collectResource(resource, vk::DescriptorType::eSampledImage);
     }
     
+    // one range covers the push constants of every stage, each stage may declare only the members
+    // it reads, so the union of the declared [offset, end) spans is taken
     for (const auto& resource : resources.push_constant_buffers) {
-        std::string_view             resourceName = resource.name;
-        const spirv_cross::SPIRType& type         = compiler.get_type(resource.type_id);
-        uint32_t                     size         = compiler.get_declared_struct_size(type);
+        const spirv_cross::SPIRType& type   = compiler.get_type(resource.type_id);
+        uint32_t                     end    = compiler.get_declared_struct_size(type);
+        uint32_t                     offset = end;
+        for (uint32_t i = 0; i < type.member_types.size(); ++i) {
+            offset = std::min(offset, compiler.type_struct_member_offset(type, i));
+        }
         if (!m_pushConstantMeta.has_value()) {
-            PushConstantMetaData meta{size, 0, shaderFlags};
+            PushConstantMetaData meta{end - offset, offset, shaderFlags};
             m_pushConstantMeta = std::optional<PushConstantMetaData>(meta);
         } else {
+            uint32_t mergedEnd =
+                std::max(m_pushConstantMeta->offset + m_pushConstantMeta->size, end);
+            m_pushConstantMeta->offset = std::min(m_pushConstantMeta->offset, offset);
+            m_pushConstantMeta->size   = mergedEnd - m_pushConstantMeta->offset;
             m_pushConstantMeta->shadeshaderStageFlag |= shaderFlags;
         }
     }
@@ -117,8 +172,9 @@ GraphicsShader::~GraphicsShader() {
     device.destroyShaderModule(m_fragShader);
 
     // destroy our layout
-    for (auto& descriptorSetLayout : m_descriptorSetLayouts) {
-        device.destroyDescriptorSetLayout(descriptorSetLayout);
+    for (uint32_t set = 0; set < m_descriptorSetLayouts.size(); ++set) {
+        if (set == m_bindlessSet) continue;
+        device.destroyDescriptorSetLayout(m_descriptorSetLayouts[set]);
     }
 }
 
@@ -143,92 +199,147 @@ GraphicsShader::GraphicsShader(std::string_view vertexShaderfilePath,
 
     m_fragShader = device.createShaderModule(createInfo);
 
+    auto hashBinary = [](const std::vector<uint32_t>& binary) {
+        return utils::HashBytes({(const uint8_t*)binary.data(), binary.size() * sizeof(uint32_t)});
+    };
+    uint64_t binaryHashes[] = {hashBinary(spirvVertexBinary), hashBinary(spirvFragBinary)};
+    m_hash = utils::HashBytes({(const uint8_t*)binaryHashes, sizeof(binaryHashes)});
+
     GenerateVulkanDescriptorSetLayout();
     GeneratePushConstantData();
 }
 
+void GraphicsShader::Stage(const std::string& resourceName, BoundResource resource) {
+    const auto& bindData = m_reflectionDatas[resourceName];
+    m_stagedBindings[bindData.set][bindData.binding] = std::move(resource);
+}
+
+void GraphicsShader::SyncFrame() {
+    auto& backend = RenderBackend::GetInstance();
+    if (m_frameNumber == backend.GetFrameNumber()) return;
+    // the fence of the frame was waited on, every version of its sets may be written again
+    m_frameNumber   = backend.GetFrameNumber();
+    m_frameIndex    = backend.GetCurrentFrameIndex();
+    auto& frameSets = m_frameSets[m_frameIndex];
+    std::fill(frameSets.current.begin(), frameSets.current.end(), 0);
+    std::fill(frameSets.isBound.begin(), frameSets.isBound.end(), false);
+}
+
+std::vector<vk::DescriptorSet>& GraphicsShader::GetDescriptorSet() {
+    auto& device    = RenderBackend::GetInstance().GetDevice();
+    auto& allocater = RenderBackend::GetInstance().GetDescriptorAllocator();
+    SyncFrame();
+
+    auto&                               frameSets = m_frameSets[m_frameIndex];
+    std::vector<vk::WriteDescriptorSet> writers;
+    for (uint32_t set = 0; set < m_descriptorSets.size(); ++set) {
+        if (set == m_bindlessSet) continue;
+        auto&       versions = frameSets.versions[set];
+        auto&       current  = frameSets.current[set];
+        const auto& staged   = m_stagedBindings[set];
+        // draws recorded earlier this frame keep reading the version they bound
+        if (frameSets.isBound[set] && versions[current].bindings != staged) {
+            if (++current == versions.size())
+                versions.push_back({allocater->Allocate(m_descriptorSetLayouts[set])});
+        }
+
+        auto& version = versions[current];
+        for (const auto& [binding, resource] : staged) {
+            auto bound = version.bindings.find(binding);
+            if (bound != version.bindings.end() && bound->second == resource) continue;
+            auto& written = version.bindings[binding];
+            written       = resource;
+
+            vk::WriteDescriptorSet writer;
+            writer.setDstSet(version.set)
+                .setDstBinding(binding)
+                .setDescriptorType(written.descriptorType);
+            if (written.imageInfos.empty())
+                writer.setBufferInfo(written.bufferInfo);
+            else
+                writer.setImageInfo(written.imageInfos);
+            writers.push_back(writer);
+        }
+        frameSets.isBound[set] = true;
+        m_descriptorSets[set]  = version.set;
+    }
+
+    if (!writers.empty()) device.updateDescriptorSets(writers, {});
+    return m_descriptorSets;
+}
+
 void GraphicsShader::Bind(const std::string& resourceName, const ShaderImageDesc& imageDesc) {
-    auto& device = RenderBackend::GetInstance().GetDevice();
     if (!m_reflectionDatas.contains(resourceName)) {
         WIND_CORE_ERROR("Fail to find shader resource {}", resourceName);
+        return;
     }
     vk::DescriptorImageInfo imageInfo;
     imageInfo.setImageLayout(ImageUsageToImageLayout(imageDesc.usage))
         .setImageView(imageDesc.image->GetNativeView(ImageView::NATIVE))
         .setSampler(imageDesc.sampler->GetNativeHandle());
 
-    auto                   bindData = m_reflectionDatas[resourceName];
-    vk::WriteDescriptorSet writer;
-    writer.setDescriptorType(bindData.descriptorType)
-        .setDescriptorCount(bindData.count)
-        .setDstBinding(bindData.binding)
-        .setImageInfo(imageInfo)
-        .setDstSet(m_descriptorSets[bindData.set]);
-
-    device.updateDescriptorSets(1, &writer, 0, nullptr);
+    Stage(resourceName, {m_reflectionDatas[resourceName].descriptorType, {}, {imageInfo}});
 }
 
-void GraphicsShader::Bind(const std::string& resourceName, const std::vector<Image>& textureArray) {
-    auto& device = RenderBackend::GetInstance().GetDevice();
+void GraphicsShader::Bind(const std::string&                         resourceName,
+                          const std::vector<std::shared_ptr<Image>>& textureArray) {
     if (!m_reflectionDatas.contains(resourceName)) {
         WIND_CORE_ERROR("Fail to find shader resource {}", resourceName);
+        return;
     }
-    auto                                 bindData = m_reflectionDatas[resourceName];
-    vk::WriteDescriptorSet               writer;
     std::vector<vk::DescriptorImageInfo> imageInfos;
-    
     for (const auto& image : textureArray) {
         auto& info = imageInfos.emplace_back();
         info.setImageLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
-            .setImageView(image.GetNativeView(ImageView::NATIVE))
+            .setImageView(image->GetNativeView(ImageView::NATIVE))
             .setSampler(nullptr);
     }
 
-    writer.setDescriptorType(vk::DescriptorType::eSampledImage)
-        .setDescriptorCount(imageInfos.size())
-        .setImageInfo(imageInfos)
-        .setDstBinding(bindData.binding)
-        .setDstSet(m_descriptorSets[bindData.set]);
-
-    device.updateDescriptorSets(1, &writer, 0, nullptr);
+    Stage(resourceName, {vk::DescriptorType::eSampledImage, {}, std::move(imageInfos)});
 }
 
 void GraphicsShader::Bind(const std::string& resourceName, const ShaderBufferDesc& bufferDesc) {
-    auto& device = RenderBackend::GetInstance().GetDevice();
     if (!m_reflectionDatas.contains(resourceName)) {
         WIND_CORE_ERROR("Fail to find shader resource {}", resourceName);
+        return;
     }
+    auto                     bindData = m_reflectionDatas[resourceName];
     vk::DescriptorBufferInfo bufferInfo;
     bufferInfo.setBuffer(bufferDesc.buffer->GetNativeHandle())
         .setOffset(bufferDesc.offset)
         .setRange(bufferDesc.range);
-    auto                   bindData = m_reflectionDatas[resourceName];
-    vk::WriteDescriptorSet writer;
-    writer.setDescriptorType(bindData.descriptorType)
-        .setDescriptorCount(bindData.count)
-        .setDstBinding(bindData.binding)
-        .setBufferInfo(bufferInfo)
-        .setDstSet(m_descriptorSets[bindData.set]);
-
-    device.updateDescriptorSets(1, &writer, 0, nullptr);
+    // another slice of the same buffer only moves the dynamic offset
+    if (bindData.descriptorType == vk::DescriptorType::eUniformBufferDynamic) {
+        m_dynamicOffsets[bindData.dynamicIndex] = (uint32_t)bufferDesc.offset;
+        bufferInfo.setOffset(0);
+    }
+
+    Stage(resourceName, {bindData.descriptorType, bufferInfo, {}});
 }
 
 void GraphicsShader::Bind(const std::string& resourceName, std::shared_ptr<Sampler> sampler) {
-    auto& device = RenderBackend::GetInstance().GetDevice();
     if (!m_reflectionDatas.contains(resourceName)) {
         WIND_CORE_ERROR("Fail to find shader resource {}", resourceName);
+        return;
     }
     vk::DescriptorImageInfo imageInfo;
     imageInfo.setSampler(sampler->GetNativeHandle());
 
-    auto                   bindData = m_reflectionDatas[resourceName];
-    vk::WriteDescriptorSet writer;
-    writer.setDescriptorType(vk::DescriptorType::eSampler)
-        .setImageInfo(imageInfo)
-        .setDescriptorCount(bindData.count)
-        .setDstBinding(bindData.binding)
-        .setDstSet(m_descriptorSets[bindData.set]);
-    device.updateDescriptorSets(1, &writer, 0, nullptr);
+    Stage(resourceName, {vk::DescriptorType::eSampler, {}, {imageInfo}});
+}
+
+void GraphicsShader::Bind(const std::string& resourceName, TextureRegistry& textureRegistry) {
+    if (!m_reflectionDatas.contains(resourceName)) {
+        WIND_CORE_ERROR("Fail to find shader resource {}", resourceName);
+        return;
+    }
+    const auto& bindData = m_reflectionDatas[resourceName];
+    if (bindData.set != m_bindlessSet) {
+        WIND_CORE_ERROR("Shader resource {} is not a bindless texture table", resourceName);
+        assert(false);
+        return;
+    }
+    m_descriptorSets[bindData.set] = textureRegistry.GetDescriptorSet();
 }
 
 std::shared_ptr<GraphicsShader>
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <map>
 #include <memory>
 #include <optional>
 #include <string>
@@ -11,6 +12,7 @@
 #include "Runtime/Render/RHI/Buffer.h"
 #include "Runtime/Render/RHI/Image.h"
 #include "Runtime/Render/RHI/Sampler.h"
+#include "Runtime/Render/RHI/TextureRegistry.h"
 
 namespace wind {
 struct ShaderBase {};
@@ -32,9 +34,12 @@ public:
     struct BindMetaData {
         uint32_t             set;
         uint32_t             binding;
+        // 0 for an unsized array, the set holding it is the bindless texture table
         uint32_t             count;
         vk::DescriptorType   descriptorType;
         vk::ShaderStageFlags shaderStageFlag;
+        // position in the dynamic offsets of the bound sets, dynamic uniform buffers only
+        uint32_t             dynamicIndex = 0;
     };
 
     struct PushConstantMetaData {
@@ -51,29 +56,73 @@ public:
     [[nodiscard]] auto  GetFragmentShaderModule() const { return m_fragShader; }
     [[nodiscard]] auto  GetShaderReflesctionData() const { return m_reflectionDatas; }
     [[nodiscard]] auto& GetDescriptorSetLayouts() const { return m_descriptorSetLayouts; }
-    [[nodiscard]] auto& GetDescriptorSet() { return m_descriptorSets; }
+    // content hash of both SPIR-V binaries, equal for shaders built from the same code
+    [[nodiscard]] uint64_t GetHash() const { return m_hash; }
+    // applies the binds staged since the last call in one batch and returns the sets of the
+    // current frame, call it right before binding them
+    std::vector<vk::DescriptorSet>& GetDescriptorSet();
+    // pass along with GetDescriptorSet when binding the sets
+    [[nodiscard]] auto& GetDynamicOffsets() const { return m_dynamicOffsets; }
     [[nodiscard]] auto& GetPushConstantRange() {return m_pushConstantRange;}
     [[nodiscard]] auto& GetPushConstantShaderStage() {return m_pushConstantMeta->shadeshaderStageFlag;}
     
+    // Binds are staged and written by the next GetDescriptorSet, a binding that already holds the
+    // same view, sampler or buffer range is not written again. Uniform blocks are dynamic uniform
+    // buffers: the descriptor covers range bytes from the start of the buffer and offset becomes
+    // the dynamic offset of the next bind, e.g. a slice of the UniformAllocator.
     void Bind(const std::string& resourceName, const ShaderBufferDesc& bufferDesc);
     void Bind(const std::string& resourceName, const ShaderImageDesc& imageDesc);
-    void Bind(const std::string& resourceName, const std::vector<Image>& textureArray);
+    void Bind(const std::string& resourceName,
+              const std::vector<std::shared_ptr<Image>>& textureArray);
     void Bind(const std::string& resourceName, std::shared_ptr<Sampler> sampler);
+    // bind the set of the current frame, call every frame like the other binds
+    void Bind(const std::string& resourceName, TextureRegistry& textureRegistry);
     
 private:
+    // what one binding holds, compared against the set to skip redundant writes
+    struct BoundResource {
+        vk::DescriptorType                   descriptorType;
+        vk::DescriptorBufferInfo             bufferInfo;
+        std::vector<vk::DescriptorImageInfo> imageInfos;
+
+        bool operator==(const BoundResource&) const = default;
+    };
+    using SetBindings = std::map<uint32_t, BoundResource>;
+
+    struct SetVersion {
+        vk::DescriptorSet set;
+        SetBindings       bindings;
+    };
+
+    // Sets of one frame in flight, written only after the fence of the frame was waited on. A set
+    // already bound this frame is not written again, changed binds go to its next version.
+    struct FrameSets {
+        std::vector<std::vector<SetVersion>> versions;
+        std::vector<uint32_t>                current;
+        std::vector<bool>                    isBound;
+    };
+
+    void Stage(const std::string& resourceName, BoundResource resource);
+    void SyncFrame();
     void GenerateVulkanDescriptorSetLayout();
     void GeneratePushConstantData();
     void CollectSpirvMetaData(std::vector<uint32_t> spivrBinary, vk::ShaderStageFlags shaderFlags);
     vk::ShaderModule m_vertexShader;
     vk::ShaderModule m_fragShader;
+    uint64_t         m_hash = 0;
 
     std::unordered_map<std::string, BindMetaData> m_reflectionDatas;
-    
-    std::unordered_map<std::string, ShaderImageDesc>  m_imageShaderResource;
-    std::unordered_map<std::string, ShaderBufferDesc> m_bufferShaderResource;
 
     std::vector<vk::DescriptorSetLayout> m_descriptorSetLayouts;
     std::vector<vk::DescriptorSet>       m_descriptorSets;
+    // staged binds per set and the sets of every frame in flight
+    std::vector<SetBindings>             m_stagedBindings;
+    std::vector<FrameSets>               m_frameSets;
+    uint32_t                             m_frameIndex  = 0;
+    uint64_t                             m_frameNumber = UINT64_MAX;
+    std::vector<uint32_t>                m_dynamicOffsets;
+    // owned by the texture registry, not destroyed with the shader
+    std::optional<uint32_t>              m_bindlessSet {std::nullopt};
 
     std::optional<PushConstantMetaData>  m_pushConstantMeta {std::nullopt};
     std::optional<vk::PushConstantRange> m_pushConstantRange {std::nullopt};
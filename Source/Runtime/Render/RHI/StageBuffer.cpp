@@ -1,21 +1,176 @@
 #include "StageBuffer.h"
 
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define WIND_STAGE_STREAMING_STORES 1
+#endif
+
+#include "Runtime/Base/Macro.h"
+#include "Runtime/Render/RHI/Backend.h"
+
 namespace wind {
+// Staging memory is write combined, streaming stores fill whole lines without reading them first
+// and without evicting the source from the cache.
+static void CopyToStagingMemory(uint8_t* destination, const uint8_t* source, size_t byteSize) {
+#ifdef WIND_STAGE_STREAMING_STORES
+    size_t head = std::min(byteSize, (16 - (uintptr_t)destination % 16) % 16);
+    std::memcpy(destination, source, head);
+    destination += head, source += head, byteSize -= head;
+
+    size_t blockCount = byteSize / 16;
+    auto*  target     = (__m128i*)destination;
+    for (size_t i = 0; i < blockCount; ++i)
+        _mm_stream_si128(target + i, _mm_loadu_si128((const __m128i*)source + i));
+    _mm_sfence();
+    destination += blockCount * 16, source += blockCount * 16, byteSize -= blockCount * 16;
+#endif
+    std::memcpy(destination, source, byteSize);
+}
+
 StageBuffer::StageBuffer(size_t byteSize)
-    : buffer(byteSize, BufferUsage::TRANSFER_SOURCE, MemoryUsage::CPU_TO_GPU), currentOffset(0) {
+    : buffer(byteSize, BufferUsage::TRANSFER_SOURCE, MemoryUsage::CPU_TO_GPU) {
     (void)this->buffer.MapMemory();
 }
 
-StageBuffer::Allocation StageBuffer::Submit(const uint8_t* data, uint32_t byteSize) {
-    assert(this->currentOffset + byteSize <= this->buffer.GetByteSize());
+bool StageBuffer::TryAllocate(vk::CommandBuffer commands, uint32_t byteSize, uint32_t alignment,
+                              uint32_t& offset) {
+    const uint32_t capacity = GetByteSize();
+    // an empty ring starts over at the front, which keeps large allocations from wrapping
+    if (this->usedSize == 0) this->head = this->tail = this->flushOffset = 0;
 
-    if (data != nullptr) { this->buffer.CopyData(data, byteSize, this->currentOffset); }
+    offset = (this->head + alignment - 1) / alignment * alignment;
+    if (offset + byteSize > capacity) offset = 0;
+    // the padding up to offset, or up to the end of the ring when wrapping
+    uint32_t padding = offset >= this->head ? offset - this->head : capacity - this->head;
+    uint32_t needed  = padding + byteSize;
+    if (this->usedSize + needed > capacity) return false;
 
-    this->currentOffset += byteSize;
-    return Allocation{byteSize, this->currentOffset - byteSize};
+    this->head = (offset + byteSize) % capacity;
+    this->usedSize += needed;
+    this->flushSize += needed;
+    // consecutive allocations of one command buffer share a region
+    if (this->regions.empty() || this->regions.back().commands != commands ||
+        this->regions.back().submissionValue != PendingSubmission)
+        this->regions.push_back({0, commands});
+    this->regions.back().size += needed;
+    return true;
 }
 
-void StageBuffer::Reset() { this->currentOffset = 0; }
+void StageBuffer::Reclaim(uint64_t completedValue) {
+    while (!this->regions.empty() && this->regions.front().submissionValue <= completedValue) {
+        this->tail = (this->tail + this->regions.front().size) % GetByteSize();
+        this->usedSize -= this->regions.front().size;
+        this->regions.pop_front();
+    }
+}
+
+StageBuffer::Allocation StageBuffer::Submit(CommandBuffer& commandBuffer, const uint8_t* data,
+                                            uint32_t byteSize, uint32_t alignment) {
+    if (byteSize > GetByteSize()) {
+        // larger uploads are split by CopyToBuffer and CopyToImage
+        WIND_CORE_ERROR("Stage allocation of {} bytes exceeds the {} byte ring", byteSize,
+                        GetByteSize());
+        throw std::runtime_error("Stage allocation larger than the staging buffer");
+    }
+    auto&    backend  = RenderBackend::GetInstance();
+    auto     commands = commandBuffer.GetNativeHandle();
+    uint32_t offset   = 0;
+    while (!TryAllocate(commands, byteSize, alignment, offset)) {
+        Reclaim(backend.PollCompletedSubmission());
+        if (TryAllocate(commands, byteSize, alignment, offset)) break;
+
+        const auto& oldest = this->regions.front();
+        if (oldest.submissionValue != PendingSubmission) {
+            backend.WaitForSubmission(oldest.submissionValue);
+            Reclaim(backend.PollCompletedSubmission());
+            continue;
+        }
+        if (oldest.commands != commands) {
+            // only the upload context batch can be submitted from here, the loop then waits on
+            // its ticket like on any other submission
+            auto& uploadContext = backend.GetUploadContext();
+            if (!uploadContext.IsRecording(oldest.commands)) {
+                WIND_CORE_ERROR("Stage buffer is full of copies recorded into another command "
+                                "buffer");
+                throw std::runtime_error("Staging buffer held by an unsubmitted command buffer");
+            }
+            (void)uploadContext.Submit();
+            continue;
+        }
+        // the oldest copies are still recorded in commandBuffer, run it to make room
+        backend.RestartCommandBuffer(commandBuffer);
+        commands = commandBuffer.GetNativeHandle();
+    }
 
-void StageBuffer::Flush() { this->buffer.FlushMemory(this->currentOffset, 0); }
-} // namespace wind
\ No newline at end of file
+    if (data != nullptr) CopyToStagingMemory(this->buffer.MapMemory() + offset, data, byteSize);
+    return Allocation{byteSize, offset};
+}
+
+void StageBuffer::CopyToBuffer(CommandBuffer& commandBuffer, std::span<const std::byte> data,
+                               const Buffer& destination, size_t offset) {
+    // half the ring per chunk, the previous chunk can stay in flight while the next is written
+    const size_t chunkSize = std::max<size_t>(GetByteSize() / 2, 1);
+    for (size_t copied = 0; copied < data.size(); copied += chunkSize) {
+        auto chunk      = data.subspan(copied, std::min(chunkSize, data.size() - copied));
+        auto allocation = Submit(commandBuffer, chunk);
+        commandBuffer.CopyBuffer(BufferInfo{this->buffer, allocation.Offset},
+                                 BufferInfo{destination, offset + copied}, allocation.Size);
+    }
+}
+
+void StageBuffer::CopyToImage(CommandBuffer& commandBuffer, std::span<const uint8_t> data,
+                              const ImageInfo& destination, uint32_t rowHeight,
+                              uint32_t alignment) {
+    const uint32_t levelHeight = destination.resource.get().GetMipLevelHeight(destination.mipLevel);
+    const uint32_t rowCount    = (levelHeight + rowHeight - 1) / rowHeight;
+    const size_t   rowSize     = data.size() / rowCount;
+    // a level that fits the ring is a single copy, larger ones go in bands of half the ring like
+    // the chunks of CopyToBuffer
+    uint32_t bandRows = rowCount;
+    if (data.size() + alignment > GetByteSize())
+        bandRows = (uint32_t)std::max<size_t>((GetByteSize() / 2 - alignment) / rowSize, 1);
+
+    auto usage = destination.usage;
+    for (uint32_t firstRow = 0; firstRow < rowCount; firstRow += bandRows) {
+        uint32_t rows       = std::min(bandRows, rowCount - firstRow);
+        auto     allocation = Submit(commandBuffer, data.data() + firstRow * rowSize,
+                                     (uint32_t)(rows * rowSize), alignment);
+        commandBuffer.CopyBufferToImage(BufferInfo{this->buffer, allocation.Offset},
+                                        ImageInfo{destination.resource, usage,
+                                                  destination.mipLevel, destination.layer},
+                                        firstRow * rowHeight, rows * rowHeight);
+        usage = ImageUsage::TRANSFER_DESTINATION;
+    }
+}
+
+uint32_t StageBuffer::GetAvailableSize() {
+    Reclaim(RenderBackend::GetInstance().PollCompletedSubmission());
+    return GetByteSize() - this->usedSize;
+}
+
+std::span<uint8_t> StageBuffer::GetMappedView(const Allocation& allocation) {
+    return {this->buffer.MapMemory() + allocation.Offset, allocation.Size};
+}
+
+void StageBuffer::Flush() {
+    const uint32_t capacity = GetByteSize();
+    uint32_t       end      = this->flushOffset + this->flushSize;
+    // a range wrapping around the end is flushed in two parts
+    uint32_t firstSize = std::min(end, capacity) - this->flushOffset;
+    if (firstSize > 0) this->buffer.FlushMemory(firstSize, this->flushOffset);
+    if (end > capacity) this->buffer.FlushMemory(end - capacity, 0);
+    this->flushOffset = this->head;
+    this->flushSize   = 0;
+}
+
+void StageBuffer::Close(vk::CommandBuffer commands, uint64_t submissionValue) {
+    for (auto& region : this->regions) {
+        if (region.commands == commands && region.submissionValue == PendingSubmission)
+            region.submissionValue = submissionValue;
+    }
+}
+} // namespace wind
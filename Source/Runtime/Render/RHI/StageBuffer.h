@@ -1,12 +1,21 @@
 #pragma once
 
+#include <deque>
+#include <span>
+
 #include "Runtime/Render/RHI/Buffer.h"
+#include "Runtime/Render/RHI/CommandBuffer.h"
 
 namespace wind {
+// Persistent ring of write combined staging memory. Allocations are made at the head and belong to
+// the command buffer they are recorded into, RenderBackend closes them with its submission value
+// when it submits that command buffer. Regions are reclaimed at the tail once their submission
+// retired: a full ring waits on the submission of its oldest region. A region still being recorded
+// is submitted first, the open UploadContext batch through the upload context and the command
+// buffer asking for more by submitting, waiting on and beginning it again, so recording uploads
+// must happen outside of a render pass. Regions of any other unsubmitted command buffer are an
+// error.
 class StageBuffer {
-    Buffer   buffer;
-    uint32_t currentOffset;
-
 public:
     struct Allocation {
         uint32_t Size;
@@ -15,23 +24,69 @@ public:
 
     StageBuffer(size_t byteSize);
 
-    Allocation    Submit(const uint8_t* data, uint32_t byteSize);
+    // byteSize must fit the ring, data is copied in with non temporal stores unless it is null.
+    // Larger uploads go through CopyToBuffer or CopyToImage.
+    Allocation    Submit(CommandBuffer& commandBuffer, const uint8_t* data, uint32_t byteSize,
+                         uint32_t alignment = 1);
+    // a buffer upload of any size, split into chunks the ring can hold
+    void          CopyToBuffer(CommandBuffer& commandBuffer, std::span<const std::byte> data,
+                               const Buffer& destination, size_t offset);
+    // a tightly packed image level of any size, split into bands of whole rows, rowHeight is the
+    // texel height of one row of data: 4 for a row of BCn blocks, 1 otherwise
+    void          CopyToImage(CommandBuffer& commandBuffer, std::span<const uint8_t> data,
+                              const ImageInfo& destination, uint32_t rowHeight, uint32_t alignment);
+    // make the writes since the last flush visible to the device
     void          Flush();
-    void          Reset();
+    // the allocations recorded into commands are read by the submission with this value
+    void          Close(vk::CommandBuffer commands, uint64_t submissionValue);
     Buffer&       GetBuffer() { return this->buffer; }
     const Buffer& GetBuffer() const { return this->buffer; }
-    uint32_t      GetCurrentOffset() const { return this->currentOffset; }
+    [[nodiscard]] uint32_t GetByteSize() const { return (uint32_t)this->buffer.GetByteSize(); }
+    // free bytes without waiting on the GPU, wrapping around the end may still waste some of them
+    [[nodiscard]] uint32_t GetAvailableSize();
 
-    template <typename T> Allocation Submit(std::span<const T> view) {
-        return this->Submit((const uint8_t*)view.data(), uint32_t(view.size() * sizeof(T)));
+    // the mapped bytes of an allocation, Submit(commandBuffer, nullptr, byteSize) reserves one to
+    // write in place
+    std::span<uint8_t> GetMappedView(const Allocation& allocation);
+
+    template <typename T>
+    Allocation Submit(CommandBuffer& commandBuffer, std::span<const T> view,
+                      uint32_t alignment = 1) {
+        return this->Submit(commandBuffer, (const uint8_t*)view.data(),
+                            uint32_t(view.size() * sizeof(T)), alignment);
     }
 
-    template <typename T> Allocation Submit(std::span<T> view) {
-        return this->Submit((const uint8_t*)view.data(), uint32_t(view.size() * sizeof(T)));
+    template <typename T>
+    Allocation Submit(CommandBuffer& commandBuffer, std::span<T> view, uint32_t alignment = 1) {
+        return this->Submit(commandBuffer, (const uint8_t*)view.data(),
+                            uint32_t(view.size() * sizeof(T)), alignment);
     }
 
-    template <typename T> Allocation Submit(const T* value) {
-        return this->Submit((uint8_t*)value, uint32_t(sizeof(T)));
+    template <typename T> Allocation Submit(CommandBuffer& commandBuffer, const T* value) {
+        return this->Submit(commandBuffer, (const uint8_t*)value, uint32_t(sizeof(T)));
     }
+
+private:
+    static constexpr uint64_t PendingSubmission = UINT64_MAX;
+
+    struct Region {
+        uint32_t          size;
+        vk::CommandBuffer commands;
+        uint64_t          submissionValue = PendingSubmission;
+    };
+
+    bool TryAllocate(vk::CommandBuffer commands, uint32_t byteSize, uint32_t alignment,
+                     uint32_t& offset);
+    void Reclaim(uint64_t completedValue);
+
+    Buffer             buffer;
+    uint32_t           head        = 0;
+    uint32_t           tail        = 0;
+    // bytes between tail and head, including the padding skipped when wrapping
+    uint32_t           usedSize    = 0;
+    // bytes written since the last flush, starting at flushOffset
+    uint32_t           flushOffset = 0;
+    uint32_t           flushSize   = 0;
+    std::deque<Region> regions;
 };
-} // namespace wind
\ No newline at end of file
+} // namespace wind
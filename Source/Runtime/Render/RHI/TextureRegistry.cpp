@@ -0,0 +1,139 @@
+#include "TextureRegistry.h"
+
+#include <algorithm>
+
+#include "Runtime/Base/Macro.h"
+
+namespace wind {
+void TextureRegistry::Init(vk::Device device, uint32_t frameCount, uint32_t capacity) {
+    assert(capacity > 0 && capacity <= MaxTextureCount);
+    m_device   = device;
+    m_capacity = capacity;
+
+    // update after bind lifts the descriptor limits to the ones of the bindless tier, partially
+    // bound lets the unused tail of the array and unregistered slots stay unwritten
+    vk::DescriptorBindingFlags bindingFlags =
+        vk::DescriptorBindingFlagBits::ePartiallyBound |
+        vk::DescriptorBindingFlagBits::eUpdateAfterBind;
+    vk::DescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo;
+    bindingFlagsInfo.setBindingFlags(bindingFlags);
+
+    vk::DescriptorSetLayoutBinding binding;
+    binding.setBinding(0)
+        .setDescriptorType(vk::DescriptorType::eSampledImage)
+        .setDescriptorCount(m_capacity)
+        .setStageFlags(vk::ShaderStageFlagBits::eAll);
+
+    vk::DescriptorSetLayoutCreateInfo layoutInfo;
+    layoutInfo.setFlags(vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool)
+        .setBindings(binding)
+        .setPNext(&bindingFlagsInfo);
+    m_layout = m_device.createDescriptorSetLayout(layoutInfo);
+
+    vk::DescriptorPoolSize       poolSize{vk::DescriptorType::eSampledImage,
+                                    m_capacity * frameCount};
+    vk::DescriptorPoolCreateInfo poolInfo;
+    poolInfo.setFlags(vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind)
+        .setMaxSets(frameCount)
+        .setPoolSizes(poolSize);
+    m_pool = m_device.createDescriptorPool(poolInfo);
+
+    std::vector<vk::DescriptorSetLayout> layouts(frameCount, m_layout);
+    vk::DescriptorSetAllocateInfo        allocateInfo;
+    allocateInfo.setDescriptorPool(m_pool).setSetLayouts(layouts);
+    auto sets = m_device.allocateDescriptorSets(allocateInfo);
+
+    m_frameSets.resize(frameCount);
+    for (uint32_t i = 0; i < frameCount; ++i) m_frameSets[i].set = sets[i];
+    WIND_CORE_INFO("Create bindless texture table of {} slots", m_capacity);
+}
+
+void TextureRegistry::CleanUp() {
+    m_device.destroyDescriptorPool(m_pool);
+    m_device.destroyDescriptorSetLayout(m_layout);
+    m_frameSets.clear();
+    m_images.clear();
+    m_freeIndices.clear();
+    m_retiredImages.clear();
+}
+
+uint32_t TextureRegistry::Register(std::shared_ptr<Image> image) {
+    uint32_t index;
+    if (!m_freeIndices.empty()) {
+        index = m_freeIndices.back();
+        m_freeIndices.pop_back();
+    } else if (m_images.size() < m_capacity) {
+        index = (uint32_t)m_images.size();
+        m_images.emplace_back();
+    } else {
+        WIND_CORE_ERROR("Bindless texture table is full, {} slots in use", m_capacity);
+        return InvalidIndex;
+    }
+    m_images[index] = std::move(image);
+    MarkDirty(index);
+    return index;
+}
+
+void TextureRegistry::Update(uint32_t index, std::shared_ptr<Image> image) {
+    assert(index < m_images.size() && m_images[index]);
+    if (m_images[index] == image) return;
+    m_retiredImages.push_back({std::move(m_images[index]), InvalidIndex, m_frame});
+    m_images[index] = std::move(image);
+    MarkDirty(index);
+}
+
+void TextureRegistry::Unregister(uint32_t index) {
+    assert(index < m_images.size() && m_images[index]);
+    // the slot keeps its stale descriptor, nothing samples it once the materials stopped
+    // referencing the index
+    m_retiredImages.push_back({std::move(m_images[index]), index, m_frame});
+    m_images[index] = nullptr;
+    for (auto& frameSet : m_frameSets) std::erase(frameSet.dirtyIndices, index);
+}
+
+void TextureRegistry::BeginFrame(uint32_t frameIndex) {
+    m_frameIndex = frameIndex;
+    ++m_frame;
+
+    // every set was fetched again or is not in use, and every frame that could still sample a
+    // retired image has waited on its fence by now
+    std::erase_if(m_retiredImages, [this](const RetiredImage& retired) {
+        if (retired.frame + m_frameSets.size() >= m_frame) return false;
+        if (retired.index != InvalidIndex) m_freeIndices.push_back(retired.index);
+        return true;
+    });
+}
+
+vk::DescriptorSet TextureRegistry::GetDescriptorSet() {
+    auto& frameSet = m_frameSets[m_frameIndex];
+    if (frameSet.dirtyIndices.empty()) return frameSet.set;
+
+    auto& dirtyIndices = frameSet.dirtyIndices;
+    std::sort(dirtyIndices.begin(), dirtyIndices.end());
+    dirtyIndices.erase(std::unique(dirtyIndices.begin(), dirtyIndices.end()), dirtyIndices.end());
+
+    std::vector<vk::DescriptorImageInfo> imageInfos;
+    std::vector<vk::WriteDescriptorSet>  writers;
+    imageInfos.reserve(dirtyIndices.size());
+    writers.reserve(dirtyIndices.size());
+    for (uint32_t index : dirtyIndices) {
+        auto& info = imageInfos.emplace_back();
+        info.setImageLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
+            .setImageView(m_images[index]->GetNativeView(ImageView::NATIVE));
+
+        auto& writer = writers.emplace_back();
+        writer.setDescriptorType(vk::DescriptorType::eSampledImage)
+            .setDstSet(frameSet.set)
+            .setDstBinding(0)
+            .setDstArrayElement(index)
+            .setImageInfo(info);
+    }
+    m_device.updateDescriptorSets(writers, {});
+    dirtyIndices.clear();
+    return frameSet.set;
+}
+
+void TextureRegistry::MarkDirty(uint32_t index) {
+    for (auto& frameSet : m_frameSets) frameSet.dirtyIndices.push_back(index);
+}
+} // namespace wind
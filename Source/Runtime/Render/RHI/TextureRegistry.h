@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include "Runtime/Render/RHI/Image.h"
+
+namespace wind {
+// Global bindless table of sampled images. Every registered image gets an index into one large
+// partially bound, update after bind texture2D array that shaders declare as an unsized array and
+// index with material data, so no pass binds textures per draw. Indices stay stable until they are
+// unregistered. There is one descriptor set per frame in flight: writes are queued and applied to
+// the set of the current frame when it is fetched, which never touches a set the GPU may still
+// read. A replaced or unregistered image is kept alive, and its index reserved, until every frame
+// that may still sample it has retired. Render thread only.
+class TextureRegistry {
+public:
+    // upper bound of the table, devices with lower update after bind limits get fewer slots
+    static constexpr uint32_t MaxTextureCount = 4096;
+    static constexpr uint32_t InvalidIndex    = UINT32_MAX;
+
+    void Init(vk::Device device, uint32_t frameCount, uint32_t capacity);
+    void CleanUp();
+
+    // InvalidIndex once the table is full
+    [[nodiscard]] uint32_t Register(std::shared_ptr<Image> image);
+    // point an index at another image, e.g. a streamed texture replacing its placeholder
+    void                   Update(uint32_t index, std::shared_ptr<Image> image);
+    void                   Unregister(uint32_t index);
+
+    // called once the fence of frameIndex was waited on
+    void              BeginFrame(uint32_t frameIndex);
+    // the set of the current frame with every queued write applied
+    vk::DescriptorSet GetDescriptorSet();
+
+    [[nodiscard]] auto     GetDescriptorSetLayout() const { return m_layout; }
+    [[nodiscard]] uint32_t GetCapacity() const { return m_capacity; }
+
+private:
+    struct FrameSet {
+        vk::DescriptorSet     set;
+        std::vector<uint32_t> dirtyIndices;
+    };
+
+    struct RetiredImage {
+        std::shared_ptr<Image> image;
+        // freed together with the image when the index was unregistered
+        uint32_t               index;
+        uint64_t               frame;
+    };
+
+    void MarkDirty(uint32_t index);
+
+    vk::Device              m_device;
+    vk::DescriptorPool      m_pool;
+    vk::DescriptorSetLayout m_layout;
+    uint32_t                m_capacity = 0;
+
+    std::vector<FrameSet>               m_frameSets;
+    std::vector<std::shared_ptr<Image>> m_images;
+    std::vector<uint32_t>               m_freeIndices;
+    std::vector<RetiredImage>           m_retiredImages;
+    uint32_t                            m_frameIndex = 0;
+    uint64_t                            m_frame      = 0;
+};
+} // namespace wind
@@ -0,0 +1,72 @@
+#include "UniformAllocator.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Runtime/Base/Macro.h"
+#include "Runtime/Render/RHI/Backend.h"
+
+namespace wind {
+void UniformAllocator::Init(uint32_t frameCapacity, uint32_t frameCount, uint32_t alignment) {
+    m_alignment  = std::max<size_t>(alignment, 1);
+    m_frameCount = frameCount;
+    CreateBuffer(frameCapacity);
+    BeginFrame(0);
+}
+
+void UniformAllocator::CleanUp() {
+    m_buffer.reset();
+    m_retiredBuffers.clear();
+    m_mappedMemory = nullptr;
+}
+
+void UniformAllocator::CreateBuffer(size_t frameCapacity) {
+    m_frameCapacity = (frameCapacity + m_alignment - 1) / m_alignment * m_alignment;
+    m_buffer = std::make_shared<Buffer>(m_frameCapacity * m_frameCount, BufferUsage::UNIFORM_BUFFER,
+                                        MemoryUsage::CPU_TO_GPU);
+    m_mappedMemory = m_buffer->MapMemory();
+}
+
+void UniformAllocator::BeginFrame(uint32_t frameIndex) {
+    if (!m_retiredBuffers.empty()) {
+        auto& backend = RenderBackend::GetInstance();
+        std::erase_if(m_retiredBuffers, [&backend](const RetiredBuffer& retired) {
+            return retired.frame + backend.GetMaxFrameInFlight() < backend.GetFrameNumber();
+        });
+    }
+    m_frameIndex    = frameIndex;
+    m_frameBegin    = frameIndex * m_frameCapacity;
+    m_offset        = m_frameBegin;
+    m_flushedOffset = m_frameBegin;
+}
+
+void UniformAllocator::Grow(size_t minSize) {
+    // the slices handed out so far stay in the old buffer, draws recorded with them still read it
+    Flush();
+    auto frame = RenderBackend::GetInstance().GetFrameNumber();
+    m_retiredBuffers.push_back({std::move(m_buffer), frame});
+    size_t frameCapacity = std::max(m_frameCapacity * 2, m_frameCapacity + minSize);
+    WIND_CORE_WARN("Uniform allocator is out of space, grow to {} bytes per frame", frameCapacity);
+    CreateBuffer(frameCapacity);
+
+    m_frameBegin    = m_frameIndex * m_frameCapacity;
+    m_offset        = m_frameBegin;
+    m_flushedOffset = m_frameBegin;
+}
+
+void UniformAllocator::Flush() {
+    if (m_offset == m_flushedOffset) return;
+    m_buffer->FlushMemory(m_offset - m_flushedOffset, m_flushedOffset);
+    m_flushedOffset = m_offset;
+}
+
+ShaderBufferDesc UniformAllocator::Allocate(const void* data, size_t byteSize, size_t range) {
+    range              = std::max(range, byteSize);
+    size_t alignedSize = (range + m_alignment - 1) / m_alignment * m_alignment;
+    if (m_offset + alignedSize > m_frameBegin + m_frameCapacity) Grow(alignedSize);
+    std::memcpy(m_mappedMemory + m_offset, data, byteSize);
+    ShaderBufferDesc desc{m_buffer, m_offset, range};
+    m_offset += alignedSize;
+    return desc;
+}
+} // namespace wind
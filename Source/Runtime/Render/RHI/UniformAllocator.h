@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Runtime/Render/RHI/Buffer.h"
+#include "Runtime/Render/RHI/Shader.h"
+
+namespace wind {
+// Linear allocator of per frame uniform data. One persistently mapped buffer holds a region per
+// frame in flight, Allocate copies into the next aligned slice of the region of the current frame
+// and the region starts over once its frame comes around again. Shaders see their uniform blocks
+// as dynamic uniform buffers over the whole buffer and the slice is picked by its dynamic offset
+// when the descriptor set is bound, so a frame never overwrites data an earlier frame in flight
+// still reads, and moving to another slice needs no descriptor write. A frame running out of space
+// moves to a new buffer with twice the regions, the old one is kept until every frame that may
+// read it retired and the shaders write their descriptors again on the next bind. Render thread
+// only.
+class UniformAllocator {
+public:
+    void Init(uint32_t frameCapacity, uint32_t frameCount, uint32_t alignment);
+    void CleanUp();
+
+    // called once the fence of frameIndex was waited on
+    void BeginFrame(uint32_t frameIndex);
+    // make the writes of the current frame visible to the device
+    void Flush();
+
+    // a slice holding a copy of data, valid until the current frame retires. A range larger than
+    // byteSize leaves the rest of the slice uninitialized, e.g. for arrays of a declared size.
+    [[nodiscard]] ShaderBufferDesc Allocate(const void* data, size_t byteSize, size_t range = 0);
+    template <typename T> [[nodiscard]] ShaderBufferDesc Allocate(const T& value) {
+        return Allocate(&value, sizeof(T));
+    }
+
+    [[nodiscard]] size_t GetUsedSize() const { return m_offset - m_frameBegin; }
+
+private:
+    struct RetiredBuffer {
+        std::shared_ptr<Buffer> buffer;
+        uint64_t                frame;
+    };
+
+    void CreateBuffer(size_t frameCapacity);
+    // replace the buffer with one whose regions hold at least minSize bytes more than now
+    void Grow(size_t minSize);
+
+    std::shared_ptr<Buffer>    m_buffer;
+    std::vector<RetiredBuffer> m_retiredBuffers;
+    uint32_t                   m_frameCount = 0;
+    uint32_t                   m_frameIndex = 0;
+    uint8_t*                m_mappedMemory  = nullptr;
+    size_t                  m_frameCapacity = 0;
+    size_t                  m_alignment     = 1;
+    size_t                  m_frameBegin    = 0;
+    size_t                  m_offset        = 0;
+    size_t                  m_flushedOffset = 0;
+};
+} // namespace wind
@@ -0,0 +1,116 @@
+#include "UploadContext.h"
+
+#include <algorithm>
+
+#include "Runtime/Base/Macro.h"
+#include "Runtime/Render/RHI/Backend.h"
+
+namespace wind {
+void UploadContext::Init(vk::Device device, uint32_t queueFamilyIndex, vk::Queue queue) {
+    m_device = device;
+    m_queue  = queue;
+
+    vk::CommandPoolCreateInfo createInfo;
+    createInfo.setFlags(vk::CommandPoolCreateFlagBits::eResetCommandBuffer)
+        .setQueueFamilyIndex(queueFamilyIndex);
+    m_pool = m_device.createCommandPool(createInfo);
+    WIND_CORE_INFO("Create upload context on queue family {}", queueFamilyIndex);
+}
+
+void UploadContext::CleanUp() {
+    if (m_isRecording) m_submittedBatches.push_back(m_openBatch);
+    for (const auto& batch : m_submittedBatches) {
+        m_device.destroyFence(batch.fence);
+        m_device.destroySemaphore(batch.semaphore);
+    }
+    m_device.destroyCommandPool(m_pool);
+    m_submittedBatches.clear();
+    m_waitSemaphores.clear();
+    m_isRecording = false;
+}
+
+UploadContext::Batch UploadContext::AcquireBatch() {
+    // a batch is free once its copies retired and the frame waiting on its semaphore did too
+    uint64_t completedValue = RenderBackend::GetInstance().PollCompletedSubmission();
+    auto     isFree         = [completedValue](const Batch& batch) {
+        return batch.ticket <= completedValue && batch.waitValue != 0 &&
+               batch.waitValue <= completedValue;
+    };
+    auto freeBatch = std::find_if(m_submittedBatches.begin(), m_submittedBatches.end(), isFree);
+    if (freeBatch != m_submittedBatches.end()) {
+        Batch batch = *freeBatch;
+        m_submittedBatches.erase(freeBatch);
+        m_device.resetFences(batch.fence);
+        batch.commands.reset();
+        batch.ticket    = 0;
+        batch.waitValue = 0;
+        return batch;
+    }
+
+    vk::CommandBufferAllocateInfo allocateInfo;
+    allocateInfo.setCommandPool(m_pool)
+        .setCommandBufferCount(1)
+        .setLevel(vk::CommandBufferLevel::ePrimary);
+    Batch batch;
+    batch.commands  = m_device.allocateCommandBuffers(allocateInfo).front();
+    batch.fence     = m_device.createFence(vk::FenceCreateInfo{});
+    batch.semaphore = m_device.createSemaphore(vk::SemaphoreCreateInfo{});
+    return batch;
+}
+
+CommandBuffer& UploadContext::GetCommandBuffer() {
+    if (!m_isRecording) {
+        m_openBatch     = AcquireBatch();
+        m_commandBuffer = CommandBuffer{m_openBatch.commands};
+        m_commandBuffer.Begin();
+        m_isRecording = true;
+        m_batchSize   = 0;
+    }
+    return m_commandBuffer;
+}
+
+void UploadContext::CopyToBuffer(std::span<const std::byte> data, const Buffer& destination,
+                                 size_t offset) {
+    auto& commandBuffer = GetCommandBuffer();
+    RenderBackend::GetInstance().GetStagingBuffer().CopyToBuffer(commandBuffer, data, destination,
+                                                                 offset);
+    m_batchSize += data.size();
+    if (m_batchSize >= MaxBatchSize) (void)Submit();
+}
+
+UploadContext::Ticket UploadContext::Submit() {
+    if (!m_isRecording) return m_lastTicket;
+    auto& backend = RenderBackend::GetInstance();
+    m_commandBuffer.End();
+    backend.GetStagingBuffer().Flush();
+
+    vk::SubmitInfo submitInfo;
+    submitInfo.setCommandBuffers(m_openBatch.commands).setSignalSemaphores(m_openBatch.semaphore);
+    m_queue.submit(submitInfo, m_openBatch.fence);
+
+    m_openBatch.ticket = backend.TrackSubmission(m_openBatch.fence);
+    backend.GetStagingBuffer().Close(m_openBatch.commands, m_openBatch.ticket);
+    m_waitSemaphores.push_back(m_openBatch.semaphore);
+    m_submittedBatches.push_back(m_openBatch);
+    m_isRecording = false;
+    m_lastTicket  = m_openBatch.ticket;
+    return m_lastTicket;
+}
+
+bool UploadContext::IsComplete(Ticket ticket) const {
+    return ticket <= RenderBackend::GetInstance().PollCompletedSubmission();
+}
+
+void UploadContext::Wait(Ticket ticket) { RenderBackend::GetInstance().WaitForSubmission(ticket); }
+
+bool UploadContext::IsRecording(vk::CommandBuffer commands) const {
+    return m_isRecording && commands == m_openBatch.commands;
+}
+
+void UploadContext::ReleaseWaitSemaphores(uint64_t submissionValue) {
+    for (auto& batch : m_submittedBatches) {
+        if (batch.waitValue == 0) batch.waitValue = submissionValue;
+    }
+    m_waitSemaphores.clear();
+}
+} // namespace wind
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include "Runtime/Render/RHI/Buffer.h"
+#include "Runtime/Render/RHI/CommandBuffer.h"
+
+namespace wind {
+// Batches buffer uploads into submissions on the transfer queue, a copy engine beside the
+// graphics queue when the device has one. Submit never waits: it returns a ticket, a value on the
+// RenderBackend submission timeline, that can be polled or waited on while the CPU keeps decoding
+// and recording the next batch. Every batch also signals a semaphore the next frame submission
+// waits on, so frames never read a buffer whose copy is still running. Buffers filled here are
+// shared with the graphics family, see Buffer::Init. Images are uploaded on the graphics queue,
+// their layout transitions and mip blits need it. Render thread only.
+class UploadContext {
+public:
+    using Ticket = uint64_t;
+
+    // a batch is submitted once its staged bytes pass this, letting the copies start early
+    static constexpr size_t MaxBatchSize = 16 * 1024 * 1024;
+
+    void Init(vk::Device device, uint32_t queueFamilyIndex, vk::Queue queue);
+    void CleanUp();
+
+    // the command buffer of the open batch, begun on first use
+    CommandBuffer& GetCommandBuffer();
+    void           CopyToBuffer(std::span<const std::byte> data, const Buffer& destination,
+                                size_t offset = 0);
+    // submits the open batch, the ticket of the last submission when nothing was recorded
+    Ticket         Submit();
+    [[nodiscard]] bool IsComplete(Ticket ticket) const;
+    void               Wait(Ticket ticket);
+    // whether commands belong to the open batch
+    [[nodiscard]] bool IsRecording(vk::CommandBuffer commands) const;
+
+    // semaphores of the batches no frame waited on yet, the frame submission waits on all of them
+    // and passes its submission value to ReleaseWaitSemaphores afterwards
+    [[nodiscard]] const auto& GetWaitSemaphores() const { return m_waitSemaphores; }
+    void                      ReleaseWaitSemaphores(uint64_t submissionValue);
+
+private:
+    struct Batch {
+        vk::CommandBuffer commands;
+        vk::Fence         fence;
+        vk::Semaphore     semaphore;
+        Ticket            ticket    = 0;
+        // the submission waiting on semaphore, 0 until a frame took it
+        uint64_t          waitValue = 0;
+    };
+
+    Batch AcquireBatch();
+
+    vk::Device      m_device;
+    vk::Queue       m_queue;
+    vk::CommandPool m_pool;
+
+    CommandBuffer              m_commandBuffer{vk::CommandBuffer{}};
+    Batch                      m_openBatch;
+    bool                       m_isRecording = false;
+    size_t                     m_batchSize   = 0;
+    std::vector<Batch>         m_submittedBatches;
+    std::vector<vk::Semaphore> m_waitSemaphores;
+    Ticket                     m_lastTicket = 0;
+};
+} // namespace wind
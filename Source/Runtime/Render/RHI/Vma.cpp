@@ -60,4 +60,25 @@ void UnmapMemory(VmaAllocation allocation) {
 void FlushMemory(VmaAllocation allocation, size_t byteSize, size_t offset) {
     vmaFlushAllocation(RenderBackend::GetInstance().GetAllocator(), allocation, offset, byteSize);
 }
+
+void InvalidateMemory(VmaAllocation allocation, size_t byteSize, size_t offset) {
+    vmaInvalidateAllocation(RenderBackend::GetInstance().GetAllocator(), allocation, offset,
+                            byteSize);
+}
+
+MemoryBudget GetDeviceMemoryBudget() {
+    VmaAllocator                            allocator = GetVulkanAllocator();
+    const VkPhysicalDeviceMemoryProperties* properties;
+    vmaGetMemoryProperties(allocator, &properties);
+    VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+    vmaGetHeapBudgets(allocator, budgets);
+
+    MemoryBudget result{0, 0};
+    for (uint32_t i = 0; i < properties->memoryHeapCount; ++i) {
+        if (!(properties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)) continue;
+        result.usage += budgets[i].usage;
+        result.budget += budgets[i].budget;
+    }
+    return result;
+}
 } // namespace wind
@@ -25,6 +25,13 @@ enum class MemoryUsage {
     GPU_LAZILY_ALLOCATED, // used only on mobile platforms
 };
 
+// summed over the device local heaps, VMA estimates both from its own allocations and the heap
+// sizes unless VK_EXT_memory_budget is enabled
+struct MemoryBudget {
+    size_t usage;
+    size_t budget;
+};
+
 VmaAllocator  GetVulkanAllocator();
 void          DeallocateImage(const vk::Image& image, VmaAllocation allocation);
 void          DeallocateBuffer(const vk::Buffer& buffer, VmaAllocation allocation);
@@ -35,4 +42,6 @@ VmaAllocation AllocateBuffer(const vk::BufferCreateInfo& bufferCreateInfo, Memor
 uint8_t*      MapMemory(VmaAllocation allocation);
 void          UnmapMemory(VmaAllocation allocation);
 void          FlushMemory(VmaAllocation allocation, size_t byteSize, size_t offset);
+void          InvalidateMemory(VmaAllocation allocation, size_t byteSize, size_t offset);
+MemoryBudget  GetDeviceMemoryBudget();
 } // namespace wind
\ No newline at end of file
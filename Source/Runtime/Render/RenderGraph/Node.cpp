@@ -1,5 +1,6 @@
 #include "Node.h"
 
+#include "Runtime/Base/Utils.h"
 #include "Runtime/Render/RHI/Backend.h"
 
 #include "Runtime/Render/RenderGraph/RenderGraphBuilder.h"
@@ -158,6 +159,18 @@ void PassNode::CreateRenderPass() {
         .setAttachmentCount(attachments.size());
 
     renderPass = device.createRenderPass(renderPassCreateInfo);
+
+    // single subpass render passes are compatible when their attachments match in format and
+    // sample count, load and store ops or layouts do not matter to a pipeline
+    std::vector<uint32_t> compatibility;
+    for (const auto& attachment : attachments) {
+        compatibility.push_back((uint32_t)attachment.format);
+        compatibility.push_back((uint32_t)attachment.samples);
+    }
+    compatibility.push_back((uint32_t)colorAttachmentDescriptions.size());
+    compatibility.push_back(isWriteToDepth);
+    renderPassHash = utils::HashBytes(
+        {(const uint8_t*)compatibility.data(), compatibility.size() * sizeof(uint32_t)});
 }
 
 } // namespace wind
\ No newline at end of file
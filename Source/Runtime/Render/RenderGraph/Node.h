@@ -87,6 +87,8 @@ public:
     PassType        passType{PassType::Graphic};
     std::string     passName;
     vk::RenderPass  renderPass;
+    // equal for render passes pipelines can be shared between, see CreateRenderPass
+    uint64_t        renderPassHash = 0;
     vk::Framebuffer frameBuffer;
     PassExecFunc    passCallback;
 
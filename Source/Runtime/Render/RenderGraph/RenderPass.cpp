@@ -1,7 +1,12 @@
 #include "RenderPass.h"
 
+#include <bit>
+#include <chrono>
+#include <unordered_map>
+
 #include "Runtime/Base/Io.h"
 #include "Runtime/Base/Macro.h"
+#include "Runtime/Base/Utils.h"
 #include "Runtime/Render/RHI/Backend.h"
 #include "Runtime/Resource/Mesh.h"
 
@@ -30,6 +35,8 @@ RenderProcessBuilder& RenderProcessBuilder::SetShader(GraphicsShader* graphicsSh
             pushConstantRange.value());
     }
     m_pipelineLayoutCreateInfo.setSetLayoutCount(shaderLayouts.size()).setSetLayouts(shaderLayouts);
+    // set layouts and push constants are reflected from the code, the hash covers them as well
+    m_shaderHash = graphicsShader->GetHash();
 
     return *this;
 }
@@ -67,8 +74,10 @@ RenderProcessBuilder::SetDepthSetencilTestState(bool depthTestEnable, bool depth
     return *this;
 }
 
-RenderProcessBuilder& RenderProcessBuilder::SetRenderPass(vk::RenderPass renderPass) {
-    m_renderPass = renderPass;
+RenderProcessBuilder& RenderProcessBuilder::SetRenderPass(vk::RenderPass renderPass,
+                                                          uint64_t       compatibilityHash) {
+    m_renderPass     = renderPass;
+    m_renderPassHash = compatibilityHash;
     return *this;
 }
 
@@ -77,8 +86,89 @@ RenderProcessBuilder& RenderProcessBuilder::SetNeedVerTex(bool condition) {
     return *this;
 }
 
+RenderProcessBuilder& RenderProcessBuilder::SetCullMode(vk::CullModeFlags cullMode,
+                                                        vk::FrontFace     frontFace) {
+    m_cullMode  = cullMode;
+    m_frontFace = frontFace;
+    return *this;
+}
+
+// every state BuildGraphicProcess reads, the fixed function state it sets itself is the same for
+// all processes
+uint64_t RenderProcessBuilder::HashState() const {
+    std::vector<uint32_t> state;
+    auto pushHash = [&state](uint64_t hash) {
+        state.push_back(uint32_t(hash));
+        state.push_back(uint32_t(hash >> 32));
+    };
+    pushHash(m_shaderHash);
+    pushHash(m_renderPassHash != 0 ? m_renderPassHash : (uint64_t)(VkRenderPass)m_renderPass);
+
+    state.push_back(m_needVertexData);
+    if (m_needVertexData) {
+        state.push_back(m_vertexInputBinding.binding);
+        state.push_back(m_vertexInputBinding.stride);
+        state.push_back((uint32_t)m_vertexInputBinding.inputRate);
+        for (const auto& attribute : m_vertexAttributeDescriptions) {
+            state.push_back(attribute.location);
+            state.push_back(attribute.binding);
+            state.push_back((uint32_t)attribute.format);
+            state.push_back(attribute.offset);
+        }
+    }
+
+    const auto& blendState = m_PipelineColorBlendStateCreateInfo;
+    state.push_back(blendState.logicOpEnable);
+    state.push_back((uint32_t)blendState.logicOp);
+    for (uint32_t i = 0; i < blendState.attachmentCount; ++i) {
+        const auto& attachment = blendState.pAttachments[i];
+        state.push_back(attachment.blendEnable);
+        state.push_back((uint32_t)attachment.srcColorBlendFactor);
+        state.push_back((uint32_t)attachment.dstColorBlendFactor);
+        state.push_back((uint32_t)attachment.colorBlendOp);
+        state.push_back((uint32_t)attachment.srcAlphaBlendFactor);
+        state.push_back((uint32_t)attachment.dstAlphaBlendFactor);
+        state.push_back((uint32_t)attachment.alphaBlendOp);
+        state.push_back((uint32_t)attachment.colorWriteMask);
+    }
+    for (float constant : blendState.blendConstants)
+        state.push_back(std::bit_cast<uint32_t>(constant));
+
+    const auto& depthState = m_depthStencilStateCreateInfo;
+    state.push_back(depthState.depthTestEnable);
+    state.push_back(depthState.depthWriteEnable);
+    state.push_back((uint32_t)depthState.depthCompareOp);
+    state.push_back(depthState.depthBoundsTestEnable);
+    state.push_back(depthState.stencilTestEnable);
+    state.push_back(std::bit_cast<uint32_t>(depthState.minDepthBounds));
+    state.push_back(std::bit_cast<uint32_t>(depthState.maxDepthBounds));
+
+    state.push_back((uint32_t)m_cullMode);
+    state.push_back((uint32_t)m_frontFace);
+
+    // the viewport is baked in
+    const auto& extent = RenderBackend::GetInstance().GetSurfaceExtent();
+    state.push_back(extent.width);
+    state.push_back(extent.height);
+
+    return utils::HashBytes({(const uint8_t*)state.data(), state.size() * sizeof(uint32_t)});
+}
+
 std::shared_ptr<RenderProcess> RenderProcessBuilder::BuildGraphicProcess() {
-    auto& device = RenderBackend::GetInstance().GetDevice();
+    // live processes by the hash of their state, render thread only
+    static std::unordered_map<uint64_t, std::weak_ptr<RenderProcess>> s_processes;
+
+    auto& backend       = RenderBackend::GetInstance();
+    auto& device        = backend.GetDevice();
+    auto& pipelineCache = backend.GetPipelineCache();
+
+    uint64_t stateHash = HashState();
+    if (auto iter = s_processes.find(stateHash); iter != s_processes.end()) {
+        if (auto process = iter->second.lock()) {
+            pipelineCache.RecordReused();
+            return process;
+        }
+    }
     // vertex input
     vk::PipelineVertexInputStateCreateInfo inputStateCreateInfo;
 
@@ -111,8 +201,8 @@ std::shared_ptr<RenderProcess> RenderProcessBuilder::BuildGraphicProcess() {
     vk::PipelineRasterizationStateCreateInfo rasterizationStateCreateInfo;
     rasterizationStateCreateInfo.setRasterizerDiscardEnable(false)
         .setDepthClampEnable(false)
-        .setCullMode(vk::CullModeFlagBits::eNone)
-        .setFrontFace(vk::FrontFace::eClockwise)
+        .setCullMode(m_cullMode)
+        .setFrontFace(m_frontFace)
         .setPolygonMode(vk::PolygonMode::eFill)
         .setLineWidth(1);
 
@@ -134,13 +224,21 @@ std::shared_ptr<RenderProcess> RenderProcessBuilder::BuildGraphicProcess() {
         .setLayout(pipelineLayout)
         .setRenderPass(m_renderPass);
 
-    auto createResult = device.createGraphicsPipeline({}, createInfo);
+    auto start        = std::chrono::steady_clock::now();
+    auto createResult = device.createGraphicsPipeline(pipelineCache.GetNativeHandle(), createInfo);
     if (createResult.result != vk::Result::eSuccess) {
         WIND_CORE_ERROR("Fail to create Graphics Pipeline");
     }
-
-    return std::make_shared<RenderProcess>(createResult.value, pipelineLayout,
-                                           vk::PipelineBindPoint::eGraphics);
+    pipelineCache.RecordCreated(
+        std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+    auto process = std::make_shared<RenderProcess>(createResult.value, pipelineLayout,
+                                                   vk::PipelineBindPoint::eGraphics);
+    // only misses build a process, so dropping the destroyed ones here keeps the map at the live
+    // processes without touching it on every hit
+    std::erase_if(s_processes, [](const auto& entry) { return entry.second.expired(); });
+    s_processes[stateHash] = process;
+    return process;
 }
 
 RenderProcess::~RenderProcess() {
@@ -41,6 +41,9 @@ struct ColorAttachmentBlendState {
 };
 
 // old version
+// Processes are shared: one built from the same shader code and state for a compatible render pass
+// as a live one is that one, e.g. the same pass of the render graph of every swapchain image. New
+// pipelines go through the pipeline cache of the backend.
 class RenderProcessBuilder {
 public:
     RenderProcessBuilder& SetShader(GraphicsShader* graphicsShader);
@@ -50,8 +53,14 @@ public:
     RenderProcessBuilder& SetDepthSetencilTestState(bool depthTestEnable, bool depthWriteEnable,
                                                     bool          stencilTestEnable,
                                                     vk::CompareOp depthCompareMode);
-    RenderProcessBuilder& SetRenderPass(vk::RenderPass renderPass);
+    // pipelines are shared between render passes of the same compatibilityHash, see
+    // PassNode::renderPassHash, or only used with renderPass itself when it is 0
+    RenderProcessBuilder& SetRenderPass(vk::RenderPass renderPass, uint64_t compatibilityHash = 0);
     RenderProcessBuilder& SetNeedVerTex(bool condition);
+    // nothing is culled by default, front faces wind counter clockwise on screen for the y flipped
+    // projections of Camera
+    RenderProcessBuilder& SetCullMode(
+        vk::CullModeFlags cullMode, vk::FrontFace frontFace = vk::FrontFace::eCounterClockwise);
     template <typename VertexFactory> RenderProcessBuilder& SetVertexFactory() {
         m_vertexAttributeDescriptions = VertexFactory::GetVertexInputAttributeDescriptions();
         m_vertexInputBinding          = VertexFactory::GetInputBindingDescription();
@@ -60,7 +69,11 @@ public:
     std::shared_ptr<RenderProcess> BuildGraphicProcess();
 
 private:
+    [[nodiscard]] uint64_t HashState() const;
+
     vk::RenderPass m_renderPass;
+    uint64_t       m_renderPassHash = 0;
+    uint64_t       m_shaderHash     = 0;
     // shader stage createInfo;
     std::vector<vk::PipelineShaderStageCreateInfo> m_shaderStageCreateInfos;
     // vertexInput state
@@ -73,6 +86,9 @@ private:
     vk::PipelineColorBlendStateCreateInfo m_PipelineColorBlendStateCreateInfo;
     // pipelineLayoutCreateInfo
     vk::PipelineLayoutCreateInfo m_pipelineLayoutCreateInfo{};
+    // rasterization state
+    vk::CullModeFlags m_cullMode  = vk::CullModeFlagBits::eNone;
+    vk::FrontFace     m_frontFace = vk::FrontFace::eClockwise;
 
     bool m_needVertexData = true;
 };
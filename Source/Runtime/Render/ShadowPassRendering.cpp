@@ -1,23 +1,21 @@
 #include "PassRendering.h"
 
+#include "Runtime/Render/MeshletCulling.h"
 #include "Runtime/Render/RHI/Shader.h"
 #include "Runtime/Render/RenderGraph/RenderResource.h"
 #include "Runtime/Scene/SceneView.h"
 
 namespace wind {
+// shadow map texels are blurred by filtering and seldom seen up close, so the shadow pass accepts
+// a much larger simplification error than the base pass
+static constexpr float ShadowLodErrorThreshold = 4.0f;
+
 void AddShadowPass(RenderGraphBuilder& graphBuilder) {
     // Allocate shader resource
-
-    std::shared_ptr<Buffer> lightProjectionBuffer = std::make_shared<Buffer>(
-        sizeof(LightProjectionBuffer), BufferUsage::UNIFORM_BUFFER, MemoryUsage::CPU_TO_GPU);
-
     std::shared_ptr<Sampler> BasicSampler =
         std::make_shared<Sampler>(Sampler::MinFilter::LINEAR, Sampler::MagFilter::LINEAR,
                                   Sampler::AddressMode::REPEAT, Sampler::MipFilter::LINEAR);
 
-    ShaderBufferDesc lightProjectionBufferDesc{lightProjectionBuffer, 0,
-                                               sizeof(LightProjectionBuffer)};
-
     TextureDesc dummy{SceneView::ShadowMapResolutionX,
                       SceneView::ShadowMapResolutionY,
                       vk::SampleCountFlagBits::e1,
@@ -45,13 +43,19 @@ void AddShadowPass(RenderGraphBuilder& graphBuilder) {
 
         RenderProcessBuilder renderProcessBuilder;
 
-        std::shared_ptr<GraphicsShader> shadowPassShader =
-            ShaderFactory::CreateGraphicsShader("Shadow.vert.spv", "Shadow.frag.spv");
+        constexpr bool UsePackedVertex = gltf::GLTFMesh::UsePackedVertex;
 
+        std::shared_ptr<GraphicsShader> shadowPassShader = ShaderFactory::CreateGraphicsShader(
+            UsePackedVertex ? "ShadowPacked.vert.spv" : "Shadow.vert.spv", "Shadow.frag.spv");
+
+        if constexpr (UsePackedVertex) {
+            renderProcessBuilder.SetVertexFactory<PackedVertex>();
+        } else {
+            renderProcessBuilder.SetVertexFactory<gltf::GLTFVertex>();
+        }
         renderProcessBuilder.SetBlendState(false)
             .SetShader(shadowPassShader.get())
-            .SetVertexFactory<gltf::GLTFVertex>()
-            .SetRenderPass(passNode->renderPass)
+            .SetRenderPass(passNode->renderPass, passNode->renderPassHash)
             .SetDepthSetencilTestState(true, true, false, vk::CompareOp::eLessOrEqual);
 
         passNode->graphicsShader = shadowPassShader;
@@ -64,21 +68,56 @@ void AddShadowPass(RenderGraphBuilder& graphBuilder) {
             auto& sponzaMesh = scene->GetRequiredGLTFModel("Sponza");
             auto& pso        = passNode->pipelineState->GetPipeline();
 
-            shadowPassShader->Bind("LightProjection", lightProjectionBufferDesc);
-
-            lightProjectionBuffer->CopyData((uint8_t*)sceneView->lightProjectionBuffer.get(),
-                                            lightProjectionBufferDesc.range,
-                                            lightProjectionBufferDesc.offset);
+            auto& uniformAllocator = RenderBackend::GetInstance().GetUniformAllocator();
+            shadowPassShader->Bind("LightProjection",
+                                   uniformAllocator.Allocate(*sceneView->lightProjectionBuffer));
 
             cmdBuffer.BindDescriptorSet(pso.bindPoint, pso.pipelineLayout,
-                                        shadowPassShader->GetDescriptorSet());
-
+                                        shadowPassShader->GetDescriptorSet(),
+                                        shadowPassShader->GetDynamicOffsets());
+
+            // same layout as the base pass push constants
+            struct ConstantData {
+                uint32_t           materialIndex;
+                uint32_t           padding[3];
+                PackedVertexBounds bounds;
+            };
+
+            // frustum culling only: the shadow pass rasterizes both faces, so backfacing
+            // meshlets still cast shadows
+            const auto& lightProjection = sceneView->lightProjectionBuffer->lightProjection;
+            Frustum     frustum         = Frustum::FromViewProjection(lightProjection);
+            std::vector<MeshletDrawRange> drawRanges;
+
+            // every submesh lives in the scene geometry pool, bound once for the whole pass
+            auto& geometryPool = scene->GetGeometryPool();
+            geometryPool.Bind(cmdBuffer);
             for (auto& subMesh : sponzaMesh.submeshes) {
-                size_t indexCount = subMesh.indexBuffer.GetByteSize() / sizeof(uint32_t);
-
-                cmdBuffer.BindVertexBuffers(subMesh.vertexBuffer);
-                cmdBuffer.BindIndexBufferUInt32(subMesh.indexBuffer);
-                cmdBuffer.DrawIndexed(indexCount, 1);
+                const auto& geometry   = geometryPool.Get(subMesh.geometry);
+                uint32_t    indexCount = geometry.indexCount;
+
+                drawRanges.clear();
+                if (subMesh.lods.empty()) {
+                    drawRanges.push_back({0, indexCount});
+                } else {
+                    uint32_t lodIndex = SelectMeshLod(
+                        subMesh.lods, subMesh.boundingSphere, lightProjection,
+                        (float)SceneView::ShadowMapResolutionY, ShadowLodErrorThreshold);
+                    const auto& lod = subMesh.lods[lodIndex];
+                    auto meshlets   = std::span<const Meshlet>(subMesh.meshlets)
+                                        .subspan(lod.firstMeshlet, lod.meshletCount);
+                    CullMeshlets(meshlets, frustum, std::nullopt, drawRanges);
+                    if (drawRanges.empty()) continue;
+                }
+
+                if constexpr (UsePackedVertex) {
+                    ConstantData constantData{subMesh.materialIndex, {}, subMesh.bounds};
+                    cmdBuffer.PushConstant(passNode, &constantData);
+                }
+                for (const auto& range : drawRanges)
+                    cmdBuffer.DrawIndexed(range.indexCount, 1,
+                                          geometry.firstIndex + range.firstIndex,
+                                          geometry.vertexOffset, 0);
             }
         };
     });
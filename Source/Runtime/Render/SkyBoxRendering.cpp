@@ -5,11 +5,6 @@ namespace wind {
 void AddSkyboxPass(RenderGraphBuilder& graphBuilder) {
     const auto [width, height] = RenderBackend::GetInstance().GetSurfaceExtent();
 
-    std::shared_ptr<Buffer> skyBoxBuffer = std::make_shared<Buffer>(
-        sizeof(SkyBoxUniformBuffer), BufferUsage::UNIFORM_BUFFER, MemoryUsage::CPU_TO_GPU);
-
-    ShaderBufferDesc skyboxBufferDesc{skyBoxBuffer, 0, sizeof(SkyBoxUniformBuffer)};
-
     static std::shared_ptr<Sampler> BasicSampler =
         std::make_shared<Sampler>(Sampler::MinFilter::LINEAR, Sampler::MagFilter::LINEAR,
                                   Sampler::AddressMode::REPEAT, Sampler::MipFilter::LINEAR);
@@ -38,7 +33,7 @@ void AddSkyboxPass(RenderGraphBuilder& graphBuilder) {
         renderProcessBuilder.SetBlendState(false)
             .SetNeedVerTex(false)
             .SetShader(skyPassShader.get())
-            .SetRenderPass(passNode->renderPass)
+            .SetRenderPass(passNode->renderPass, passNode->renderPassHash)
             .SetDepthSetencilTestState(true, false, false, vk::CompareOp::eLessOrEqual);
 
         passNode->graphicsShader = skyPassShader;
@@ -56,16 +51,14 @@ void AddSkyboxPass(RenderGraphBuilder& graphBuilder) {
             auto& camera = scene->GetActiveCamera();
 
             // Finish Binding shader
-            shader->Bind("SkyBoxBuffer", skyboxBufferDesc);
+            auto& uniformAllocator = RenderBackend::GetInstance().GetUniformAllocator();
+            shader->Bind("SkyBoxBuffer", uniformAllocator.Allocate(*sceneView->skyBoxBuffer));
             shader->Bind("SkyboxCubemap", {skyBox->skyBoxImage, ImageUsage::SHADER_READ, BasicSampler});
 
             glm::mat4 model = glm::mat4(1.0);
 
-            skyBoxBuffer->CopyData((uint8_t*)sceneView->skyBoxBuffer.get(), skyboxBufferDesc.range,
-                                   skyboxBufferDesc.offset);
-
             cmdBuffer.BindDescriptorSet(pso.bindPoint, pso.pipelineLayout,
-                                        shader->GetDescriptorSet());
+                                        shader->GetDescriptorSet(), shader->GetDynamicOffsets());
 
             // draw the skyboxs
             cmdBuffer.Draw(36, 1);
@@ -77,11 +70,6 @@ void AddSkyboxPass(RenderGraphBuilder& graphBuilder) {
 void AddSkyboxPassDefer(RenderGraphBuilder& graphBuilder) {
     const auto [width, height] = RenderBackend::GetInstance().GetSurfaceExtent();
 
-    std::shared_ptr<Buffer> skyBoxBuffer = std::make_shared<Buffer>(
-        sizeof(SkyBoxUniformBuffer), BufferUsage::UNIFORM_BUFFER, MemoryUsage::CPU_TO_GPU);
-
-    ShaderBufferDesc skyboxBufferDesc{skyBoxBuffer, 0, sizeof(SkyBoxUniformBuffer)};
-
     static std::shared_ptr<Sampler> BasicSampler =
         std::make_shared<Sampler>(Sampler::MinFilter::LINEAR, Sampler::MagFilter::LINEAR,
                                   Sampler::AddressMode::REPEAT, Sampler::MipFilter::LINEAR);
@@ -110,7 +98,7 @@ void AddSkyboxPassDefer(RenderGraphBuilder& graphBuilder) {
         renderProcessBuilder.SetBlendState(false)
             .SetNeedVerTex(false)
             .SetShader(skyPassShader.get())
-            .SetRenderPass(passNode->renderPass)
+            .SetRenderPass(passNode->renderPass, passNode->renderPassHash)
             .SetDepthSetencilTestState(true, false, false, vk::CompareOp::eLessOrEqual);
 
         passNode->graphicsShader = skyPassShader;
@@ -128,16 +116,14 @@ void AddSkyboxPassDefer(RenderGraphBuilder& graphBuilder) {
             auto& camera = scene->GetActiveCamera();
 
             // Finish Binding shader
-            shader->Bind("SkyBoxBuffer", skyboxBufferDesc);
+            auto& uniformAllocator = RenderBackend::GetInstance().GetUniformAllocator();
+            shader->Bind("SkyBoxBuffer", uniformAllocator.Allocate(*sceneView->skyBoxBuffer));
             shader->Bind("SkyboxCubemap", {skyBox->skyBoxImage, ImageUsage::SHADER_READ, BasicSampler});
 
             glm::mat4 model = glm::mat4(1.0);
 
-            skyBoxBuffer->CopyData((uint8_t*)sceneView->skyBoxBuffer.get(), skyboxBufferDesc.range,
-                                   skyboxBufferDesc.offset);
-
             cmdBuffer.BindDescriptorSet(pso.bindPoint, pso.pipelineLayout,
-                                        shader->GetDescriptorSet());
+                                        shader->GetDescriptorSet(), shader->GetDynamicOffsets());
 
             // draw the skyboxs
             cmdBuffer.Draw(36, 1);
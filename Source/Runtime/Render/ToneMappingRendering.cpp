@@ -45,7 +45,7 @@ void AddToneMappingCombinePass(RenderGraphBuilder& graphBuilder) {
         renderProcessBuilder.SetBlendState(false)
             .SetShader(shader.get())
             .SetNeedVerTex(false)
-            .SetRenderPass(passNode->renderPass)
+            .SetRenderPass(passNode->renderPass, passNode->renderPassHash)
             .SetDepthSetencilTestState(false, false, false, vk::CompareOp::eLessOrEqual);
 
         passNode->graphicsShader = shader;
@@ -108,7 +108,7 @@ void AddDeferToneMappingCombinePass(RenderGraphBuilder& graphBuilder) {
         renderProcessBuilder.SetBlendState(false)
             .SetShader(shader.get())
             .SetNeedVerTex(false)
-            .SetRenderPass(passNode->renderPass)
+            .SetRenderPass(passNode->renderPass, passNode->renderPassHash)
             .SetDepthSetencilTestState(false, false, false, vk::CompareOp::eLessOrEqual);
 
         passNode->graphicsShader = shader;
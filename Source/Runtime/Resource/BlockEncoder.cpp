@@ -0,0 +1,381 @@
+#include "BlockEncoder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace wind {
+static constexpr int   PowerIterations = 8;
+static constexpr float FitEpsilon      = 1e-6f;
+
+// BC7 4 bit index weights out of 64
+static constexpr int Bc7Weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+struct Block {
+    float texels[16][4];
+};
+
+struct BitWriter {
+    uint8_t* output;
+    uint32_t position = 0;
+
+    void Write(uint32_t value, uint32_t bitCount) {
+        for (uint32_t i = 0; i < bitCount; ++i, ++position) {
+            if (value >> i & 1) output[position / 8] |= (uint8_t)(1 << (position % 8));
+        }
+    }
+};
+
+// texels outside a partial edge block repeat the last row / column
+static Block LoadBlock(const uint8_t* level, uint32_t width, uint32_t height, uint32_t blockX,
+                       uint32_t blockY) {
+    Block block;
+    for (uint32_t y = 0; y < 4; ++y) {
+        uint32_t sourceY = std::min(blockY * 4 + y, height - 1);
+        for (uint32_t x = 0; x < 4; ++x) {
+            uint32_t       sourceX = std::min(blockX * 4 + x, width - 1);
+            const uint8_t* texel   = level + ((size_t)sourceY * width + sourceX) * 4;
+            for (int c = 0; c < 4; ++c) block.texels[y * 4 + x][c] = texel[c];
+        }
+    }
+    return block;
+}
+
+// Fit a line through the first N channels of the block with power iteration on the covariance and
+// return its extent as two endpoints
+template <int N> static void FitEndpoints(const Block& block, float endpoints[2][4]) {
+    float mean[N] = {};
+    for (const auto& texel : block.texels) {
+        for (int c = 0; c < N; ++c) mean[c] += texel[c] / 16.0f;
+    }
+
+    float covariance[N][N] = {};
+    for (const auto& texel : block.texels) {
+        for (int i = 0; i < N; ++i) {
+            for (int j = 0; j < N; ++j)
+                covariance[i][j] += (texel[i] - mean[i]) * (texel[j] - mean[j]);
+        }
+    }
+
+    // start from the covariance row of the widest channel, unlike a fixed start vector it can
+    // not be orthogonal to the principal axis
+    int widest = 0;
+    for (int c = 1; c < N; ++c) {
+        if (covariance[c][c] > covariance[widest][widest]) widest = c;
+    }
+    float axis[N];
+    for (int c = 0; c < N; ++c) axis[c] = covariance[widest][c];
+    for (int iteration = 0; iteration < PowerIterations; ++iteration) {
+        float next[N] = {}, length = 0.0f;
+        for (int i = 0; i < N; ++i) {
+            for (int j = 0; j < N; ++j) next[i] += covariance[i][j] * axis[j];
+            length = std::max(length, std::fabs(next[i]));
+        }
+        if (length < FitEpsilon) break;
+        for (int c = 0; c < N; ++c) axis[c] = next[c] / length;
+    }
+    float lengthSquared = 0.0f;
+    for (int c = 0; c < N; ++c) lengthSquared += axis[c] * axis[c];
+    float scale = lengthSquared > 0.0f ? 1.0f / std::sqrt(lengthSquared) : 0.0f;
+    for (int c = 0; c < N; ++c) axis[c] *= scale;
+
+    float minimum = 0.0f, maximum = 0.0f;
+    for (const auto& texel : block.texels) {
+        float t = 0.0f;
+        for (int c = 0; c < N; ++c) t += (texel[c] - mean[c]) * axis[c];
+        minimum = std::min(minimum, t);
+        maximum = std::max(maximum, t);
+    }
+    for (int c = 0; c < N; ++c) {
+        endpoints[0][c] = std::clamp(mean[c] + axis[c] * minimum, 0.0f, 255.0f);
+        endpoints[1][c] = std::clamp(mean[c] + axis[c] * maximum, 0.0f, 255.0f);
+    }
+}
+
+// nearest palette entry per texel over the first N channels, returns the summed squared error
+template <int N>
+static float SelectIndices(const Block& block, const float (*palette)[4], int paletteSize,
+                           uint8_t indices[16]) {
+    float totalError = 0.0f;
+    for (int i = 0; i < 16; ++i) {
+        float bestError = INFINITY;
+        for (int p = 0; p < paletteSize; ++p) {
+            float error = 0.0f;
+            for (int c = 0; c < N; ++c) {
+                float difference = block.texels[i][c] - palette[p][c];
+                error += difference * difference;
+            }
+            if (error < bestError) {
+                bestError  = error;
+                indices[i] = (uint8_t)p;
+            }
+        }
+        totalError += bestError;
+    }
+    return totalError;
+}
+
+// Least squares endpoints for fixed indices, weights[index] is the share of the second endpoint.
+// Returns false when all texels use the same weight and the system is singular.
+template <int N>
+static bool RefineEndpoints(const Block& block, const uint8_t indices[16], const float* weights,
+                            float endpoints[2][4]) {
+    float a00 = 0.0f, a01 = 0.0f, a11 = 0.0f;
+    float b0[N] = {}, b1[N] = {};
+    for (int i = 0; i < 16; ++i) {
+        float w = weights[indices[i]], v = 1.0f - w;
+        a00 += v * v, a01 += v * w, a11 += w * w;
+        for (int c = 0; c < N; ++c) {
+            b0[c] += v * block.texels[i][c];
+            b1[c] += w * block.texels[i][c];
+        }
+    }
+    float determinant = a00 * a11 - a01 * a01;
+    if (std::fabs(determinant) < FitEpsilon) return false;
+    for (int c = 0; c < N; ++c) {
+        endpoints[0][c] = std::clamp((a11 * b0[c] - a01 * b1[c]) / determinant, 0.0f, 255.0f);
+        endpoints[1][c] = std::clamp((a00 * b1[c] - a01 * b0[c]) / determinant, 0.0f, 255.0f);
+    }
+    return true;
+}
+
+static uint16_t QuantizeRgb565(const float color[4]) {
+    auto quantize = [](float value, int maximum) {
+        return (uint16_t)std::clamp((int)std::lround(value * maximum / 255.0f), 0, maximum);
+    };
+    return (uint16_t)(quantize(color[0], 31) << 11 | quantize(color[1], 63) << 5 |
+                      quantize(color[2], 31));
+}
+
+static void ExpandRgb565(uint16_t packed, float color[4]) {
+    uint32_t r = packed >> 11, g = packed >> 5 & 63, b = packed & 31;
+    color[0]   = (float)(r << 3 | r >> 2);
+    color[1]   = (float)(g << 2 | g >> 4);
+    color[2]   = (float)(b << 3 | b >> 2);
+    color[3]   = 255.0f;
+}
+
+// BC1 color block, always in four color mode so it also serves as the color half of BC3
+static void EncodeColorBlock(const Block& block, uint8_t output[8]) {
+    // share of the second color for the indices 0, 1, 2, 3 of four color mode
+    static constexpr float Weights[4] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+
+    float endpoints[2][4];
+    FitEndpoints<3>(block, endpoints);
+
+    float    bestError       = INFINITY;
+    uint16_t bestColors[2]   = {};
+    uint8_t  bestIndices[16] = {};
+    for (int pass = 0; pass < 2; ++pass) {
+        uint16_t colors[2] = {QuantizeRgb565(endpoints[0]), QuantizeRgb565(endpoints[1])};
+        if (colors[0] < colors[1]) std::swap(colors[0], colors[1]);
+
+        float palette[4][4];
+        ExpandRgb565(colors[0], palette[0]);
+        ExpandRgb565(colors[1], palette[1]);
+        for (int c = 0; c < 3; ++c) {
+            palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+            palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+        }
+
+        uint8_t indices[16];
+        // equal colors would switch the block to three color mode, index 0 is right either way
+        int   paletteSize = colors[0] == colors[1] ? 1 : 4;
+        float error       = SelectIndices<3>(block, palette, paletteSize, indices);
+        if (error < bestError) {
+            bestError = error;
+            std::copy_n(colors, 2, bestColors);
+            std::copy_n(indices, 16, bestIndices);
+        }
+        if (paletteSize == 1 || !RefineEndpoints<3>(block, indices, Weights, endpoints)) break;
+    }
+
+    std::memcpy(output, bestColors, 4);
+    uint32_t bits = 0;
+    for (int i = 0; i < 16; ++i) bits |= (uint32_t)bestIndices[i] << (i * 2);
+    std::memcpy(output + 4, &bits, 4);
+}
+
+// BC4 block of one channel in eight value mode, also the alpha half of BC3 and both halves of BC5
+static void EncodeChannelBlock(const Block& block, int channel, uint8_t output[8]) {
+    float minimum = 255.0f, maximum = 0.0f;
+    for (const auto& texel : block.texels) {
+        minimum = std::min(minimum, texel[channel]);
+        maximum = std::max(maximum, texel[channel]);
+    }
+    uint8_t values[2] = {(uint8_t)maximum, (uint8_t)minimum};
+
+    // index 0 and 1 are the endpoints, 2 to 7 interpolate from the first towards the second
+    float palette[8][4];
+    palette[0][0] = values[0];
+    palette[1][0] = values[1];
+    for (int i = 2; i < 8; ++i) palette[i][0] = ((8 - i) * values[0] + (i - 1) * values[1]) / 7.0f;
+
+    Block single;
+    for (int i = 0; i < 16; ++i) single.texels[i][0] = block.texels[i][channel];
+    uint8_t indices[16];
+    SelectIndices<1>(single, palette, values[0] == values[1] ? 1 : 8, indices);
+
+    output[0]     = values[0];
+    output[1]     = values[1];
+    uint64_t bits = 0;
+    for (int i = 0; i < 16; ++i) bits |= (uint64_t)indices[i] << (i * 3);
+    for (int i = 0; i < 6; ++i) output[2 + i] = (uint8_t)(bits >> (i * 8));
+}
+
+// round to 7 bits per channel plus the shared lowest bit that fits the endpoint best
+static void QuantizeBc7Endpoint(const float endpoint[4], uint8_t quantized[4], uint8_t& pBit) {
+    float bestError = INFINITY;
+    for (uint8_t p = 0; p < 2; ++p) {
+        uint8_t candidate[4];
+        float   error = 0.0f;
+        for (int c = 0; c < 4; ++c) {
+            int rounded      = (int)std::lround((endpoint[c] - p) / 2.0f);
+            candidate[c]     = (uint8_t)std::clamp(rounded, 0, 127);
+            float difference = (candidate[c] << 1 | p) - endpoint[c];
+            error += difference * difference;
+        }
+        if (error < bestError) {
+            bestError = error;
+            pBit      = p;
+            std::copy_n(candidate, 4, quantized);
+        }
+    }
+}
+
+static void EncodeBc7Block(const Block& block, uint8_t output[16]) {
+    float weights[16];
+    for (int i = 0; i < 16; ++i) weights[i] = Bc7Weights[i] / 64.0f;
+
+    float endpoints[2][4];
+    FitEndpoints<4>(block, endpoints);
+
+    float   bestError = INFINITY;
+    uint8_t bestEndpoints[2][4], bestPBits[2], bestIndices[16];
+    for (int pass = 0; pass < 2; ++pass) {
+        uint8_t quantized[2][4], pBits[2];
+        float   palette[16][4];
+        QuantizeBc7Endpoint(endpoints[0], quantized[0], pBits[0]);
+        QuantizeBc7Endpoint(endpoints[1], quantized[1], pBits[1]);
+        for (int i = 0; i < 16; ++i) {
+            for (int c = 0; c < 4; ++c) {
+                int e0 = quantized[0][c] << 1 | pBits[0], e1 = quantized[1][c] << 1 | pBits[1];
+                int w  = Bc7Weights[i];
+                palette[i][c] = (float)(((64 - w) * e0 + w * e1 + 32) >> 6);
+            }
+        }
+
+        uint8_t indices[16];
+        float   error = SelectIndices<4>(block, palette, 16, indices);
+        if (error < bestError) {
+            bestError = error;
+            std::memcpy(bestEndpoints, quantized, sizeof(quantized));
+            std::copy_n(pBits, 2, bestPBits);
+            std::copy_n(indices, 16, bestIndices);
+        }
+        if (!RefineEndpoints<4>(block, indices, weights, endpoints)) break;
+    }
+
+    // the anchor texel stores only 3 index bits, so its index must be below 8
+    if (bestIndices[0] >= 8) {
+        std::swap(bestEndpoints[0], bestEndpoints[1]);
+        std::swap(bestPBits[0], bestPBits[1]);
+        for (auto& index : bestIndices) index = (uint8_t)(15 - index);
+    }
+
+    std::memset(output, 0, 16);
+    BitWriter writer{output};
+    writer.Write(1 << 6, 7);
+    for (int c = 0; c < 4; ++c) {
+        writer.Write(bestEndpoints[0][c], 7);
+        writer.Write(bestEndpoints[1][c], 7);
+    }
+    writer.Write(bestPBits[0], 1);
+    writer.Write(bestPBits[1], 1);
+    writer.Write(bestIndices[0], 3);
+    for (int i = 1; i < 16; ++i) writer.Write(bestIndices[i], 4);
+}
+
+static void EncodeBlock(const Block& block, Format format, uint8_t* output) {
+    switch (format) {
+    case Format::BC1_RGB_UNORM_BLOCK:
+    case Format::BC1_RGB_SRGB_BLOCK:
+    case Format::BC1_RGBA_UNORM_BLOCK:
+    case Format::BC1_RGBA_SRGB_BLOCK:
+        EncodeColorBlock(block, output);
+        break;
+    case Format::BC3_UNORM_BLOCK:
+    case Format::BC3_SRGB_BLOCK:
+        EncodeChannelBlock(block, 3, output);
+        EncodeColorBlock(block, output + 8);
+        break;
+    case Format::BC4_UNORM_BLOCK:
+        EncodeChannelBlock(block, 0, output);
+        break;
+    case Format::BC5_UNORM_BLOCK:
+        EncodeChannelBlock(block, 0, output);
+        EncodeChannelBlock(block, 1, output + 8);
+        break;
+    case Format::BC7_UNORM_BLOCK:
+    case Format::BC7_SRGB_BLOCK:
+        EncodeBc7Block(block, output);
+        break;
+    default:
+        assert(false);
+    }
+}
+
+static std::vector<uint8_t> EncodeLevel(const uint8_t* level, uint32_t width, uint32_t height,
+                                        Format format) {
+    const uint32_t       blockByteSize = FormatToBlockByteSize(format);
+    const uint32_t       blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    std::vector<uint8_t> result((size_t)blocksX * blocksY * blockByteSize);
+    for (uint32_t blockY = 0; blockY < blocksY; ++blockY) {
+        for (uint32_t blockX = 0; blockX < blocksX; ++blockX) {
+            uint8_t* output = result.data() + ((size_t)blockY * blocksX + blockX) * blockByteSize;
+            EncodeBlock(LoadBlock(level, width, height, blockX, blockY), format, output);
+        }
+    }
+    return result;
+}
+
+bool BlockEncoder::CanEncode(Format format) {
+    switch (format) {
+    case Format::BC1_RGB_UNORM_BLOCK:
+    case Format::BC1_RGB_SRGB_BLOCK:
+    case Format::BC1_RGBA_UNORM_BLOCK:
+    case Format::BC1_RGBA_SRGB_BLOCK:
+    case Format::BC3_UNORM_BLOCK:
+    case Format::BC3_SRGB_BLOCK:
+    case Format::BC4_UNORM_BLOCK:
+    case Format::BC5_UNORM_BLOCK:
+    case Format::BC7_UNORM_BLOCK:
+    case Format::BC7_SRGB_BLOCK:
+        return true;
+    default:
+        return false;
+    }
+}
+
+ImageData BlockEncoder::Encode(const ImageData& image, Format format) {
+    assert(CanEncode(format));
+    assert(FormatToChannelNum(image.ImageFormat) == 4 &&
+           FormatToBlockByteSize(image.ImageFormat) == 0);
+
+    ImageData result;
+    result.ImageFormat = format;
+    result.Width       = image.Width;
+    result.Height      = image.Height;
+    result.channels    = image.channels;
+    result.ByteData    = EncodeLevel(image.ByteData.data(), image.Width, image.Height, format);
+
+    uint32_t width = image.Width, height = image.Height;
+    for (const auto& mip : image.MipLevels) {
+        width  = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
+        result.MipLevels.push_back(EncodeLevel(mip.data(), width, height, format));
+    }
+    return result;
+}
+} // namespace wind
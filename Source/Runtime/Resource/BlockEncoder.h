@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Runtime/Resource/ImageData.h"
+
+namespace wind {
+// CPU encoder for the BCn formats material textures are cooked into. Color endpoints are fitted
+// along the principal axis of each 4x4 block and refined by one least squares pass over the chosen
+// indices. BC7 only uses mode 6 (one subset, rgba endpoints, 4 bit indices), which already beats
+// BC1 / BC3 on gradients and alpha at the same cost per block.
+class BlockEncoder {
+public:
+    // BC1, BC3, BC4, BC5 and BC7, unorm and srgb where the format has both
+    [[nodiscard]] static bool CanEncode(Format format);
+
+    // Compress every level of an 8 bit rgba image into format. BC4 stores red, BC5 red and green.
+    // Single threaded so that cooking can run one image per worker.
+    static ImageData Encode(const ImageData& image, Format format);
+};
+} // namespace wind
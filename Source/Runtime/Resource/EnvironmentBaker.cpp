@@ -0,0 +1,539 @@
+#include "EnvironmentBaker.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <numbers>
+#include <span>
+#include <vector>
+
+#include "Runtime/Base/Io.h"
+#include "Runtime/Base/Macro.h"
+#include "Runtime/Base/Parallel.h"
+#include "Runtime/Base/Utils.h"
+#include "Runtime/Resource/ImageLoader.h"
+
+#include <glm/glm.hpp>
+#include <stb_image.h>
+
+namespace wind {
+static constexpr uint32_t EnvironmentCacheMagic = 0x564E4557; // "WENV"
+static constexpr float    Pi                    = std::numbers::pi_v<float>;
+
+struct EnvironmentCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t specularSize;
+    uint32_t irradianceSize;
+    uint64_t sourceSize;
+    uint64_t sourceHash;
+};
+
+// rgb float texels of the six faces in Vulkan layer order (+x, -x, +y, -y, +z, -z), row by row
+struct FloatCube {
+    uint32_t           size = 0;
+    std::vector<float> texels;
+
+    explicit FloatCube(uint32_t size) : size(size), texels((size_t)6 * size * size * 3) {}
+
+    float* GetTexel(uint32_t face, uint32_t x, uint32_t y) {
+        return texels.data() + (((size_t)face * size + y) * size + x) * 3;
+    }
+    const float* GetTexel(uint32_t face, uint32_t x, uint32_t y) const {
+        return texels.data() + (((size_t)face * size + y) * size + x) * 3;
+    }
+};
+
+// the shared exponent packing of the Vulkan spec, negative and nan channels become 0
+static uint32_t PackE5B9G9R9(const float* rgb) {
+    static constexpr int   MantissaBits = 9;
+    static constexpr int   ExponentBias = 15;
+    static constexpr float MaxValue     = 511.0f / 512.0f * 65536.0f;
+
+    auto sanitize = [](float value) {
+        return value == value ? std::clamp(value, 0.0f, MaxValue) : 0.0f;
+    };
+    float r = sanitize(rgb[0]);
+    float g = sanitize(rgb[1]);
+    float b = sanitize(rgb[2]);
+
+    float maxChannel = std::max({r, g, b});
+    if (maxChannel < 1.0f / 65536.0f / 512.0f) return 0;
+
+    int   exponent = std::max(-ExponentBias - 1, (int)std::floor(std::log2(maxChannel))) + 1;
+    float scale    = std::exp2((float)(exponent - MantissaBits));
+    if ((int)std::floor(maxChannel / scale + 0.5f) == 1 << MantissaBits) {
+        scale *= 2.0f;
+        exponent += 1;
+    }
+
+    auto quantize = [scale](float value) { return (uint32_t)std::floor(value / scale + 0.5f); };
+    return quantize(r) | quantize(g) << 9 | quantize(b) << 18 |
+           (uint32_t)(exponent + ExponentBias) << 27;
+}
+
+// u and v in [-1, 1], v pointing down the face
+static glm::vec3 GetFaceDirection(uint32_t face, float u, float v) {
+    switch (face) {
+    case 0:
+        return glm::normalize(glm::vec3(1.0f, -v, -u));
+    case 1:
+        return glm::normalize(glm::vec3(-1.0f, -v, u));
+    case 2:
+        return glm::normalize(glm::vec3(u, 1.0f, v));
+    case 3:
+        return glm::normalize(glm::vec3(u, -1.0f, -v));
+    case 4:
+        return glm::normalize(glm::vec3(u, -v, 1.0f));
+    default:
+        return glm::normalize(glm::vec3(-u, -v, -1.0f));
+    }
+}
+
+static uint32_t GetFaceCoordinates(const glm::vec3& direction, float& u, float& v) {
+    glm::vec3 a = glm::abs(direction);
+    if (a.x >= a.y && a.x >= a.z) {
+        u = (direction.x > 0.0f ? -direction.z : direction.z) / a.x;
+        v = -direction.y / a.x;
+        return direction.x > 0.0f ? 0 : 1;
+    }
+    if (a.y >= a.z) {
+        u = direction.x / a.y;
+        v = (direction.y > 0.0f ? direction.z : -direction.z) / a.y;
+        return direction.y > 0.0f ? 2 : 3;
+    }
+    u = (direction.z > 0.0f ? direction.x : -direction.x) / a.z;
+    v = -direction.y / a.z;
+    return direction.z > 0.0f ? 4 : 5;
+}
+
+static float GetTexelCenter(uint32_t index, uint32_t size) {
+    return 2.0f * ((float)index + 0.5f) / (float)size - 1.0f;
+}
+
+// bilinear inside one face, clamped at its edges
+static void SampleFace(const FloatCube& cube, uint32_t face, float u, float v, float weight,
+                       float* rgb) {
+    const float maxCoord = (float)cube.size - 1.0f;
+    float       fx       = std::clamp((u * 0.5f + 0.5f) * cube.size - 0.5f, 0.0f, maxCoord);
+    float       fy       = std::clamp((v * 0.5f + 0.5f) * cube.size - 0.5f, 0.0f, maxCoord);
+    uint32_t    x0 = (uint32_t)fx, y0 = (uint32_t)fy;
+    uint32_t    x1 = std::min(x0 + 1, cube.size - 1), y1 = std::min(y0 + 1, cube.size - 1);
+    float       tx = fx - x0, ty = fy - y0;
+
+    const float* t00 = cube.GetTexel(face, x0, y0);
+    const float* t10 = cube.GetTexel(face, x1, y0);
+    const float* t01 = cube.GetTexel(face, x0, y1);
+    const float* t11 = cube.GetTexel(face, x1, y1);
+    for (int c = 0; c < 3; ++c) {
+        float top    = t00[c] + (t10[c] - t00[c]) * tx;
+        float bottom = t01[c] + (t11[c] - t01[c]) * tx;
+        rgb[c] += weight * (top + (bottom - top) * ty);
+    }
+}
+
+// trilinear lookup into a box filtered chain, adds weight * texel to rgb
+static void SampleChain(const std::vector<FloatCube>& chain, const glm::vec3& direction, float lod,
+                        float weight, float* rgb) {
+    float    u, v;
+    uint32_t face = GetFaceCoordinates(direction, u, v);
+
+    lod              = std::clamp(lod, 0.0f, (float)(chain.size() - 1));
+    uint32_t level   = (uint32_t)lod;
+    float    between = lod - level;
+    SampleFace(chain[level], face, u, v, weight * (1.0f - between), rgb);
+    if (between > 0.0f) SampleFace(chain[level + 1], face, u, v, weight * between, rgb);
+}
+
+static void SampleEquirect(const float* texels, uint32_t width, uint32_t height,
+                           const glm::vec3& direction, float weight, float* rgb) {
+    float u  = 0.5f + std::atan2(direction.z, direction.x) / (2.0f * Pi);
+    float v  = std::acos(std::clamp(direction.y, -1.0f, 1.0f)) / Pi;
+    float fx = u * width - 0.5f;
+    float fy = std::clamp(v * height - 0.5f, 0.0f, (float)height - 1.0f);
+
+    float    floorX = std::floor(fx);
+    float    tx = fx - floorX, ty = fy - (uint32_t)fy;
+    // wraps around the seam at u = 0
+    uint32_t x0 = (uint32_t)(((int64_t)floorX % width + width) % width);
+    uint32_t x1 = (x0 + 1) % width;
+    uint32_t y0 = (uint32_t)fy, y1 = std::min(y0 + 1, height - 1);
+
+    const float* t00 = texels + ((size_t)y0 * width + x0) * 3;
+    const float* t10 = texels + ((size_t)y0 * width + x1) * 3;
+    const float* t01 = texels + ((size_t)y1 * width + x0) * 3;
+    const float* t11 = texels + ((size_t)y1 * width + x1) * 3;
+    for (int c = 0; c < 3; ++c) {
+        float top    = t00[c] + (t10[c] - t00[c]) * tx;
+        float bottom = t01[c] + (t11[c] - t01[c]) * tx;
+        rgb[c] += weight * (top + (bottom - top) * ty);
+    }
+}
+
+// run func(face, y) for every row of every face across the worker threads
+template <typename Func> static void ForEachRow(uint32_t size, Func&& func) {
+    utils::ParallelFor((size_t)6 * size,
+                       [&](size_t row) { func((uint32_t)(row / size), (uint32_t)(row % size)); });
+}
+
+static FloatCube ResampleEquirect(const float* texels, uint32_t width, uint32_t height,
+                                  uint32_t size) {
+    // a face spans a quarter of the map, supersample when the map is denser than the face
+    const uint32_t subSamples = std::clamp(width / 4 / size, 1u, 4u);
+    const float    weight     = 1.0f / (subSamples * subSamples);
+
+    FloatCube cube(size);
+    ForEachRow(size, [&](uint32_t face, uint32_t y) {
+        for (uint32_t x = 0; x < size; ++x) {
+            float* rgb = cube.GetTexel(face, x, y);
+            for (uint32_t sy = 0; sy < subSamples; ++sy) {
+                for (uint32_t sx = 0; sx < subSamples; ++sx) {
+                    float u = 2.0f * (x + (sx + 0.5f) / subSamples) / size - 1.0f;
+                    float v = 2.0f * (y + (sy + 0.5f) / subSamples) / size - 1.0f;
+                    SampleEquirect(texels, width, height, GetFaceDirection(face, u, v), weight,
+                                   rgb);
+                }
+            }
+        }
+    });
+    return cube;
+}
+
+// 2x2 box filter, odd sizes drop the last row and column like the Vulkan level sizes do
+static FloatCube Downsample(const FloatCube& source) {
+    FloatCube cube(std::max(source.size / 2, 1u));
+    ForEachRow(cube.size, [&](uint32_t face, uint32_t y) {
+        const uint32_t last = source.size - 1;
+        const uint32_t sy0 = std::min(y * 2, last), sy1 = std::min(y * 2 + 1, last);
+        for (uint32_t x = 0; x < cube.size; ++x) {
+            uint32_t sx0 = std::min(x * 2, last), sx1 = std::min(x * 2 + 1, last);
+            float*   rgb = cube.GetTexel(face, x, y);
+            for (int c = 0; c < 3; ++c) {
+                rgb[c] = 0.25f * (source.GetTexel(face, sx0, sy0)[c] +
+                                  source.GetTexel(face, sx1, sy0)[c] +
+                                  source.GetTexel(face, sx0, sy1)[c] +
+                                  source.GetTexel(face, sx1, sy1)[c]);
+            }
+        }
+    });
+    return cube;
+}
+
+static std::vector<FloatCube> BuildChain(FloatCube base) {
+    std::vector<FloatCube> chain;
+    chain.push_back(std::move(base));
+    while (chain.back().size > 1) chain.push_back(Downsample(chain.back()));
+    return chain;
+}
+
+struct GGXSample {
+    glm::vec3 direction; // tangent space, the normal is +z
+    float     weight;    // cos of the angle to the normal
+    float     lod;
+};
+
+static float RadicalInverse(uint32_t bits) {
+    bits = (bits << 16u) | (bits >> 16u);
+    bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+    bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+    bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+    bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+    return (float)bits * 2.3283064365386963e-10f;
+}
+
+// Hammersley points mapped to GGX half vectors, reflected about the normal with view == normal.
+// Each sample reads the source level whose texels cover the solid angle its pdf gives it.
+static std::vector<GGXSample> MakeGGXSamples(float roughness, uint32_t baseSize) {
+    const float alpha       = roughness * roughness;
+    const float alpha2      = alpha * alpha;
+    const float texelSolidA = 4.0f * Pi / (6.0f * baseSize * baseSize);
+
+    std::vector<GGXSample> samples;
+    samples.reserve(EnvironmentBaker::SampleCount);
+    for (uint32_t i = 0; i < EnvironmentBaker::SampleCount; ++i) {
+        float e1       = (float)i / EnvironmentBaker::SampleCount;
+        float e2       = RadicalInverse(i);
+        float phi      = 2.0f * Pi * e1;
+        float cosTheta = std::sqrt((1.0f - e2) / (1.0f + (alpha2 - 1.0f) * e2));
+        float sinTheta = std::sqrt(1.0f - cosTheta * cosTheta);
+
+        glm::vec3 half(sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta);
+        glm::vec3 light = 2.0f * cosTheta * half - glm::vec3(0.0f, 0.0f, 1.0f);
+        if (light.z <= 0.0f) continue;
+
+        float d = (cosTheta * cosTheta) * (alpha2 - 1.0f) + 1.0f;
+        // pdf of the reflected direction is D * NdotH / (4 * VdotH), with N == V that is D / 4
+        float pdf          = alpha2 / (Pi * d * d) / 4.0f;
+        float sampleSolidA = 1.0f / (EnvironmentBaker::SampleCount * pdf + 1e-6f);
+        float lod = roughness == 0.0f ? 0.0f : 0.5f * std::log2(sampleSolidA / texelSolidA) + 1.0f;
+        samples.push_back({light, light.z, std::max(lod, 0.0f)});
+    }
+    return samples;
+}
+
+static FloatCube Prefilter(const std::vector<FloatCube>& chain, uint32_t level,
+                           uint32_t levelCount) {
+    const float roughness = (float)level / (float)(levelCount - 1);
+    const auto  samples   = MakeGGXSamples(roughness, chain[0].size);
+
+    FloatCube cube(std::max(chain[0].size >> level, 1u));
+    ForEachRow(cube.size, [&](uint32_t face, uint32_t y) {
+        for (uint32_t x = 0; x < cube.size; ++x) {
+            glm::vec3 normal =
+                GetFaceDirection(face, GetTexelCenter(x, cube.size), GetTexelCenter(y, cube.size));
+            glm::vec3 up = std::abs(normal.z) < 0.999f ? glm::vec3(0.0f, 0.0f, 1.0f)
+                                                       : glm::vec3(1.0f, 0.0f, 0.0f);
+            glm::vec3 tangent   = glm::normalize(glm::cross(up, normal));
+            glm::vec3 bitangent = glm::cross(normal, tangent);
+
+            float* rgb         = cube.GetTexel(face, x, y);
+            float  totalWeight = 0.0f;
+            for (const auto& sample : samples) {
+                glm::vec3 direction = tangent * sample.direction.x +
+                                      bitangent * sample.direction.y + normal * sample.direction.z;
+                SampleChain(chain, direction, sample.lod, sample.weight, rgb);
+                totalWeight += sample.weight;
+            }
+            for (int c = 0; c < 3; ++c) rgb[c] /= std::max(totalWeight, 1e-6f);
+        }
+    });
+    return cube;
+}
+
+// sum of radiance * cos * texel solid angle over a level of at most IrradianceSize / 2
+static FloatCube ConvolveIrradiance(const std::vector<FloatCube>& chain) {
+    const FloatCube* source = &chain.back();
+    for (const auto& level : chain) {
+        if (level.size <= EnvironmentBaker::IrradianceSize / 2) {
+            source = &level;
+            break;
+        }
+    }
+
+    struct SourceTexel {
+        glm::vec3    direction;
+        float        solidAngle;
+        const float* rgb;
+    };
+    std::vector<SourceTexel> texels;
+    texels.reserve((size_t)6 * source->size * source->size);
+    const float texelSpan = 2.0f / source->size;
+    for (uint32_t face = 0; face < 6; ++face) {
+        for (uint32_t y = 0; y < source->size; ++y) {
+            for (uint32_t x = 0; x < source->size; ++x) {
+                float u = GetTexelCenter(x, source->size), v = GetTexelCenter(y, source->size);
+                float solidAngle = texelSpan * texelSpan / std::pow(1.0f + u * u + v * v, 1.5f);
+                texels.push_back({GetFaceDirection(face, u, v), solidAngle,
+                                  source->GetTexel(face, x, y)});
+            }
+        }
+    }
+
+    FloatCube cube(EnvironmentBaker::IrradianceSize);
+    ForEachRow(cube.size, [&](uint32_t face, uint32_t y) {
+        for (uint32_t x = 0; x < cube.size; ++x) {
+            glm::vec3 normal =
+                GetFaceDirection(face, GetTexelCenter(x, cube.size), GetTexelCenter(y, cube.size));
+            float* rgb = cube.GetTexel(face, x, y);
+            for (const auto& texel : texels) {
+                float weight = glm::dot(normal, texel.direction);
+                if (weight <= 0.0f) continue;
+                weight *= texel.solidAngle / Pi;
+                for (int c = 0; c < 3; ++c) rgb[c] += weight * texel.rgb[c];
+            }
+        }
+    });
+    return cube;
+}
+
+static std::vector<uint8_t> EncodeFace(const FloatCube& cube, uint32_t face) {
+    std::vector<uint8_t> bytes((size_t)cube.size * cube.size * sizeof(uint32_t));
+    for (uint32_t y = 0; y < cube.size; ++y) {
+        for (uint32_t x = 0; x < cube.size; ++x) {
+            uint32_t packed = PackE5B9G9R9(cube.GetTexel(face, x, y));
+            std::memcpy(bytes.data() + ((size_t)y * cube.size + x) * sizeof(uint32_t), &packed,
+                        sizeof(packed));
+        }
+    }
+    return bytes;
+}
+
+static CubemapData EncodeCubemap(const std::vector<FloatCube>& levels) {
+    CubemapData cubemap;
+    cubemap.FaceFormat = EnvironmentBaker::CubemapFormat;
+    cubemap.FaceWidth  = levels[0].size;
+    cubemap.FaceHeight = levels[0].size;
+    cubemap.MipLevels.resize(levels.size() - 1);
+    utils::ParallelFor(levels.size() * 6, [&](size_t index) {
+        size_t level = index / 6, face = index % 6;
+        auto&  bytes = level == 0 ? cubemap.Faces[face] : cubemap.MipLevels[level - 1][face];
+        bytes        = EncodeFace(levels[level], (uint32_t)face);
+    });
+    return cubemap;
+}
+
+static bool LoadSourceCube(const std::string& filepath, std::span<const uint8_t> source,
+                           std::vector<FloatCube>& chain) {
+    if (EnvironmentBaker::IsEquirectFile(filepath)) {
+        int    width = 0, height = 0, channels = 0;
+        float* texels = stbi_loadf_from_memory(source.data(), (int)source.size(), &width, &height,
+                                               &channels, 3);
+        if (!texels) return false;
+        uint32_t size = std::min(EnvironmentBaker::SpecularSize,
+                                 std::bit_ceil(std::max((uint32_t)width / 4, 1u)));
+        chain = BuildChain(ResampleEquirect(texels, width, height, size));
+        stbi_image_free(texels);
+        return true;
+    }
+
+    auto cross = ImageLoader::LoadCubemapDataFromFile(filepath, Format::R8G8B8A8_UNORM);
+    if (cross.FaceWidth == 0 || cross.FaceWidth != cross.FaceHeight) return false;
+    FloatCube cube(cross.FaceWidth);
+    ForEachRow(cube.size, [&](uint32_t face, uint32_t y) {
+        const uint8_t* bytes = cross.Faces[face].data() + (size_t)y * cube.size * 4;
+        for (uint32_t x = 0; x < cube.size; ++x) {
+            float* rgb = cube.GetTexel(face, x, y);
+            for (int c = 0; c < 3; ++c) rgb[c] = bytes[x * 4 + c] / 255.0f;
+        }
+    });
+    chain = BuildChain(std::move(cube));
+    return true;
+}
+
+static EnvironmentMapData Bake(const std::string& filepath, std::span<const uint8_t> source) {
+    std::vector<FloatCube> chain;
+    if (!LoadSourceCube(filepath, source, chain)) {
+        WIND_CORE_ERROR("Failed to load environment map {}", filepath);
+        return {};
+    }
+
+    const uint32_t         levelCount = (uint32_t)chain.size();
+    std::vector<FloatCube> specular;
+    specular.reserve(levelCount);
+    specular.push_back(chain[0]);
+    for (uint32_t level = 1; level < levelCount; ++level)
+        specular.push_back(Prefilter(chain, level, levelCount));
+
+    EnvironmentMapData data;
+    data.Specular   = EncodeCubemap(specular);
+    data.Irradiance = EncodeCubemap(BuildChain(ConvolveIrradiance(chain)));
+    return data;
+}
+
+static size_t GetCubemapByteSize(uint32_t size) {
+    size_t byteSize = 0;
+    for (uint32_t level = 0; (size >> level) > 0; ++level)
+        byteSize += 6 * GetImageLevelByteSize(EnvironmentBaker::CubemapFormat, size >> level,
+                                              size >> level);
+    return byteSize;
+}
+
+static void WriteCubemap(std::ofstream& file, const CubemapData& cubemap) {
+    for (const auto& face : cubemap.Faces) file.write((const char*)face.data(), face.size());
+    for (const auto& level : cubemap.MipLevels)
+        for (const auto& face : level) file.write((const char*)face.data(), face.size());
+}
+
+static const uint8_t* ReadCubemap(const uint8_t* bytes, uint32_t size, CubemapData& cubemap) {
+    cubemap.FaceFormat = EnvironmentBaker::CubemapFormat;
+    cubemap.FaceWidth  = size;
+    cubemap.FaceHeight = size;
+    for (uint32_t level = 0; (size >> level) > 0; ++level) {
+        auto&  faces    = level == 0 ? cubemap.Faces : cubemap.MipLevels.emplace_back();
+        size_t faceSize = GetImageLevelByteSize(EnvironmentBaker::CubemapFormat, size >> level,
+                                                size >> level);
+        for (auto& face : faces) {
+            face.assign(bytes, bytes + faceSize);
+            bytes += faceSize;
+        }
+    }
+    return bytes;
+}
+
+static bool ReadCache(const std::string& cachePath, const EnvironmentCacheHeader& expected,
+                      EnvironmentMapData& data) {
+    std::error_code ec;
+    if (!std::filesystem::exists(cachePath, ec)) return false;
+    io::MappedFile cache(cachePath);
+    if (!cache.IsValid() || cache.GetSize() < sizeof(EnvironmentCacheHeader)) return false;
+
+    EnvironmentCacheHeader header;
+    std::memcpy(&header, cache.GetData(), sizeof(header));
+    if (header.magic != expected.magic || header.version != expected.version ||
+        header.irradianceSize != expected.irradianceSize ||
+        header.sourceSize != expected.sourceSize || header.sourceHash != expected.sourceHash ||
+        header.specularSize == 0)
+        return false;
+    if (cache.GetSize() != sizeof(header) + GetCubemapByteSize(header.specularSize) +
+                               GetCubemapByteSize(header.irradianceSize))
+        return false;
+
+    const uint8_t* bytes = cache.GetData() + sizeof(header);
+    bytes                = ReadCubemap(bytes, header.specularSize, data.Specular);
+    ReadCubemap(bytes, header.irradianceSize, data.Irradiance);
+    return true;
+}
+
+// write into a temporary file first so a crash never leaves a half written cache behind
+static void WriteCache(const std::string& cachePath, EnvironmentCacheHeader header,
+                       const EnvironmentMapData& data) {
+    const auto tempPath = cachePath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            WIND_CORE_WARN("Can not write environment cache {}, skip caching", cachePath);
+            return;
+        }
+        header.specularSize = data.Specular.FaceWidth;
+        file.write((const char*)&header, sizeof(header));
+        WriteCubemap(file, data.Specular);
+        WriteCubemap(file, data.Irradiance);
+        if (!file.good()) {
+            WIND_CORE_WARN("Failed to write environment cache {}", cachePath);
+            return;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, cachePath, ec);
+    if (ec) {
+        WIND_CORE_WARN("Failed to move environment cache into place {}: {}", cachePath,
+                       ec.message());
+        std::filesystem::remove(tempPath, ec);
+    }
+}
+
+bool EnvironmentBaker::IsEquirectFile(const std::string& filepath) {
+    std::filesystem::path filename{filepath};
+    return filename.extension() == ".hdr";
+}
+
+std::string EnvironmentBaker::GetCachePath(const std::string& sourcePath) {
+    return sourcePath + ".wenv";
+}
+
+EnvironmentMapData EnvironmentBaker::Load(const std::string& filepath) {
+    io::MappedFile source(filepath);
+    if (!source.IsValid()) {
+        WIND_CORE_ERROR("Failed to open environment map {}", filepath);
+        return {};
+    }
+
+    EnvironmentCacheHeader header{EnvironmentCacheMagic, Version, 0, IrradianceSize,
+                                  source.GetSize(), utils::HashBytes(source.GetView())};
+    EnvironmentMapData     data;
+    const auto             cachePath = GetCachePath(filepath);
+    if (ReadCache(cachePath, header, data)) return data;
+
+    data = Bake(filepath, source.GetView());
+    if (data.Specular.FaceWidth == 0) return data;
+    WIND_CORE_INFO("Bake environment map {} into {} specular levels of {}x{}", filepath,
+                   data.Specular.MipLevels.size() + 1, data.Specular.FaceWidth,
+                   data.Specular.FaceHeight);
+    WriteCache(cachePath, header, data);
+    return data;
+}
+} // namespace wind
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "Runtime/Resource/ImageData.h"
+
+namespace wind {
+struct EnvironmentMapData {
+    // mip m is prefiltered with the GGX lobe of roughness m / (levels - 1), mip 0 is the sky itself
+    CubemapData Specular;
+    // cosine convolved radiance divided by pi, diffuse lighting is irradiance * albedo
+    CubemapData Irradiance;
+};
+
+// CPU image based lighting bake. The source is an equirectangular .hdr map or, for LDR images, the
+// 4x3 cross LoadCubemapDataFromFile reads. It is resampled into cube faces, every level of the
+// specular chain is importance sampled from a box filtered copy of the faces at the lod matching
+// the solid angle of each sample, and the irradiance cube is an exact convolution of a small level.
+// Faces and rows are spread over the worker threads and every level is stored as
+// E5B9G9R9_UFLOAT_PACK_32. The result is cached next to the source (.wenv), keyed like MeshCache by
+// a hash of the source bytes plus Version.
+class EnvironmentBaker {
+public:
+    // bump whenever the bake or the layout of the cache changes
+    static constexpr uint32_t Version        = 1;
+    static constexpr Format   CubemapFormat  = Format::E5B9G9R9_UFLOAT_PACK_32;
+    // largest face of a cube resampled from an equirect map, crosses keep their own face size
+    static constexpr uint32_t SpecularSize   = 512;
+    static constexpr uint32_t IrradianceSize = 32;
+    // GGX samples per texel of every prefiltered level
+    static constexpr uint32_t SampleCount    = 64;
+
+    [[nodiscard]] static bool IsEquirectFile(const std::string& filepath);
+    static std::string        GetCachePath(const std::string& sourcePath);
+
+    // read the cached bake or bake the source and write the cache, empty faces when the source can
+    // not be read
+    static EnvironmentMapData Load(const std::string& filepath);
+};
+} // namespace wind
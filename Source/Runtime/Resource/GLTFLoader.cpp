@@ -1,7 +1,23 @@
 #include "GLTFLoader.h"
 #include "Runtime/Resource/GLTFLoader.h"
 
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
+#include <limits>
+
+#include "Runtime/Base/Io.h"
+#include "Runtime/Base/Macro.h"
+#include "Runtime/Base/Parallel.h"
+#include "Runtime/Base/Utils.h"
+#include "Runtime/Resource/BlockEncoder.h"
+#include "Runtime/Resource/ImageLoader.h"
+#include "Runtime/Resource/MeshOptimizer.h"
+#include "Runtime/Resource/MeshSimplifier.h"
+#include "Runtime/Resource/MipGenerator.h"
 
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #define TINYGLTF_IMPLEMENTATION
@@ -26,220 +42,721 @@ std::pair<glm::vec3, glm::vec3> ComputeTangentSpace(const glm::vec3& pos1, const
     return std::make_pair(glm::normalize(tangent), glm::normalize(bitangent));
 }
 
-static auto ComputeTangentsBitangents(std::span<GLTFShape::Index> indices,
-                                      std::span<const glm::vec3>  positions,
-                                      std::span<const glm::vec2>  texCoords) {
-    std::vector<std::pair<glm::vec3, glm::vec3>> tangentsBitangents;
-    tangentsBitangents.resize(positions.size(),
-                              {glm::vec3{0.0f, 0.0f, 0.0f}, glm::vec3{0.0f, 0.0f, 0.0f}});
-
+static void ComputeTangentsBitangents(std::span<const GLTFShape::Index> indices,
+                                      std::span<GLTFVertex>             vertices) {
     assert(indices.size() % 3 == 0);
     for (size_t i = 0; i < indices.size(); i += 3) {
-        const auto& position1 = positions[indices[i + 0]];
-        const auto& position2 = positions[indices[i + 1]];
-        const auto& position3 = positions[indices[i + 2]];
-
-        const auto& texCoord1 = texCoords[indices[i + 0]];
-        const auto& texCoord2 = texCoords[indices[i + 1]];
-        const auto& texCoord3 = texCoords[indices[i + 2]];
+        auto& vertex1 = vertices[indices[i + 0]];
+        auto& vertex2 = vertices[indices[i + 1]];
+        auto& vertex3 = vertices[indices[i + 2]];
 
         auto tangentBitangent =
-            ComputeTangentSpace(position1, position2, position3, texCoord1, texCoord2, texCoord3);
-
-        tangentsBitangents[indices[i + 0]].first += tangentBitangent.first;
-        tangentsBitangents[indices[i + 0]].second += tangentBitangent.second;
-
-        tangentsBitangents[indices[i + 1]].first += tangentBitangent.first;
-        tangentsBitangents[indices[i + 1]].second += tangentBitangent.second;
-
-        tangentsBitangents[indices[i + 2]].first += tangentBitangent.first;
-        tangentsBitangents[indices[i + 2]].second += tangentBitangent.second;
-    }
-
-    for (auto& [tangent, bitangent] : tangentsBitangents) {
-        if (tangent != glm::vec3{0.0f, 0.0f, 0.0f}) tangent = glm::normalize(tangent);
-        if (bitangent != glm::vec3{0.0f, 0.0f, 0.0f}) bitangent = glm::normalize(bitangent);
-    }
-    return tangentsBitangents;
-}
-static Format ImageFormatFromGLTFImage(const tinygltf::Image& image) {
-    if (image.component == 1) {
-        if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_BYTE) return Format::R8_SNORM;
-        if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE) return Format::R8_UNORM;
-        if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_SHORT) return Format::R16_SINT;
-        if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT) return Format::R16_UINT;
-        if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_INT) return Format::R32_SINT;
-        if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT) return Format::R32_UINT;
-        if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_FLOAT) return Format::R32_SFLOAT;
-    }
-    if (image.component == 2) {
-        if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_BYTE) return Format::R8G8_SNORM;
-        if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE) return Format::R8G8_UNORM;
-        if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_SHORT) return Format::R16G16_SINT;
-        if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT) return Format::R16G16_UINT;
-        if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_INT) return Format::R32G32_SINT;
-        if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT) return Format::R32G32_UINT;
-        if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_FLOAT) return Format::R32G32_SFLOAT;
-    }
-    if (image.component == 3) {
-        if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_BYTE) return Format::R8G8B8_SNORM;
-        if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE) return Format::R8G8B8_UNORM;
-        if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_SHORT) return Format::R16G16B16_SINT;
-        if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
-            return Format::R16G16B16_UINT;
-        if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_INT) return Format::R32G32B32_SINT;
-        if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT) return Format::R32G32B32_UINT;
-        if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_FLOAT) return Format::R32G32B32_SFLOAT;
-    }
-    if (image.component == 4) {
-        if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_BYTE) return Format::R8G8B8A8_SNORM;
-        if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE)
-            return Format::R8G8B8A8_UNORM;
-        if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_SHORT) return Format::R16G16B16A16_SINT;
-        if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
-            return Format::R16G16B16A16_UINT;
-        if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_INT) return Format::R32G32B32A32_SINT;
-        if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT)
-            return Format::R32G32B32A32_UINT;
-        if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_FLOAT) return Format::R32G32B32A32_SFLOAT;
-    }
-    return Format::UNDEFINED;
-}
-
-static ImageData CreateStubTexture(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
-    return ImageData{std::vector{r, g, b, a}, Format::R8G8B8A8_UNORM, 1, 1};
+            ComputeTangentSpace(vertex1.position, vertex2.position, vertex3.position,
+                                vertex1.texcoord, vertex2.texcoord, vertex3.texcoord);
+
+        vertex1.tangent += tangentBitangent.first;
+        vertex1.bitangent += tangentBitangent.second;
+
+        vertex2.tangent += tangentBitangent.first;
+        vertex2.bitangent += tangentBitangent.second;
+
+        vertex3.tangent += tangentBitangent.first;
+        vertex3.bitangent += tangentBitangent.second;
+    }
+
+    for (auto& vertex : vertices) {
+        if (vertex.tangent != glm::vec3{0.0f, 0.0f, 0.0f})
+            vertex.tangent = glm::normalize(vertex.tangent);
+        if (vertex.bitangent != glm::vec3{0.0f, 0.0f, 0.0f})
+            vertex.bitangent = glm::normalize(vertex.bitangent);
+    }
+}
+
+// Strided view over accessor data, works on tinygltf buffers and on the mapped glb BIN chunk alike
+struct AccessorView {
+    const uint8_t* data           = nullptr;
+    size_t         count          = 0;
+    size_t         stride         = 0;
+    int            componentType  = 0;
+    int            componentCount = 0;
+    bool           normalized     = false;
+
+    [[nodiscard]] bool IsValid() const { return data != nullptr; }
+
+    template <typename T> [[nodiscard]] T Read(size_t index) const {
+        T value;
+        std::memcpy(&value, data + index * stride, sizeof(T));
+        return value;
+    }
+
+    // Element as floats, normalized integers map to [0, 1] or [-1, 1] as the spec defines, plain
+    // integers (KHR_mesh_quantization) keep their value. Only call it for a convertible type.
+    template <glm::length_t N> [[nodiscard]] glm::vec<N, float> ReadFloats(size_t index) const {
+        glm::vec<N, float> value;
+        const uint8_t*     element = data + index * stride;
+        for (glm::length_t i = 0; i < N; ++i) {
+            switch (componentType) {
+            case TINYGLTF_COMPONENT_TYPE_FLOAT:
+                value[i] = Component<float>(element, i);
+                break;
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+                value[i] = Component<uint8_t>(element, i) / (normalized ? 255.0f : 1.0f);
+                break;
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+                value[i] = Component<uint16_t>(element, i) / (normalized ? 65535.0f : 1.0f);
+                break;
+            case TINYGLTF_COMPONENT_TYPE_BYTE:
+                value[i] = Component<int8_t>(element, i);
+                if (normalized) value[i] = std::max(value[i] / 127.0f, -1.0f);
+                break;
+            default: // TINYGLTF_COMPONENT_TYPE_SHORT
+                value[i] = Component<int16_t>(element, i);
+                if (normalized) value[i] = std::max(value[i] / 32767.0f, -1.0f);
+                break;
+            }
+        }
+        return value;
+    }
+
+    // float, or an 8/16 bit integer ReadFloats converts
+    [[nodiscard]] bool HasFloatComponents() const {
+        switch (componentType) {
+        case TINYGLTF_COMPONENT_TYPE_FLOAT:
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+        case TINYGLTF_COMPONENT_TYPE_BYTE:
+        case TINYGLTF_COMPONENT_TYPE_SHORT:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+private:
+    template <typename T> static T Component(const uint8_t* element, glm::length_t component) {
+        T value;
+        std::memcpy(&value, element + component * sizeof(T), sizeof(T));
+        return value;
+    }
+};
+
+static void ReadIndices(const AccessorView& view, std::vector<GLTFShape::Index>& indices) {
+    indices.resize(view.count);
+    switch (view.componentType) {
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+        for (size_t i = 0; i < view.count; ++i) indices[i] = view.Read<uint8_t>(i);
+        break;
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+        for (size_t i = 0; i < view.count; ++i) indices[i] = view.Read<uint16_t>(i);
+        break;
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+        for (size_t i = 0; i < view.count; ++i) indices[i] = view.Read<uint32_t>(i);
+        break;
+    default:
+        WIND_CORE_ERROR("Unsupported gltf index component type {}", view.componentType);
+        indices.clear();
+        break;
+    }
+}
+
+// Inputs of one shape, gathered serially so the parallel part never touches the document
+struct PrimitiveSource {
+    AccessorView indices;
+    AccessorView positions;
+    AccessorView texCoords;
+    AccessorView normals;
+    AccessorView tangents;
+    uint32_t     materialIndex = -1;
+};
+
+struct MaterialSource {
+    std::string name;
+    int         albedoImage            = -1;
+    int         normalImage            = -1;
+    int         metallicRoughnessImage = -1;
+    float       roughnessScale         = 1.0f;
+    float       metallicScale          = 1.0f;
+    bool        doubleSided            = false;
+};
+
+// An optional attribute has to cover every vertex with enough float convertible components
+static bool CheckAttribute(const GLTFShape& shape, const AccessorView& view, const char* name,
+                           size_t vertexCount, int componentCount) {
+    if (!view.IsValid()) return true;
+    if (!view.HasFloatComponents() || view.componentCount != componentCount) {
+        WIND_CORE_ERROR("Gltf primitive {} has an unsupported {} format (component type {}, {} "
+                        "components)",
+                        shape.name, name, view.componentType, view.componentCount);
+        return false;
+    }
+    if (view.count != vertexCount) {
+        WIND_CORE_ERROR("Gltf primitive {} has {} {} values for {} positions", shape.name,
+                        view.count, name, vertexCount);
+        return false;
+    }
+    return true;
+}
+
+// Everything ComputeTangentsBitangents and the vertex loops below index with has to be in range,
+// a malformed file fails its primitive instead of reading past the accessors
+static bool ValidatePrimitive(const GLTFShape& shape, const PrimitiveSource& source) {
+    const size_t vertexCount = source.positions.count;
+    if (!CheckAttribute(shape, source.positions, "POSITION", vertexCount, 3) ||
+        !CheckAttribute(shape, source.texCoords, "TEXCOORD_0", vertexCount, 2) ||
+        !CheckAttribute(shape, source.normals, "NORMAL", vertexCount, 3) ||
+        !CheckAttribute(shape, source.tangents, "TANGENT", vertexCount, 4))
+        return false;
+
+    if (shape.indices.size() % 3 != 0) {
+        WIND_CORE_ERROR("Gltf primitive {} has {} indices, not a triangle list", shape.name,
+                        shape.indices.size());
+        return false;
+    }
+    for (auto index : shape.indices) {
+        if (index >= vertexCount) {
+            WIND_CORE_ERROR("Gltf primitive {} references vertex {} of {}", shape.name, index,
+                            vertexCount);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Interleave the attribute streams into the shape, this is the only copy before the staging upload
+static void BuildShape(GLTFShape& shape, const PrimitiveSource& source) {
+    const auto& positions = source.positions;
+    if (!positions.IsValid()) {
+        WIND_CORE_WARN("Skip gltf primitive {} without positions", shape.name);
+        return;
+    }
+
+    if (source.indices.IsValid()) {
+        ReadIndices(source.indices, shape.indices);
+    } else {
+        shape.indices.resize(positions.count);
+        for (size_t i = 0; i < positions.count; ++i) shape.indices[i] = (GLTFShape::Index)i;
+    }
+
+    if (!ValidatePrimitive(shape, source)) {
+        shape.indices.clear();
+        return;
+    }
+
+    const size_t vertexCount = positions.count;
+    const auto&  texCoords   = source.texCoords;
+    const auto&  normals     = source.normals;
+    shape.vertices.resize(vertexCount);
+
+    // authored tangents win, the w component carries the bitangent handedness
+    if (source.tangents.IsValid()) {
+        for (size_t i = 0; i < vertexCount; ++i) {
+            auto&     vertex     = shape.vertices[i];
+            glm::vec4 tangent    = source.tangents.ReadFloats<4>(i);
+            float     handedness = tangent.w < 0.0f ? -1.0f : 1.0f;
+
+            vertex.position  = positions.ReadFloats<3>(i);
+            vertex.texcoord  = texCoords.IsValid() ? texCoords.ReadFloats<2>(i) : glm::vec2{0.0f};
+            vertex.normal    = normals.IsValid() ? normals.ReadFloats<3>(i) : glm::vec3{0.0f};
+            vertex.tangent   = glm::vec3{tangent.x, tangent.y, tangent.z};
+            vertex.bitangent = glm::cross(vertex.normal, vertex.tangent) * handedness;
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < vertexCount; ++i) {
+        auto& vertex     = shape.vertices[i];
+        vertex.position  = positions.ReadFloats<3>(i);
+        vertex.texcoord  = texCoords.IsValid() ? texCoords.ReadFloats<2>(i) : glm::vec2{0.0f};
+        vertex.normal    = normals.IsValid() ? normals.ReadFloats<3>(i) : glm::vec3{0.0f};
+        vertex.tangent   = glm::vec3{0.0f};
+        vertex.bitangent = glm::vec3{0.0f};
+    }
+
+    ComputeTangentsBitangents(shape.indices, shape.vertices);
+}
+
+static AccessorView MakeAccessorView(const tinygltf::Model& model, int accessorIndex) {
+    if (accessorIndex < 0 || accessorIndex >= (int)model.accessors.size()) return {};
+    const auto& accessor = model.accessors[accessorIndex];
+    if (accessor.bufferView < 0 || accessor.bufferView >= (int)model.bufferViews.size()) return {};
+
+    const auto& bufferView = model.bufferViews[accessor.bufferView];
+    if (bufferView.buffer < 0 || bufferView.buffer >= (int)model.buffers.size()) return {};
+    const auto& buffer = model.buffers[bufferView.buffer];
+    int         stride = accessor.ByteStride(bufferView);
+    if (stride <= 0 || accessor.count == 0) return {};
+
+    const int    componentSize  = tinygltf::GetComponentSizeInBytes(accessor.componentType);
+    const int    componentCount = tinygltf::GetNumComponentsInType(accessor.type);
+    const size_t elementSize    = (size_t)std::max(componentSize, 0) * std::max(componentCount, 0);
+    const size_t offset         = bufferView.byteOffset + accessor.byteOffset;
+    if (elementSize == 0) return {};
+    if (offset + (accessor.count - 1) * stride + elementSize > buffer.data.size()) {
+        WIND_CORE_ERROR("Gltf accessor {} is out of buffer range", accessorIndex);
+        return {};
+    }
+    return AccessorView{buffer.data.data() + offset, accessor.count, (size_t)stride,
+                        accessor.componentType, componentCount, accessor.normalized};
+}
+
+static int FindAttribute(const tinygltf::Primitive& primitive, const std::string& name) {
+    auto iter = primitive.attributes.find(name);
+    return iter == primitive.attributes.end() ? -1 : iter->second;
+}
+
+// Append coarser index lists after LOD 0, each simplified from the previous level to about half
+// its size, and split every level into meshlets. Stops early once simplification stalls on locked
+// borders or the mesh is already small, so simple shapes may end up with a single LOD.
+static void BuildLodChain(GLTFShape& shape, std::span<const glm::vec3> positions,
+                          bool doubleSided) {
+    // budget of the whole chain relative to the mesh extent
+    constexpr float  MaxRelativeError = 0.05f;
+    constexpr size_t MinIndexCount    = 64 * 3;
+    constexpr float  MinReduction     = 0.85f;
+
+    glm::vec3 minimum{std::numeric_limits<float>::max()};
+    glm::vec3 maximum{std::numeric_limits<float>::lowest()};
+    for (const auto& position : positions) {
+        minimum = glm::min(minimum, position);
+        maximum = glm::max(maximum, position);
+    }
+    float maxError = positions.empty() ? 0.0f : glm::length(maximum - minimum) * MaxRelativeError;
+
+    auto addLod = [&](uint32_t firstIndex, uint32_t indexCount, float error) {
+        auto lodIndices = std::span<const uint32_t>(shape.indices).subspan(firstIndex, indexCount);
+        auto meshlets   = MeshletBuilder::Build(lodIndices, positions, doubleSided);
+        for (auto& meshlet : meshlets) meshlet.firstIndex += firstIndex;
+        shape.lods.push_back({firstIndex, indexCount, (uint32_t)shape.meshlets.size(),
+                              (uint32_t)meshlets.size(), error});
+        shape.meshlets.insert(shape.meshlets.end(), meshlets.begin(), meshlets.end());
+    };
+
+    shape.lods.clear();
+    shape.meshlets.clear();
+    addLod(0, (uint32_t)shape.indices.size(), 0.0f);
+
+    while (shape.lods.size() < MeshSimplifier::MaxLodCount) {
+        const auto previous = shape.lods.back();
+        if (previous.indexCount < MinIndexCount) break;
+
+        auto  source = std::span<const uint32_t>(shape.indices)
+                          .subspan(previous.firstIndex, previous.indexCount);
+        float error  = 0.0f;
+        auto  lod    = MeshSimplifier::Simplify(source, positions, previous.indexCount / 2 / 3 * 3,
+                                                maxError, error);
+        if (lod.empty() || lod.size() > previous.indexCount * MinReduction) break;
+
+        MeshOptimizer::OptimizeVertexCache(lod, positions.size());
+        uint32_t firstIndex = (uint32_t)shape.indices.size();
+        shape.indices.insert(shape.indices.end(), lod.begin(), lod.end());
+        // every level is simplified from the previous one, so errors only accumulate
+        addLod(firstIndex, (uint32_t)lod.size(), std::max(previous.error, error));
+    }
+}
+
+// external files the mesh cache has to watch, data uris are part of the document itself
+static void AddDependency(std::vector<std::string>& dependencies,
+                          const std::filesystem::path& directory, const std::string& uri) {
+    if (uri.empty() || uri.rfind("data:", 0) == 0) return;
+    auto path = (directory / uri).string();
+    if (std::find(dependencies.begin(), dependencies.end(), path) == dependencies.end())
+        dependencies.push_back(std::move(path));
+}
+
+// Fill materials and build shapes as independent tasks. Every task writes its own pre-sized slot
+// so the result keeps the gltf order no matter how the work is scheduled. Images are only copied,
+// the texture streamer decodes them once the scene is already on screen.
+static GLTFModelData AssembleModel(std::span<const std::span<const uint8_t>> encodedImages,
+                                   std::span<const MaterialSource>           materials,
+                                   std::span<const PrimitiveSource>          primitives) {
+    GLTFModelData result;
+
+    result.images.resize(encodedImages.size());
+    for (size_t i = 0; i < encodedImages.size(); ++i)
+        result.images[i].assign(encodedImages[i].begin(), encodedImages[i].end());
+
+    // missing or unreadable images leave the slot on its placeholder for good
+    auto imageOrNone = [&](int imageIndex) {
+        bool valid = imageIndex >= 0 && imageIndex < (int)encodedImages.size() &&
+                     !encodedImages[imageIndex].empty();
+        return valid ? imageIndex : -1;
+    };
+
+    result.materials.resize(materials.size());
+    for (size_t i = 0; i < materials.size(); ++i) {
+        const auto& material                  = materials[i];
+        auto&       resultMaterial            = result.materials[i];
+        resultMaterial.name                   = material.name;
+        resultMaterial.albedoImage            = imageOrNone(material.albedoImage);
+        resultMaterial.normalImage            = imageOrNone(material.normalImage);
+        resultMaterial.metallicRoughnessImage = imageOrNone(material.metallicRoughnessImage);
+        resultMaterial.roughnessScale         = material.roughnessScale;
+        resultMaterial.metallicScale          = material.metallicScale;
+        resultMaterial.doubleSided            = material.doubleSided;
+    }
+
+    result.shapes.resize(primitives.size());
+    std::vector<MeshOptimizeResult> optimizeResults(primitives.size());
+    utils::ParallelFor(primitives.size(), [&](size_t i) {
+        auto& resultShape         = result.shapes[i];
+        resultShape.name          = "shape_" + std::to_string(i + 1);
+        resultShape.materialIndex = primitives[i].materialIndex;
+        BuildShape(resultShape, primitives[i]);
+        optimizeResults[i] = MeshOptimizer::Optimize(resultShape);
+
+        std::vector<glm::vec3> positions(resultShape.vertices.size());
+        for (size_t v = 0; v < positions.size(); ++v)
+            positions[v] = resultShape.vertices[v].position;
+        uint32_t materialIndex = resultShape.materialIndex;
+        bool     doubleSided =
+            materialIndex < materials.size() && materials[materialIndex].doubleSided;
+        BuildLodChain(resultShape, positions, doubleSided);
+    });
+
+    MeshOptimizeResult total;
+    for (const auto& optimizeResult : optimizeResults) {
+        total.before += optimizeResult.before;
+        total.after += optimizeResult.after;
+    }
+    WIND_CORE_INFO("Optimized {} shapes: vertices {} -> {}, ACMR {:.3f} -> {:.3f}, "
+                   "ATVR {:.3f} -> {:.3f}",
+                   result.shapes.size(), total.before.vertexCount, total.after.vertexCount,
+                   total.before.GetACMR(), total.after.GetACMR(), total.before.GetATVR(),
+                   total.after.GetATVR());
+
+    size_t lodCount = 0;
+    for (const auto& shape : result.shapes) lodCount += shape.lods.size();
+    WIND_CORE_INFO("Generated {} lods for {} shapes", lodCount, result.shapes.size());
+
+    return result;
+}
+
+// tinygltf decodes images one by one while parsing, keep the encoded bytes and decode them later
+static bool DeferImageDecode(tinygltf::Image* image, const int, std::string*, std::string*, int,
+                             int, const unsigned char* bytes, int size, void*) {
+    image->image.assign(bytes, bytes + size);
+    image->width     = 0;
+    image->height    = 0;
+    image->component = 0;
+    return true;
 }
 
 GLTFModelData GLTFLoader::LoadFromGLTF(const std::string& filepath) {
-    GLTFModelData      result;
     tinygltf::TinyGLTF loader;
     tinygltf::Model    model;
     std::string        errorMessage, warningMessage;
 
+    loader.SetImageLoader(DeferImageDecode, nullptr);
     bool res = loader.LoadASCIIFromFile(&model, &errorMessage, &warningMessage, filepath);
     if (!res) std::cout << errorMessage;
 
-    result.materials.reserve(model.materials.size());
+    std::vector<std::span<const uint8_t>> encodedImages;
+    encodedImages.reserve(model.images.size());
+    for (const auto& image : model.images) encodedImages.emplace_back(image.image);
+
+    auto textureSource = [&](int textureIndex) {
+        return textureIndex < 0 ? -1 : model.textures[textureIndex].source;
+    };
 
     // collect material data
+    std::vector<MaterialSource> materials;
+    materials.reserve(model.materials.size());
     for (const auto& material : model.materials) {
-        auto& resultMaterial          = result.materials.emplace_back();
-        resultMaterial.name           = material.name;
-        resultMaterial.roughnessScale = material.pbrMetallicRoughness.roughnessFactor;
-        resultMaterial.metallicScale  = material.pbrMetallicRoughness.metallicFactor;
-        if (material.pbrMetallicRoughness.baseColorTexture.index != -1) {
-            const auto& albedoTexture =
-                model.images[model.textures[material.pbrMetallicRoughness.baseColorTexture.index]
-                                 .source];
-            resultMaterial.albedoTexture = ImageData{
-                albedoTexture.image,
-                ImageFormatFromGLTFImage(albedoTexture),
-                (uint32_t)albedoTexture.width,
-                (uint32_t)albedoTexture.height,
-            };
-        } else {
-            // if don't have a basecolor, craete a white one
-            resultMaterial.albedoTexture = CreateStubTexture(255, 255, 255, 255);
-        }
+        const auto& pbr = material.pbrMetallicRoughness;
+        materials.push_back(MaterialSource{
+            material.name,
+            textureSource(pbr.baseColorTexture.index),
+            textureSource(material.normalTexture.index),
+            textureSource(pbr.metallicRoughnessTexture.index),
+            (float)pbr.roughnessFactor,
+            (float)pbr.metallicFactor,
+            material.doubleSided,
+        });
+    }
 
-        if (material.normalTexture.index != -1) {
-            const auto& normalTexture =
-                model.images[model.textures[material.normalTexture.index].source];
-            resultMaterial.normalTexture = ImageData{
-                normalTexture.image,
-                ImageFormatFromGLTFImage(normalTexture),
-                (uint32_t)normalTexture.width,
-                (uint32_t)normalTexture.height,
-            };
-        } else {
-            resultMaterial.normalTexture = CreateStubTexture(127, 127, 255, 255);
+    // collect mesh data
+    std::vector<PrimitiveSource> primitives;
+    for (const auto& mesh : model.meshes) {
+        for (const auto& primitive : mesh.primitives) {
+            primitives.push_back(PrimitiveSource{
+                MakeAccessorView(model, primitive.indices),
+                MakeAccessorView(model, FindAttribute(primitive, "POSITION")),
+                MakeAccessorView(model, FindAttribute(primitive, "TEXCOORD_0")),
+                MakeAccessorView(model, FindAttribute(primitive, "NORMAL")),
+                MakeAccessorView(model, FindAttribute(primitive, "TANGENT")),
+                (uint32_t)primitive.material,
+            });
         }
+    }
+
+    auto result    = AssembleModel(encodedImages, materials, primitives);
+    auto directory = std::filesystem::path(filepath).parent_path();
+    for (const auto& buffer : model.buffers)
+        AddDependency(result.dependencies, directory, buffer.uri);
+    for (const auto& image : model.images)
+        AddDependency(result.dependencies, directory, image.uri);
+    return result;
+}
+
+// binary gltf container: 12 byte header, a json chunk and an optional BIN chunk
+struct GLBHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t length;
+};
+
+struct GLBChunkHeader {
+    uint32_t length;
+    uint32_t type;
+};
+
+static constexpr uint32_t GLBMagic     = 0x46546C67; // "glTF"
+static constexpr uint32_t GLBChunkJson = 0x4E4F534A; // "JSON"
+static constexpr uint32_t GLBChunkBin  = 0x004E4942; // "BIN\0"
+
+static const nlohmann::json* FindMember(const nlohmann::json& object, const char* key) {
+    auto iter = object.find(key);
+    return iter == object.end() ? nullptr : &*iter;
+}
+
+static int ComponentCountFromTypeName(const std::string& type) {
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2") return 2;
+    if (type == "VEC3") return 3;
+    if (type == "VEC4") return 4;
+    if (type == "MAT2") return 4;
+    if (type == "MAT3") return 9;
+    if (type == "MAT4") return 16;
+    return 0;
+}
+
+static AccessorView MakeAccessorView(const nlohmann::json&                     document,
+                                     std::span<const std::span<const uint8_t>> buffers,
+                                     int                                       accessorIndex) {
+    if (accessorIndex < 0) return {};
+    const auto& accessor = document.at("accessors").at(accessorIndex);
+    // sparse-only accessors are not supported
+    if (!FindMember(accessor, "bufferView")) return {};
+
+    const auto& bufferView    = document.at("bufferViews").at(accessor.at("bufferView").get<int>());
+    const auto  buffer        = buffers.at(bufferView.at("buffer").get<size_t>());
+    const int   componentType = accessor.at("componentType").get<int>();
+    const auto  count         = accessor.at("count").get<size_t>();
+    const int   componentSize = tinygltf::GetComponentSizeInBytes(componentType);
+    const int   componentCount =
+        ComponentCountFromTypeName(accessor.at("type").get<std::string>());
+    const auto elementSize = (size_t)std::max(componentSize, 0) * componentCount;
+    const auto offset =
+        bufferView.value("byteOffset", size_t(0)) + accessor.value("byteOffset", size_t(0));
+
+    size_t stride = bufferView.value("byteStride", size_t(0));
+    if (stride == 0) stride = elementSize;
+    if (count == 0 || elementSize == 0) return {};
+
+    if (offset + (count - 1) * stride + elementSize > buffer.size()) {
+        WIND_CORE_ERROR("Gltf accessor {} is out of buffer range", accessorIndex);
+        return {};
+    }
+    const bool normalized = accessor.value("normalized", false);
+    return AccessorView{buffer.data() + offset, count, stride, componentType, componentCount,
+                        normalized};
+}
 
-        if (material.pbrMetallicRoughness.metallicRoughnessTexture.index != -1) {
-            const auto& metallicRoughnessTexture =
-                model.images
-                    [model.textures[material.pbrMetallicRoughness.metallicRoughnessTexture.index]
-                         .source];
-            resultMaterial.metallicRoughness = ImageData{
-                metallicRoughnessTexture.image,
-                ImageFormatFromGLTFImage(metallicRoughnessTexture),
-                (uint32_t)metallicRoughnessTexture.width,
-                (uint32_t)metallicRoughnessTexture.height,
-            };
-        } else {
-            resultMaterial.metallicRoughness = CreateStubTexture(0, 255, 0, 255);
+GLTFModelData GLTFLoader::LoadFromGLB(const std::string& filepath) {
+    io::MappedFile file(filepath);
+    if (!file.IsValid()) return {};
+
+    const auto fileView = file.GetView();
+    if (fileView.size() < sizeof(GLBHeader) + sizeof(GLBChunkHeader)) {
+        WIND_CORE_ERROR("{} is too small to be a glb file", filepath);
+        return {};
+    }
+
+    GLBHeader header;
+    std::memcpy(&header, fileView.data(), sizeof(header));
+    if (header.magic != GLBMagic || header.version != 2 || header.length > fileView.size()) {
+        WIND_CORE_ERROR("{} is not a valid glb 2.0 file", filepath);
+        return {};
+    }
+
+    // walk the chunks, json must come first and the optional BIN chunk second
+    std::span<const uint8_t> jsonChunk, binChunk;
+    for (size_t offset = sizeof(GLBHeader); offset + sizeof(GLBChunkHeader) <= header.length;) {
+        GLBChunkHeader chunk;
+        std::memcpy(&chunk, fileView.data() + offset, sizeof(chunk));
+        offset += sizeof(GLBChunkHeader);
+        if (offset + chunk.length > header.length) {
+            WIND_CORE_ERROR("{} has a truncated glb chunk", filepath);
+            return {};
         }
+
+        auto chunkData = fileView.subspan(offset, chunk.length);
+        if (chunk.type == GLBChunkJson && jsonChunk.empty()) jsonChunk = chunkData;
+        if (chunk.type == GLBChunkBin && binChunk.empty()) binChunk = chunkData;
+        // chunks are padded to 4 bytes
+        offset += (chunk.length + 3) & ~3u;
     }
 
-    // collect mesh data
-    for (const auto& mesh : model.meshes) {
-        result.shapes.reserve(result.shapes.size() + mesh.primitives.size());
+    auto document = nlohmann::json::parse(jsonChunk.begin(), jsonChunk.end(), nullptr, false);
+    if (document.is_discarded()) {
+        WIND_CORE_ERROR("Failed to parse the json chunk of {}", filepath);
+        return {};
+    }
 
-        for (const auto& primitive : mesh.primitives) {
-            auto& resultShape         = result.shapes.emplace_back();
-            resultShape.name          = "shape_" + std::to_string(result.shapes.size());
-            resultShape.materialIndex = (uint32_t)primitive.material;
-            const auto& indexAccessor = model.accessors[primitive.indices];
-
-            auto&          indexBuffer = model.bufferViews[indexAccessor.bufferView];
-            const uint8_t* indexBegin =
-                model.buffers[indexBuffer.buffer].data.data() + indexBuffer.byteOffset;
-
-            const auto& positionAccessor = model.accessors[primitive.attributes.at("POSITION")];
-            const auto& texCoordAccessor = model.accessors[primitive.attributes.at("TEXCOORD_0")];
-            const auto& normalAccessor   = model.accessors[primitive.attributes.at("NORMAL")];
-
-            const auto& positionBuffer = model.bufferViews[positionAccessor.bufferView];
-            const auto& texCoordBuffer = model.bufferViews[texCoordAccessor.bufferView];
-            const auto& normalBuffer   = model.bufferViews[normalAccessor.bufferView];
-
-            const uint8_t* positionBegin =
-                model.buffers[positionBuffer.buffer].data.data() + positionBuffer.byteOffset;
-            const uint8_t* texCoordBegin =
-                model.buffers[texCoordBuffer.buffer].data.data() + texCoordBuffer.byteOffset;
-            const uint8_t* normalBegin =
-                model.buffers[normalBuffer.buffer].data.data() + normalBuffer.byteOffset;
-
-            std::span<glm::vec3> positions((glm::vec3*)positionBegin,
-                                           (glm::vec3*)(positionBegin + positionBuffer.byteLength));
-            std::span<glm::vec2> texCoords((glm::vec2*)texCoordBegin,
-                                           (glm::vec2*)(texCoordBegin + texCoordBuffer.byteLength));
-            std::span<glm::vec3> normals((glm::vec3*)normalBegin,
-                                         (glm::vec3*)(normalBegin + normalBuffer.byteLength));
-
-            if (indexAccessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT) {
-                std::span<const uint16_t> indices(
-                    (const uint16_t*)indexBegin,
-                    (const uint16_t*)(indexBegin + indexBuffer.byteLength));
-                resultShape.indices.resize(indices.size());
-                for (size_t i = 0; i < resultShape.indices.size(); i++)
-                    resultShape.indices[i] = (GLTFShape::Index)indices[i];
+    const auto directory = std::filesystem::path(filepath).parent_path();
+
+    // external buffers and images are mapped as well, the mappings live until the load ends
+    std::vector<io::MappedFile>           externalFiles;
+    std::vector<std::span<const uint8_t>> buffers;
+    std::vector<std::span<const uint8_t>> encodedImages;
+    std::vector<MaterialSource>           materials;
+    std::vector<PrimitiveSource>          primitives;
+    std::vector<std::string>              dependencies;
+
+    try {
+        auto mapExternal = [&](const std::string& uri) -> std::span<const uint8_t> {
+            if (uri.rfind("data:", 0) == 0) {
+                WIND_CORE_WARN("Embedded data uri is not supported in glb path");
+                return {};
             }
-            if (indexAccessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT) {
-                std::span<const uint32_t> indices(
-                    (const uint32_t*)indexBegin,
-                    (const uint32_t*)(indexBegin + indexBuffer.byteLength));
-                resultShape.indices.resize(indices.size());
-                for (size_t i = 0; i < resultShape.indices.size(); i++)
-                    resultShape.indices[i] = (GLTFShape::Index)indices[i];
+            AddDependency(dependencies, directory, uri);
+            return externalFiles.emplace_back((directory / uri).string()).GetView();
+        };
+
+        if (const auto* bufferArray = FindMember(document, "buffers")) {
+            for (const auto& buffer : *bufferArray) {
+                const auto* uri = FindMember(buffer, "uri");
+                buffers.push_back(uri ? mapExternal(uri->get<std::string>()) : binChunk);
             }
-            auto tangentsBitangents =
-                ComputeTangentsBitangents(resultShape.indices, positions, texCoords);
-
-            resultShape.vertices.resize(positions.size());
-
-            for (size_t i = 0; i < resultShape.vertices.size(); i++) {
-                auto& vertex     = resultShape.vertices[i];
-                vertex.position  = positions[i];
-                vertex.texcoord  = texCoords[i];
-                vertex.normal    = normals[i];
-                vertex.tangent   = tangentsBitangents[i].first;
-                vertex.bitangent = tangentsBitangents[i].second;
+        }
+
+        if (const auto* imageArray = FindMember(document, "images")) {
+            for (const auto& image : *imageArray) {
+                auto& encoded = encodedImages.emplace_back();
+                if (const auto* bufferViewIndex = FindMember(image, "bufferView")) {
+                    const auto& bufferView =
+                        document.at("bufferViews").at(bufferViewIndex->get<size_t>());
+                    auto buffer = buffers.at(bufferView.at("buffer").get<size_t>());
+                    auto offset = bufferView.value("byteOffset", size_t(0));
+                    auto length = bufferView.at("byteLength").get<size_t>();
+                    if (offset + length <= buffer.size()) encoded = buffer.subspan(offset, length);
+                } else if (const auto* uri = FindMember(image, "uri")) {
+                    encoded = mapExternal(uri->get<std::string>());
+                }
             }
         }
+
+        auto textureSource = [&](const nlohmann::json* textureInfo) -> int {
+            if (textureInfo == nullptr || !FindMember(*textureInfo, "index")) return -1;
+            const auto& texture =
+                document.at("textures").at(textureInfo->at("index").get<size_t>());
+            return texture.value("source", -1);
+        };
+
+        // collect material data
+        if (const auto* materialArray = FindMember(document, "materials")) {
+            for (const auto& material : *materialArray) {
+                auto& source       = materials.emplace_back();
+                source.name        = material.value("name", std::string{});
+                source.normalImage = textureSource(FindMember(material, "normalTexture"));
+                source.doubleSided = material.value("doubleSided", false);
+                if (const auto* pbr = FindMember(material, "pbrMetallicRoughness")) {
+                    source.albedoImage = textureSource(FindMember(*pbr, "baseColorTexture"));
+                    source.metallicRoughnessImage =
+                        textureSource(FindMember(*pbr, "metallicRoughnessTexture"));
+                    source.roughnessScale = pbr->value("roughnessFactor", 1.0f);
+                    source.metallicScale  = pbr->value("metallicFactor", 1.0f);
+                }
+            }
+        }
+
+        // collect mesh data straight from the mapped buffers
+        if (const auto* meshArray = FindMember(document, "meshes")) {
+            for (const auto& mesh : *meshArray) {
+                for (const auto& primitive : mesh.at("primitives")) {
+                    int mode = primitive.value("mode", TINYGLTF_MODE_TRIANGLES);
+                    if (mode != TINYGLTF_MODE_TRIANGLES) {
+                        WIND_CORE_WARN("Skip non triangle gltf primitive");
+                        continue;
+                    }
+
+                    const auto& attributes = primitive.at("attributes");
+                    auto        attribute  = [&](const char* name) {
+                        return MakeAccessorView(document, buffers, attributes.value(name, -1));
+                    };
+
+                    primitives.push_back(PrimitiveSource{
+                        MakeAccessorView(document, buffers, primitive.value("indices", -1)),
+                        attribute("POSITION"),
+                        attribute("TEXCOORD_0"),
+                        attribute("NORMAL"),
+                        attribute("TANGENT"),
+                        (uint32_t)primitive.value("material", -1),
+                    });
+                }
+            }
+        }
+    } catch (const nlohmann::json::exception& e) {
+        WIND_CORE_ERROR("Malformed glb document {}: {}", filepath, e.what());
+        return {};
     }
-    
+
+    auto result         = AssembleModel(encodedImages, materials, primitives);
+    result.dependencies = std::move(dependencies);
     return result;
 }
 
+// GLTFLoadBenchmark times this serially and on the thread pool
+GLTFModelData GLTFLoader::LoadFromFile(const std::string& filepath) {
+    auto extension = std::filesystem::path(filepath).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return (char)std::tolower(c); });
+    if (extension == ".glb") return LoadFromGLB(filepath);
+    return LoadFromGLTF(filepath);
+}
+
+void GLTFLoader::CookTextures(GLTFModelData& model) {
+    struct TextureRole {
+        Format            decodeFormat;
+        MipOptions::Value mipOptions;
+        Format            encodeFormat;
+    };
+    // albedo is decoded as sRGB so mips are filtered in linear space, normals only keep xy and
+    // rebuild z in the shader
+    constexpr TextureRole Roles[] = {
+        {Format::R8G8B8A8_SRGB, MipOptions::DEFAULT, Format::BC7_SRGB_BLOCK},
+        {Format::R8G8B8A8_UNORM, MipOptions::NORMAL_MAP, Format::BC5_UNORM_BLOCK},
+        {Format::R8G8B8A8_UNORM, MipOptions::DEFAULT, Format::BC1_RGB_UNORM_BLOCK}};
+
+    // an image sampled in two roles is rare enough to be cooked for the first one only
+    std::vector<int32_t> imageRoles(model.images.size(), -1);
+    for (const auto& material : model.materials) {
+        int32_t images[] = {material.albedoImage, material.normalImage,
+                            material.metallicRoughnessImage};
+        for (int32_t role = 0; role < 3; ++role) {
+            if (images[role] >= 0 && imageRoles[images[role]] < 0)
+                imageRoles[images[role]] = role;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    model.textures.clear();
+    model.textures.resize(model.images.size());
+    model.textureHashes.resize(model.images.size());
+    utils::ParallelFor(model.images.size(), [&](size_t i) {
+        model.textureHashes[i] = utils::HashBytes(model.images[i]);
+        if (imageRoles[i] < 0) return;
+        const auto& role  = Roles[imageRoles[i]];
+        ImageData   image = ImageLoader::LoadImageDataFromMemory(model.images[i],
+                                                                 role.decodeFormat);
+        if (image.ByteData.empty()) return;
+        MipGenerator::Generate(image, role.mipOptions);
+        model.textures[i] = BlockEncoder::Encode(image, role.encodeFormat);
+    });
+    model.images.clear();
+
+    std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    WIND_CORE_INFO("Cook {} textures in {:.2f} ms", model.textures.size(), elapsed.count());
+}
+
 }; // namespace wind::gltf
\ No newline at end of file
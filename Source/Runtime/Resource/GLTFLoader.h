@@ -6,7 +6,11 @@
 #include "glm/glm.hpp"
 
 #include "Runtime/Render/RHI/Buffer.h"
+#include "Runtime/Render/RHI/GeometryPool.h"
 #include "Runtime/Resource/ImageData.h"
+#include "Runtime/Resource/MeshSimplifier.h"
+#include "Runtime/Resource/Meshlet.h"
+#include "Runtime/Resource/PackedVertex.h"
 
 
 namespace wind::gltf {
@@ -65,11 +69,13 @@ struct GLTFVertex {
 
 struct GLTFMaterial {
     std::string name;
-    ImageData   albedoTexture;
-    ImageData   normalTexture;
-    ImageData   metallicRoughness;
-    float       roughnessScale = 1.0f;
-    float       metallicScale  = 1.0f;
+    // indices into GLTFModelData::images, -1 when the material has no such texture
+    int32_t     albedoImage            = -1;
+    int32_t     normalImage            = -1;
+    int32_t     metallicRoughnessImage = -1;
+    float       roughnessScale         = 1.0f;
+    float       metallicScale          = 1.0f;
+    bool        doubleSided            = false;
 };
 
 struct GLTFShape {
@@ -77,15 +83,28 @@ struct GLTFShape {
     std::string             name;
     std::vector<GLTFVertex> vertices;
     std::vector<Index>      indices;
+    std::vector<Meshlet>    meshlets;
+    // lods[0] is the full mesh, coarser levels follow it in indices and meshlets
+    std::vector<MeshLod>    lods;
     uint32_t                materialIndex = -1;
 };
 
 struct GLTFModelData {
     std::vector<GLTFShape>    shapes;
     std::vector<GLTFMaterial> materials;
+    // still encoded (png, jpeg) as read from the source, CookTextures turns them into textures
+    std::vector<std::vector<uint8_t>> images;
+    // block compressed with the full mip chain, same indices as images
+    std::vector<ImageData>            textures;
+    // hash of the encoded source of every texture, keys the texture cache
+    std::vector<uint64_t>             textureHashes;
+    // external buffers and images the document references, keys the mesh cache
+    std::vector<std::string>          dependencies;
 };
 
 struct GLTFMesh {
+    // std430 element of the material storage buffer, the texture indices point into the bindless
+    // texture table
     struct Material {
         uint32_t albedoIndex;
         uint32_t normalIndex;
@@ -96,26 +115,51 @@ struct GLTFMesh {
     };
 
     struct Submesh {
-        Buffer   vertexBuffer;
-        Buffer   indexBuffer;
-        uint32_t materialIndex;
+        // vertex and index range in the scene geometry pool, the indices are relative to its
+        // vertexOffset
+        GeometryPool::Handle geometry = GeometryPool::InvalidHandle;
+        uint32_t             materialIndex;
+        // of a double sided material: drawn without back face culling and its meshlets carry no
+        // cones, single sided ones have both
+        bool                 doubleSided = false;
+        PackedVertexBounds   bounds; // only meaningful with UsePackedVertex
+        // contiguous ranges of the index buffer with culling data, drawn as visible runs
+        std::vector<Meshlet> meshlets;
+        // index and meshlet ranges per level of detail, plus the sphere used to select them
+        std::vector<MeshLod> lods;
+        glm::vec4            boundingSphere{0.0f};
     };
 
     std::vector<Submesh>  submeshes;
     std::vector<Material> materials;
-    std::vector<Image>    textures;
-    
+    // the three placeholders followed by one slot per texture the materials sample, each
+    // registered in the bindless texture table at the matching entry of textureIndices
+    std::vector<std::shared_ptr<Image>> textures;
+    std::vector<uint32_t>               textureIndices;
+
     struct MeshData {
         glm::mat4 Transform = glm::mat4(1.0f);
     } Data;
 
+    // storage buffer of every material, sized to the mesh
     std::shared_ptr<Buffer> materialBuffer;
-    static constexpr int MaxMaterialCount = 256;
+    // upload submeshes as 20 byte PackedVertex instead of GLTFVertex, the passes pick the matching
+    // vertex factory and shaders
+    static constexpr bool     UsePackedVertex = true;
+    static constexpr uint32_t VertexStride =
+        UsePackedVertex ? sizeof(PackedVertex) : sizeof(GLTFVertex);
 };
 
 class GLTFLoader {
 public:
+    // dispatch on the file extension, .glb goes through the memory-mapped path
+    static GLTFModelData LoadFromFile(const std::string& filepath);
     static GLTFModelData LoadFromGLTF(const std::string& filepath);
+    static GLTFModelData LoadFromGLB(const std::string& filepath);
+    // decode, mip and BCn encode every image in the role of the first material using it (albedo
+    // to BC7 sRGB, normal to BC5, metallic roughness to BC1), one image per worker thread. The
+    // encoded images are released afterwards.
+    static void          CookTextures(GLTFModelData& model);
     void                 PackToGLTFMesh(const GLTFModelData& source, GLTFMesh& Mesh);
 };
 } // namespace wind::gltf
\ No newline at end of file
@@ -16,4 +16,63 @@ namespace wind {
         }
         return 0;
     }
-}
\ No newline at end of file
+
+    uint32_t FormatToBlockByteSize(Format format) {
+        switch(format) {
+            case Format::BC1_RGB_UNORM_BLOCK:
+            case Format::BC1_RGB_SRGB_BLOCK:
+            case Format::BC1_RGBA_UNORM_BLOCK:
+            case Format::BC1_RGBA_SRGB_BLOCK:
+            case Format::BC4_UNORM_BLOCK:
+            case Format::BC4_SNORM_BLOCK:
+                return 8;
+            case Format::BC2_UNORM_BLOCK:
+            case Format::BC2_SRGB_BLOCK:
+            case Format::BC3_UNORM_BLOCK:
+            case Format::BC3_SRGB_BLOCK:
+            case Format::BC5_UNORM_BLOCK:
+            case Format::BC5_SNORM_BLOCK:
+            case Format::BC6H_UFLOAT_BLOCK:
+            case Format::BC6H_SFLOAT_BLOCK:
+            case Format::BC7_UNORM_BLOCK:
+            case Format::BC7_SRGB_BLOCK:
+                return 16;
+            default:
+                return 0;
+        }
+    }
+
+    uint32_t FormatToTexelByteSize(Format format) {
+        // Format follows the order of vk::Format, a group of formats is a range of it
+        auto inRange = [format](Format first, Format last) {
+            return format >= first && format <= last;
+        };
+        if (format == Format::R4G4_UNORM_PACK_8) return 1;
+        if (inRange(Format::R4G4B4A4_UNORM_PACK_16, Format::A1R5G5B5_UNORM_PACK_16)) return 2;
+        if (inRange(Format::R8_UNORM, Format::R8_SRGB)) return 1;
+        if (inRange(Format::R8G8_UNORM, Format::R8G8_SRGB)) return 2;
+        if (inRange(Format::R8G8B8_UNORM, Format::B8G8R8_SRGB)) return 3;
+        if (inRange(Format::R8G8B8A8_UNORM, Format::A2B10G10R10_SINT_PACK_32)) return 4;
+        if (inRange(Format::R16_UNORM, Format::R16_SFLOAT)) return 2;
+        if (inRange(Format::R16G16_UNORM, Format::R16G16_SFLOAT)) return 4;
+        if (inRange(Format::R16G16B16_UNORM, Format::R16G16B16_SFLOAT)) return 6;
+        if (inRange(Format::R16G16B16A16_UNORM, Format::R16G16B16A16_SFLOAT)) return 8;
+        if (inRange(Format::R32_UINT, Format::R32_SFLOAT)) return 4;
+        if (inRange(Format::R32G32_UINT, Format::R32G32_SFLOAT)) return 8;
+        if (inRange(Format::R32G32B32_UINT, Format::R32G32B32_SFLOAT)) return 12;
+        if (inRange(Format::R32G32B32A32_UINT, Format::R32G32B32A32_SFLOAT)) return 16;
+        if (inRange(Format::R64_UINT, Format::R64_SFLOAT)) return 8;
+        if (inRange(Format::R64G64_UINT, Format::R64G64_SFLOAT)) return 16;
+        if (inRange(Format::R64G64B64_UINT, Format::R64G64B64_SFLOAT)) return 24;
+        if (inRange(Format::R64G64B64A64_UINT, Format::R64G64B64A64_SFLOAT)) return 32;
+        if (inRange(Format::B10G11R11_UFLOAT_PACK_32, Format::E5B9G9R9_UFLOAT_PACK_32)) return 4;
+        return 0;
+    }
+
+    size_t GetImageLevelByteSize(Format format, uint32_t width, uint32_t height) {
+        if (uint32_t blockByteSize = FormatToBlockByteSize(format))
+            return (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockByteSize;
+        if (format == Format::E5B9G9R9_UFLOAT_PACK_32) return (size_t)width * height * 4;
+        return (size_t)width * height * FormatToChannelNum(format);
+    }
+}
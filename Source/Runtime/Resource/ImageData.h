@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <vector>
 
 #include "Runtime/Render/RHI/Image.h"
@@ -7,6 +9,13 @@
 namespace wind {
 
 uint32_t FormatToChannelNum(Format format);
+// bytes per 4x4 block of a BCn format, 0 for formats that are not block compressed
+uint32_t FormatToBlockByteSize(Format format);
+// bytes per texel of an uncompressed color format, 0 for block and depth stencil formats
+uint32_t FormatToTexelByteSize(Format format);
+// byte size of one width x height level, whole blocks for BCn, 4 bytes per texel for the packed
+// E5B9G9R9 and 8 bit channels otherwise
+size_t   GetImageLevelByteSize(Format format, uint32_t width, uint32_t height);
 
 struct ImageData {
     std::vector<uint8_t>              ByteData;
@@ -19,10 +28,12 @@ struct ImageData {
 };
 
 struct CubemapData {
-    std::array<std::vector<uint8_t>, 6> Faces;
-    Format                              FaceFormat = Format::UNDEFINED;
-    uint32_t                            FaceWidth  = 0;
-    uint32_t                            FaceHeight = 0;
+    std::array<std::vector<uint8_t>, 6>              Faces;
+    Format                                           FaceFormat = Format::UNDEFINED;
+    uint32_t                                         FaceWidth  = 0;
+    uint32_t                                         FaceHeight = 0;
+    // the levels below Faces, six faces each, uploaded as is instead of blitting the chain
+    std::vector<std::array<std::vector<uint8_t>, 6>> MipLevels;
 };
 
 } // namespace wind
\ No newline at end of file
@@ -1,14 +1,31 @@
 #include "ImageLoader.h"
 
-#include "Runtime/Base/Utils.h"
+#include "Runtime/Base/Io.h"
+#include "Runtime/Base/Macro.h"
 #include "Runtime/Render/RHI/Backend.h"
 #include "Runtime/Render/RHI/CommandBuffer.h"
 #include "Runtime/Render/RHI/Image.h"
 #include "Runtime/Resource/ImageData.h"
+#include "Runtime/Resource/Ktx2Loader.h"
+#include "Runtime/Resource/MipGenerator.h"
 
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
 #include <filesystem>
 #include <string>
+#include <vector>
 
+namespace wind {
+static void* StbMalloc(size_t size);
+static void* StbRealloc(void* pointer, size_t size);
+static void  StbFree(void* pointer);
+} // namespace wind
+
+#define STBI_MALLOC(size)           wind::StbMalloc(size)
+#define STBI_REALLOC(pointer, size) wind::StbRealloc(pointer, size)
+#define STBI_FREE(pointer)          wind::StbFree(pointer)
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
@@ -16,6 +33,76 @@
 #include <ThirdParty/tinyddsloader.h>
 
 namespace wind {
+// Caller memory the decode running on this thread writes its output to. stb requests the output
+// block with one allocation of exactly its size and that request is served from the target, every
+// other allocation goes to the heap. Should the output land on the heap anyway, a temporary of the
+// same size took the target first or the jpeg decoder asked for a spare byte, DecodeInto copies it
+// over once the decode returns.
+struct DecodeTarget {
+    uint8_t* data  = nullptr;
+    size_t   size  = 0;
+    bool     taken = false;
+};
+
+static thread_local DecodeTarget decodeTarget;
+
+static void* StbMalloc(size_t size) {
+    if (decodeTarget.data != nullptr && !decodeTarget.taken && size == decodeTarget.size) {
+        decodeTarget.taken = true;
+        return decodeTarget.data;
+    }
+    return std::malloc(size);
+}
+
+static void* StbRealloc(void* pointer, size_t size) {
+    if (pointer == nullptr || pointer != decodeTarget.data) return std::realloc(pointer, size);
+    // the target can not grow, the block moves to the heap
+    void* moved = std::malloc(size);
+    if (moved != nullptr) std::memcpy(moved, pointer, std::min(size, decodeTarget.size));
+    decodeTarget.taken = false;
+    return moved;
+}
+
+static void StbFree(void* pointer) {
+    if (pointer != nullptr && pointer == decodeTarget.data) {
+        decodeTarget.taken = false;
+        return;
+    }
+    std::free(pointer);
+}
+
+// Run decode, which returns an stb allocation and its size in texels, with the output placed in
+// destination. False when the decode fails or does not fill destination exactly.
+template <typename DecodeFunc>
+static bool DecodeInto(std::span<uint8_t> destination, size_t texelByteSize, DecodeFunc&& decode) {
+    int width = 0, height = 0;
+    decodeTarget = DecodeTarget{destination.data(), destination.size(), false};
+    void* pixels = decode(&width, &height);
+    decodeTarget = DecodeTarget{};
+    if (pixels == nullptr) return false;
+
+    bool valid = (size_t)width * height * texelByteSize == destination.size();
+    if (pixels != destination.data()) {
+        if (valid) std::memcpy(destination.data(), pixels, destination.size());
+        stbi_image_free(pixels);
+    }
+    return valid;
+}
+
+// in place, stb's own flip is a global switch that would race between streaming workers
+static void FlipRows(std::span<uint8_t> pixels, size_t rowByteSize) {
+    std::vector<uint8_t> row(rowByteSize);
+    size_t               rowCount = pixels.size() / rowByteSize;
+    if (rowCount < 2) return;
+    for (size_t top = 0, bottom = rowCount - 1; top < bottom; ++top, --bottom) {
+        uint8_t* topRow    = pixels.data() + top * rowByteSize;
+        uint8_t* bottomRow = pixels.data() + bottom * rowByteSize;
+        std::memcpy(row.data(), topRow, rowByteSize);
+        std::memcpy(topRow, bottomRow, rowByteSize);
+        std::memcpy(bottomRow, row.data(), rowByteSize);
+    }
+}
+
 static bool IsDDSImage(const std::string& filepath) {
     std::filesystem::path filename{filepath};
     return filename.extension() == ".dds";
@@ -176,33 +263,33 @@ static Format DDSFormatToImageFormat(tinyddsloader::DDSFile::DXGIFormat format)
     case tinyddsloader::DDSFile::DXGIFormat::BC1_Typeless:
         return Format::UNDEFINED;
     case tinyddsloader::DDSFile::DXGIFormat::BC1_UNorm:
-        return Format::UNDEFINED;
+        return Format::BC1_RGBA_UNORM_BLOCK;
     case tinyddsloader::DDSFile::DXGIFormat::BC1_UNorm_SRGB:
-        return Format::UNDEFINED;
+        return Format::BC1_RGBA_SRGB_BLOCK;
     case tinyddsloader::DDSFile::DXGIFormat::BC2_Typeless:
         return Format::UNDEFINED;
     case tinyddsloader::DDSFile::DXGIFormat::BC2_UNorm:
-        return Format::UNDEFINED;
+        return Format::BC2_UNORM_BLOCK;
     case tinyddsloader::DDSFile::DXGIFormat::BC2_UNorm_SRGB:
-        return Format::UNDEFINED;
+        return Format::BC2_SRGB_BLOCK;
     case tinyddsloader::DDSFile::DXGIFormat::BC3_Typeless:
         return Format::UNDEFINED;
     case tinyddsloader::DDSFile::DXGIFormat::BC3_UNorm:
-        return Format::UNDEFINED;
+        return Format::BC3_UNORM_BLOCK;
     case tinyddsloader::DDSFile::DXGIFormat::BC3_UNorm_SRGB:
-        return Format::UNDEFINED;
+        return Format::BC3_SRGB_BLOCK;
     case tinyddsloader::DDSFile::DXGIFormat::BC4_Typeless:
         return Format::UNDEFINED;
     case tinyddsloader::DDSFile::DXGIFormat::BC4_UNorm:
-        return Format::UNDEFINED;
+        return Format::BC4_UNORM_BLOCK;
     case tinyddsloader::DDSFile::DXGIFormat::BC4_SNorm:
-        return Format::UNDEFINED;
+        return Format::BC4_SNORM_BLOCK;
     case tinyddsloader::DDSFile::DXGIFormat::BC5_Typeless:
         return Format::UNDEFINED;
     case tinyddsloader::DDSFile::DXGIFormat::BC5_UNorm:
-        return Format::UNDEFINED;
+        return Format::BC5_UNORM_BLOCK;
     case tinyddsloader::DDSFile::DXGIFormat::BC5_SNorm:
-        return Format::UNDEFINED;
+        return Format::BC5_SNORM_BLOCK;
     case tinyddsloader::DDSFile::DXGIFormat::B5G6R5_UNorm:
         return Format::B5G6R5_UNORM_PACK_16;
     case tinyddsloader::DDSFile::DXGIFormat::B5G5R5A1_UNorm:
@@ -224,15 +311,15 @@ static Format DDSFormatToImageFormat(tinyddsloader::DDSFile::DXGIFormat format)
     case tinyddsloader::DDSFile::DXGIFormat::BC6H_Typeless:
         return Format::UNDEFINED;
     case tinyddsloader::DDSFile::DXGIFormat::BC6H_UF16:
-        return Format::UNDEFINED;
+        return Format::BC6H_UFLOAT_BLOCK;
     case tinyddsloader::DDSFile::DXGIFormat::BC6H_SF16:
-        return Format::UNDEFINED;
+        return Format::BC6H_SFLOAT_BLOCK;
     case tinyddsloader::DDSFile::DXGIFormat::BC7_Typeless:
         return Format::UNDEFINED;
     case tinyddsloader::DDSFile::DXGIFormat::BC7_UNorm:
-        return Format::UNDEFINED;
+        return Format::BC7_UNORM_BLOCK;
     case tinyddsloader::DDSFile::DXGIFormat::BC7_UNorm_SRGB:
-        return Format::UNDEFINED;
+        return Format::BC7_SRGB_BLOCK;
     case tinyddsloader::DDSFile::DXGIFormat::AYUV:
         return Format::UNDEFINED;
     case tinyddsloader::DDSFile::DXGIFormat::Y410:
@@ -276,15 +363,11 @@ static Format DDSFormatToImageFormat(tinyddsloader::DDSFile::DXGIFormat format)
     }
 }
 
-static ImageData LoadImageUsingDDSLoader(const std::string& filepath) {
-    ImageData              image;
-    tinyddsloader::DDSFile dds;
-    auto                   result = dds.Load(filepath.c_str());
-    if (result != tinyddsloader::Result::Success) return image;
-
+static ImageData CopyDDSImageData(tinyddsloader::DDSFile& dds) {
+    ImageData image;
     dds.Flip();
     auto imageData    = dds.GetImageData();
-    image.Width       = imageData->m_height;
+    image.Width       = imageData->m_width;
     image.Height      = imageData->m_height;
     image.ImageFormat = DDSFormatToImageFormat(dds.GetFormat());
     image.ByteData.resize(imageData->m_memSlicePitch);
@@ -304,57 +387,54 @@ static ImageData LoadImageUsingDDSLoader(const std::string& filepath) {
     return image;
 }
 
-static std::string ConvertZLIBToDDS(const std::string& filepath) {
-    std::ifstream file(filepath, std::ios::binary);
-    if (!file.good()) return filepath;
-
-    std::vector<char> compressedData{std::istreambuf_iterator<char>(file),
-                                     std::istreambuf_iterator<char>()};
-
-    int   decompressedSize = 0;
-    char* decompressedData = stbi_zlib_decode_malloc(compressedData.data(),
-                                                     (int)compressedData.size(), &decompressedSize);
-
-    std::filesystem::path path{filepath};
-    auto                  ddsFilepath = (path.parent_path() / path.stem()).string() + ".dds";
-    std::ofstream         ddsFile(ddsFilepath, std::ios::binary);
-    ddsFile.write(decompressedData, decompressedSize);
-    free(decompressedData);
-
-    return ddsFilepath;
+static ImageData LoadImageUsingDDSLoader(const std::string& filepath) {
+    tinyddsloader::DDSFile dds;
+    auto                   result = dds.Load(filepath.c_str());
+    if (result != tinyddsloader::Result::Success) return {};
+    return CopyDDSImageData(dds);
 }
 
+// The compressed file is mapped and inflated into memory, the DDS is parsed from that buffer and
+// nothing is written next to the source, so read only asset directories work. Callers that must
+// not block go through TextureStreamer, which runs this on one of its workers.
 static ImageData LoadImageUsingZLIBLoader(const std::string& filepath) {
-    auto ddsFilepath = ConvertZLIBToDDS(filepath);
-    return LoadImageUsingDDSLoader(ddsFilepath);
+    // a first guess at the inflated size saves most of the regrowing of the output buffer
+    constexpr int InflateRatioGuess = 4;
+
+    io::MappedFile file(filepath);
+    if (!file.IsValid()) return {};
+
+    int   ddsSize = 0;
+    int   guess   = (int)std::min<size_t>(file.GetSize() * InflateRatioGuess, INT_MAX);
+    char* ddsData = stbi_zlib_decode_malloc_guesssize((const char*)file.GetData(),
+                                                      (int)file.GetSize(), guess, &ddsSize);
+    if (ddsData == nullptr) {
+        WIND_CORE_ERROR("Failed to inflate {}: {}", filepath, stbi_failure_reason());
+        return {};
+    }
+
+    tinyddsloader::DDSFile dds;
+    auto                   result = dds.Load(std::vector<uint8_t>(ddsData, ddsData + ddsSize));
+    free(ddsData);
+    if (result != tinyddsloader::Result::Success) {
+        WIND_CORE_ERROR("Failed to parse the DDS inflated from {}", filepath);
+        return {};
+    }
+    return CopyDDSImageData(dds);
 }
 
 static ImageData LoadImageUsingSTBLoader(const std::string& filepath, Format format) {
-    int                  width = 0, height = 0, channels = 0;
-    uint32_t             actualChannels = FormatToChannelNum(format);
-    std::vector<uint8_t> vecData;
-
-    if (IsHdrImage(filepath)) {
-        stbi_set_flip_vertically_on_load(true);
-        float* data = stbi_loadf(filepath.c_str(), &width, &height, &channels, actualChannels);
-        stbi_set_flip_vertically_on_load(false);
-        vecData.resize(width * height * actualChannels * sizeof(float));
-        std::copy(data, data + vecData.size(), vecData.begin());
-        stbi_image_free(data);
-        ImageData imagedata{std::move(vecData), format, (uint32_t)width, (uint32_t)height,
-                            (uint32_t)channels};
-        imagedata.isHdr = true;
-        return imagedata;
+    ImageData image;
+    size_t byteSize = ImageLoader::GetDecodedByteSize(filepath, format, image.Width, image.Height);
+    image.ByteData.resize(byteSize);
+    if (byteSize == 0 || !ImageLoader::DecodeImage(filepath, format, image.ByteData)) {
+        WIND_CORE_ERROR("Failed to decode image {}: {}", filepath, stbi_failure_reason());
+        return {};
     }
-    stbi_set_flip_vertically_on_load(true);
-    uint8_t* data = stbi_load(filepath.c_str(), &width, &height, &channels, actualChannels);
-    stbi_set_flip_vertically_on_load(false);
-    vecData.resize(width * height * actualChannels * sizeof(uint8_t));
-    std::copy(data, data + vecData.size(), vecData.begin());
-    stbi_image_free(data);
-    ImageData imagedata{std::move(vecData), format, (uint32_t)width, (uint32_t)height,
-                        (uint32_t)channels};
-    return imagedata;
+    image.ImageFormat = format;
+    image.channels    = FormatToChannelNum(format);
+    image.isHdr       = IsHdrImage(filepath);
+    return image;
 }
 
 static std::vector<uint8_t> ExtractCubemapFace(const ImageData& image, size_t faceWidth,
@@ -400,27 +480,99 @@ static CubemapData CreateCubemapFromSingleImage(const ImageData& image) {
 
 ImageData ImageLoader::LoadImageDataFromFile(const std::string& filepath, Format format) {
     if (IsDDSImage(filepath)) return LoadImageUsingDDSLoader(filepath);
+    else if (Ktx2Loader::IsKtx2File(filepath))
+        return Ktx2Loader::Load(filepath);
     else if (IsZLIBImage(filepath))
         return LoadImageUsingZLIBLoader(filepath);
     else
         return LoadImageUsingSTBLoader(filepath, format);
 }
 
+ImageData ImageLoader::LoadImageDataFromMemory(std::span<const uint8_t> encoded, Format format) {
+    if (encoded.empty()) return {};
+
+    int       width = 0, height = 0, channels = 0;
+    const int length = (int)encoded.size();
+    if (!stbi_info_from_memory(encoded.data(), length, &width, &height, &channels)) {
+        WIND_CORE_ERROR("Failed to decode image: {}", stbi_failure_reason());
+        return {};
+    }
+
+    uint32_t  actualChannels = FormatToChannelNum(format);
+    ImageData image{std::vector<uint8_t>((size_t)width * height * actualChannels), format,
+                    (uint32_t)width, (uint32_t)height, actualChannels};
+    bool      decoded = DecodeInto(image.ByteData, actualChannels, [&](int* x, int* y) {
+        return stbi_load_from_memory(encoded.data(), length, x, y, &channels, (int)actualChannels);
+    });
+    if (!decoded) {
+        WIND_CORE_ERROR("Failed to decode image: {}", stbi_failure_reason());
+        return {};
+    }
+    return image;
+}
+
+size_t ImageLoader::GetDecodedByteSize(const std::string& filepath, Format format,
+                                       uint32_t& width, uint32_t& height) {
+    if (IsDDSImage(filepath) || Ktx2Loader::IsKtx2File(filepath) || IsZLIBImage(filepath)) return 0;
+
+    int x = 0, y = 0, channels = 0;
+    if (!stbi_info(filepath.c_str(), &x, &y, &channels)) return 0;
+    width  = (uint32_t)x;
+    height = (uint32_t)y;
+
+    size_t channelSize = IsHdrImage(filepath) ? sizeof(float) : sizeof(uint8_t);
+    return (size_t)width * height * FormatToChannelNum(format) * channelSize;
+}
+
+bool ImageLoader::DecodeImage(const std::string& filepath, Format format,
+                              std::span<uint8_t> destination) {
+    int        channels       = 0;
+    const int  actualChannels = (int)FormatToChannelNum(format);
+    const bool isHdr          = IsHdrImage(filepath);
+    size_t     texelByteSize  = actualChannels * (isHdr ? sizeof(float) : sizeof(uint8_t));
+
+    int  width   = 0;
+    bool decoded = DecodeInto(destination, texelByteSize, [&](int* x, int* y) -> void* {
+        void* pixels = isHdr ? (void*)stbi_loadf(filepath.c_str(), x, y, &channels, actualChannels)
+                             : (void*)stbi_load(filepath.c_str(), x, y, &channels, actualChannels);
+        width        = *x;
+        return pixels;
+    });
+    if (decoded) FlipRows(destination, width * texelByteSize);
+    return decoded;
+}
+
+// files without their own mip chain get one from the CPU instead of a GPU blit chain
+static ImageData LoadImageDataWithMips(const std::string& filepath, Format format,
+                                       ImageOptions::Value options) {
+    auto imageData = ImageLoader::LoadImageDataFromFile(filepath, format);
+    if ((options & ImageOptions::MIPMAPS) && imageData.MipLevels.empty())
+        MipGenerator::Generate(imageData);
+    return imageData;
+}
+
 CubemapData ImageLoader::LoadCubemapDataFromFile(const std::string& filepath, Format format) {
     auto imageData = ImageLoader::LoadImageDataFromFile(filepath, format);
     return CreateCubemapFromSingleImage(imageData);
 }
 
+// texel rows per row of level data, levels larger than the staging ring are copied in bands of rows
+static uint32_t GetRowHeight(Format format) { return FormatToBlockByteSize(format) != 0 ? 4 : 1; }
+
 void ImageLoader::FillImage(CommandBuffer& commandBuffer, Image& image, const ImageData& imageData,
                             ImageOptions::Value options) {
-    auto& stageBuffer = RenderBackend::GetInstance().GetStagingBuffer();
+    auto&          stageBuffer = RenderBackend::GetInstance().GetStagingBuffer();
+    const uint32_t rowHeight   = GetRowHeight(imageData.ImageFormat);
+    // block compressed images can not be blit targets, without their own chain they get one level
+    if (FormatToBlockByteSize(imageData.ImageFormat) != 0 && imageData.MipLevels.empty())
+        options &= ~ImageOptions::MIPMAPS;
     image.Init(imageData.Width, imageData.Height, ToNative(imageData.ImageFormat),
                ImageUsage::SHADER_READ | ImageUsage::TRANSFER_SOURCE |
                    ImageUsage::TRANSFER_DESTINATION,
                MemoryUsage::GPU_ONLY, options);
-    auto allocation = stageBuffer.Submit(utils::MakeView(imageData.ByteData));
-    commandBuffer.CopyBufferToImage(BufferInfo{stageBuffer.GetBuffer(), allocation.Offset},
-                                    ImageInfo{image, ImageUsage::UNKNOWN, 0, 0});
+    stageBuffer.CopyToImage(commandBuffer, imageData.ByteData,
+                            ImageInfo{image, ImageUsage::UNKNOWN, 0, 0}, rowHeight,
+                            ImageCopyAlignment);
     if (options & ImageOptions::MIPMAPS) {
         if (imageData.MipLevels.empty()) {
             commandBuffer.GenerateMipLevels(image, ImageUsage::TRANSFER_DESTINATION,
@@ -428,10 +580,10 @@ void ImageLoader::FillImage(CommandBuffer& commandBuffer, Image& image, const Im
         } else {
             uint32_t mipLevel = 1;
             for (const auto& mipData : imageData.MipLevels) {
-                auto allocation = stageBuffer.Submit(utils::MakeView(mipData));
-                commandBuffer.CopyBufferToImage(
-                    BufferInfo{stageBuffer.GetBuffer(), allocation.Offset},
-                    ImageInfo{image, ImageUsage::TRANSFER_DESTINATION, mipLevel, 0});
+                stageBuffer.CopyToImage(
+                    commandBuffer, mipData,
+                    ImageInfo{image, ImageUsage::TRANSFER_DESTINATION, mipLevel, 0}, rowHeight,
+                    ImageCopyAlignment);
                 mipLevel++;
             }
         }
@@ -439,70 +591,115 @@ void ImageLoader::FillImage(CommandBuffer& commandBuffer, Image& image, const Im
     commandBuffer.TransferLayout(image, ImageUsage::TRANSFER_DESTINATION, ImageUsage::SHADER_READ);
 }
 
+// Files stb reads and that need no CPU mip chain are decoded into a scratch buffer kept by the
+// thread and streamed to the staging ring from there, the rest go through ImageData. stb and the
+// row flip read their output back, which must not happen in write combined staging memory.
+static void FillImageFromFile(CommandBuffer& commandBuffer, Image& image, Format format,
+                              const std::string& filepath, ImageOptions::Value options) {
+    uint32_t width = 0, height = 0;
+    size_t   byteSize     = 0;
+    bool     needsCpuMips = (options & ImageOptions::MIPMAPS) && !IsHdrImage(filepath);
+    if (!needsCpuMips)
+        byteSize = ImageLoader::GetDecodedByteSize(filepath, format, width, height);
+    if (byteSize == 0) {
+        ImageLoader::FillImage(commandBuffer, image,
+                               LoadImageDataWithMips(filepath, format, options), options);
+        return;
+    }
+
+    static thread_local std::vector<uint8_t> scratch;
+    auto& stageBuffer = RenderBackend::GetInstance().GetStagingBuffer();
+    scratch.resize(byteSize);
+    bool decoded = ImageLoader::DecodeImage(filepath, format, scratch);
+    // the buffer is reused for the next file, unless one outgrew the staging ring
+    auto releaseScratch = [&] {
+        if (scratch.capacity() > stageBuffer.GetByteSize()) scratch = {};
+    };
+
+    image.Init(width, height, ToNative(format),
+               ImageUsage::SHADER_READ | ImageUsage::TRANSFER_SOURCE |
+                   ImageUsage::TRANSFER_DESTINATION,
+               MemoryUsage::GPU_ONLY, options);
+    if (!decoded) {
+        // nothing is staged, the image stays sampleable with undefined contents
+        WIND_CORE_ERROR("Failed to decode image {}: {}", filepath, stbi_failure_reason());
+        releaseScratch();
+        commandBuffer.TransferLayout(image, ImageUsage::UNKNOWN, ImageUsage::SHADER_READ);
+        return;
+    }
+    stageBuffer.CopyToImage(commandBuffer, scratch, ImageInfo{image, ImageUsage::UNKNOWN, 0, 0},
+                            GetRowHeight(format), ImageLoader::ImageCopyAlignment);
+    releaseScratch();
+    if (options & ImageOptions::MIPMAPS)
+        commandBuffer.GenerateMipLevels(image, ImageUsage::TRANSFER_DESTINATION,
+                                        BlitFilter::LINEAR);
+    commandBuffer.TransferLayout(image, ImageUsage::TRANSFER_DESTINATION, ImageUsage::SHADER_READ);
+}
+
 void ImageLoader::FillImage(Image& image, Format format, CommandBuffer& cmdBuffer,
                             const std::string& filepath, ImageOptions::Value options) {
-    auto& backend     = RenderBackend::GetInstance();
-    auto& stageBuffer = RenderBackend::GetInstance().GetStagingBuffer();
+    auto& backend = RenderBackend::GetInstance();
     cmdBuffer.Begin();
-    FillImage(cmdBuffer, image, ImageLoader::LoadImageDataFromFile(filepath, format), options);
+    FillImageFromFile(cmdBuffer, image, format, filepath, options);
     cmdBuffer.End();
     backend.SubmitSingleTimeCommand(cmdBuffer.GetNativeHandle());
-    stageBuffer.Flush();
-    stageBuffer.Reset();
 }
 
 void ImageLoader::FillImage(Image& image, Format format, const std::string& filepath,
                             ImageOptions::Value options) {
     auto& backend       = RenderBackend::GetInstance();
     auto  commandBuffer = backend.BeginSingleTimeCommand();
-    auto& stageBuffer   = RenderBackend::GetInstance().GetStagingBuffer();
 
-    FillImage(commandBuffer, image, ImageLoader::LoadImageDataFromFile(filepath, format), options);
+    FillImageFromFile(commandBuffer, image, format, filepath, options);
 
-    stageBuffer.Flush();
     backend.SubmitSingleTimeCommand(commandBuffer.GetNativeHandle());
-
-    stageBuffer.Reset();
 }
 
 void ImageLoader::FillImage(Image& image, ImageData& imageData, ImageOptions::Value options) {
     auto& backend       = RenderBackend::GetInstance();
     auto  commandBuffer = backend.BeginSingleTimeCommand();
-    auto& stageBuffer   = RenderBackend::GetInstance().GetStagingBuffer();
     FillImage(commandBuffer, image, imageData, options);
-    stageBuffer.Flush();
     backend.SubmitSingleTimeCommand(commandBuffer.GetNativeHandle());
-
-    stageBuffer.Reset();
 }
 
 void ImageLoader::LoadCubemap(Image& image, Format format, const std::string& filepath) {
+    LoadCubemap(image, ImageLoader::LoadCubemapDataFromFile(filepath, format));
+}
+
+void ImageLoader::LoadCubemap(Image& image, const CubemapData& cubemapData) {
     auto& backend       = RenderBackend::GetInstance();
     auto  commandBuffer = backend.BeginSingleTimeCommand();
     auto& stageBuffer   = backend.GetStagingBuffer();
 
-    auto cubemapData = ImageLoader::LoadCubemapDataFromFile(filepath, format);
-
     image.Init(cubemapData.FaceWidth, cubemapData.FaceHeight, ToNative(cubemapData.FaceFormat),
                ImageUsage::TRANSFER_DESTINATION | ImageUsage::TRANSFER_SOURCE |
                    ImageUsage::SHADER_READ,
                MemoryUsage::GPU_ONLY, ImageOptions::CUBEMAP | ImageOptions::MIPMAPS);
 
+    const uint32_t rowHeight = GetRowHeight(cubemapData.FaceFormat);
     for (uint32_t layer = 0; layer < cubemapData.Faces.size(); layer++) {
-        const auto& face              = cubemapData.Faces[layer];
-        auto        textureAllocation = stageBuffer.Submit(face.data(), face.size());
-
-        commandBuffer.CopyBufferToImage(
-            BufferInfo{stageBuffer.GetBuffer(), textureAllocation.Offset},
-            ImageInfo{image, ImageUsage::UNKNOWN, 0, layer});
+        stageBuffer.CopyToImage(commandBuffer, cubemapData.Faces[layer],
+                                ImageInfo{image, ImageUsage::UNKNOWN, 0, layer}, rowHeight,
+                                ImageCopyAlignment);
     }
 
-    commandBuffer.GenerateMipLevels(image, ImageUsage::TRANSFER_DESTINATION, BlitFilter::LINEAR);
+    if (cubemapData.MipLevels.empty()) {
+        commandBuffer.GenerateMipLevels(image, ImageUsage::TRANSFER_DESTINATION,
+                                        BlitFilter::LINEAR);
+    } else {
+        uint32_t mipLevel = 1;
+        for (const auto& faces : cubemapData.MipLevels) {
+            for (uint32_t layer = 0; layer < faces.size(); layer++) {
+                stageBuffer.CopyToImage(
+                    commandBuffer, faces[layer],
+                    ImageInfo{image, ImageUsage::TRANSFER_DESTINATION, mipLevel, layer},
+                    rowHeight, ImageCopyAlignment);
+            }
+            mipLevel++;
+        }
+    }
     commandBuffer.TransferLayout(image, ImageUsage::TRANSFER_DESTINATION, ImageUsage::SHADER_READ);
 
-    stageBuffer.Flush();
-
     backend.SubmitSingleTimeCommand(commandBuffer.GetNativeHandle());
-    stageBuffer.Reset();
 }
 } // namespace wind
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <span>
 #include <string>
 
 #include "Runtime/Render/RHI/CommandBuffer.h"
@@ -8,8 +9,22 @@
 namespace wind {
 class ImageLoader {
 public:
+    // staging offset alignment of every uploaded level, covers texel sizes and BCn blocks
+    static constexpr uint32_t ImageCopyAlignment = 16;
+
     static ImageData   LoadImageDataFromFile(const std::string& filepath, Format format);
+    // decode png / jpeg bytes as stored, without the vertical flip of the file path
+    static ImageData   LoadImageDataFromMemory(std::span<const uint8_t> encoded, Format format);
     static CubemapData LoadCubemapDataFromFile(const std::string& filepath, Format format);
+    // bytes DecodeImage writes for filepath, 8 bit channels or floats for .hdr, and its size.
+    // 0 for DDS, KTX2 and .zlib files, which stb does not read.
+    static size_t GetDecodedByteSize(const std::string& filepath, Format format, uint32_t& width,
+                                     uint32_t& height);
+    // Decode with the vertical flip of LoadImageDataFromFile straight into destination, which must
+    // be exactly GetDecodedByteSize bytes. No copy of the image is made on the heap on the way.
+    // The decoders and the flip read destination back, so it should not be write combined memory.
+    static bool   DecodeImage(const std::string& filepath, Format format,
+                              std::span<uint8_t> destination);
     static void FillImage(CommandBuffer& commandBuffer, Image& image, const ImageData& imageData,
                           ImageOptions::Value options);
     static void FillImage(Image& image, Format format, CommandBuffer& cmdBuffer,
@@ -19,5 +34,7 @@ public:
     static void FillImage(Image& image, ImageData& imageData, ImageOptions::Value options);
 
     static void LoadCubemap(Image& image, Format format, const std::string& filepath);
+    // blits the chain when the data has no MipLevels of its own
+    static void LoadCubemap(Image& image, const CubemapData& cubemapData);
 };
 } // namespace wind
\ No newline at end of file
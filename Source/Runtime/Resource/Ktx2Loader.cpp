@@ -0,0 +1,176 @@
+#include "Ktx2Loader.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#include "Runtime/Base/Macro.h"
+
+#include <stb_image.h>
+#include <zstd.h>
+
+namespace wind {
+static constexpr uint8_t Ktx2Identifier[12] = {0xAB, 'K',  'T',  'X',  ' ',  '2',
+                                               '0',  0xBB, '\r', '\n', 0x1A, '\n'};
+
+// the 2D image limit of common desktop GPUs, bounds what a corrupt header can make us allocate
+static constexpr uint32_t MaxDimension = 16384;
+
+enum class Ktx2Supercompression : uint32_t { None = 0, BasisLZ = 1, Zstd = 2, Zlib = 3 };
+
+struct Ktx2Header {
+    uint8_t  identifier[12];
+    uint32_t vkFormat;
+    uint32_t typeSize;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t layerCount;
+    uint32_t faceCount;
+    uint32_t levelCount;
+    uint32_t supercompressionScheme;
+    uint32_t dfdByteOffset;
+    uint32_t dfdByteLength;
+    uint32_t kvdByteOffset;
+    uint32_t kvdByteLength;
+    uint64_t sgdByteOffset;
+    uint64_t sgdByteLength;
+};
+static_assert(sizeof(Ktx2Header) == 80);
+
+struct Ktx2LevelIndex {
+    uint64_t byteOffset;
+    uint64_t byteLength;
+    uint64_t uncompressedByteLength;
+};
+
+using ZstdContext = std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)>;
+
+// the size every level of a valid file has, its uncompressed length is checked against it before
+// anything is allocated for it
+static size_t GetLevelByteSize(Format format, uint32_t width, uint32_t height) {
+    if (FormatToBlockByteSize(format) != 0) return GetImageLevelByteSize(format, width, height);
+    return (size_t)width * height * FormatToTexelByteSize(format);
+}
+
+// read one level of levelByteSize bytes, compressed holds the supercompressed bytes between the
+// calls
+static bool ReadLevel(std::ifstream& file, uint64_t fileSize, const Ktx2LevelIndex& index,
+                      size_t levelByteSize, Ktx2Supercompression scheme, ZSTD_DCtx* context,
+                      std::vector<uint8_t>& compressed, std::vector<uint8_t>& bytes) {
+    if (index.byteOffset > fileSize || index.byteLength > fileSize - index.byteOffset) return false;
+    if (scheme == Ktx2Supercompression::None && index.byteLength != levelByteSize) return false;
+    if (index.uncompressedByteLength != levelByteSize) return false;
+
+    auto& target = scheme == Ktx2Supercompression::None ? bytes : compressed;
+    target.resize(index.byteLength);
+    file.seekg((std::streamoff)index.byteOffset);
+    file.read((char*)target.data(), (std::streamsize)target.size());
+    if (!file) return false;
+
+    switch (scheme) {
+    case Ktx2Supercompression::None:
+        return true;
+    case Ktx2Supercompression::Zstd: {
+        auto contentSize = ZSTD_getFrameContentSize(compressed.data(), compressed.size());
+        if (contentSize != ZSTD_CONTENTSIZE_UNKNOWN && contentSize != levelByteSize) return false;
+        bytes.resize(levelByteSize);
+        size_t size = ZSTD_decompressDCtx(context, bytes.data(), bytes.size(), compressed.data(),
+                                          compressed.size());
+        return !ZSTD_isError(size) && size == bytes.size();
+    }
+    case Ktx2Supercompression::Zlib: {
+        bytes.resize(levelByteSize);
+        int size = stbi_zlib_decode_buffer((char*)bytes.data(), (int)bytes.size(),
+                                           (const char*)compressed.data(), (int)compressed.size());
+        return size >= 0 && (size_t)size == bytes.size();
+    }
+    default:
+        return false;
+    }
+}
+
+bool Ktx2Loader::IsKtx2File(const std::string& filepath) {
+    std::filesystem::path filename{filepath};
+    return filename.extension() == ".ktx2";
+}
+
+ImageData Ktx2Loader::Load(const std::string& filepath, uint32_t levelCount) {
+    std::error_code ec;
+    uint64_t        fileSize = std::filesystem::file_size(filepath, ec);
+    std::ifstream   file(filepath, std::ios::binary);
+    if (ec || !file.good()) {
+        WIND_CORE_ERROR("Failed to open KTX2 file {}", filepath);
+        return {};
+    }
+
+    Ktx2Header header{};
+    file.read((char*)&header, sizeof(header));
+    if (!file || std::memcmp(header.identifier, Ktx2Identifier, sizeof(Ktx2Identifier)) != 0) {
+        WIND_CORE_ERROR("{} is not a KTX2 file", filepath);
+        return {};
+    }
+
+    const Format format = TryFromNative((vk::Format)header.vkFormat);
+    if (format == Format::UNDEFINED || GetLevelByteSize(format, 1, 1) == 0 ||
+        header.pixelWidth == 0 || header.pixelHeight == 0 || header.pixelWidth > MaxDimension ||
+        header.pixelHeight > MaxDimension || header.pixelDepth > 1 || header.layerCount > 1 ||
+        header.faceCount != 1) {
+        WIND_CORE_ERROR("{} does not hold a single 2D image in a supported format", filepath);
+        return {};
+    }
+    const auto scheme = (Ktx2Supercompression)header.supercompressionScheme;
+    if (scheme != Ktx2Supercompression::None && scheme != Ktx2Supercompression::Zstd &&
+        scheme != Ktx2Supercompression::Zlib) {
+        WIND_CORE_ERROR("{} uses unsupported supercompression {}", filepath,
+                        header.supercompressionScheme);
+        return {};
+    }
+
+    // a level count of 0 leaves the chain to the loader, FillImage generates it on upload. Images
+    // are created with a full chain, a partial one would leave the levels it lacks undefined.
+    const uint32_t chainLevelCount =
+        (uint32_t)std::bit_width(std::max(header.pixelWidth, header.pixelHeight));
+    if (header.levelCount != 0 && header.levelCount != chainLevelCount) {
+        WIND_CORE_ERROR("{} holds {} of the {} levels of its mip chain, store all or only the base",
+                        filepath, header.levelCount, chainLevelCount);
+        return {};
+    }
+    const uint32_t              fileLevelCount = std::max(header.levelCount, 1u);
+    std::vector<Ktx2LevelIndex> levels(fileLevelCount);
+    file.read((char*)levels.data(), (std::streamsize)(levels.size() * sizeof(Ktx2LevelIndex)));
+    if (!file) {
+        WIND_CORE_ERROR("Failed to read the level index of {}", filepath);
+        return {};
+    }
+
+    // level 0 is the base, the smallest levelCount levels are the end of the index
+    const uint32_t firstLevel = fileLevelCount - std::clamp(levelCount, 1u, fileLevelCount);
+
+    ImageData image;
+    image.ImageFormat = format;
+    image.Width       = std::max(header.pixelWidth >> firstLevel, 1u);
+    image.Height      = std::max(header.pixelHeight >> firstLevel, 1u);
+
+    ZstdContext context(scheme == Ktx2Supercompression::Zstd ? ZSTD_createDCtx() : nullptr,
+                        &ZSTD_freeDCtx);
+    std::vector<uint8_t> compressed;
+    for (uint32_t level = firstLevel; level < fileLevelCount; ++level) {
+        const auto& index  = levels[level];
+        uint32_t    width  = std::max(header.pixelWidth >> level, 1u);
+        uint32_t    height = std::max(header.pixelHeight >> level, 1u);
+        auto&       bytes  = level == firstLevel ? image.ByteData : image.MipLevels.emplace_back();
+
+        if (!ReadLevel(file, fileSize, index, GetLevelByteSize(format, width, height), scheme,
+                       context.get(), compressed, bytes)) {
+            WIND_CORE_ERROR("Failed to read level {} of {}", level, filepath);
+            return {};
+        }
+    }
+    return image;
+}
+} // namespace wind
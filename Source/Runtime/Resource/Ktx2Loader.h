@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "Runtime/Resource/ImageData.h"
+
+namespace wind {
+// Reader for KTX2 containers holding a single 2D image in a GPU format, with every level stored
+// raw, zstd or zlib supercompressed. The level index is read first and each level is then read
+// and inflated on its own, so the small end of a mip chain can be loaded, and shown, without
+// touching the larger levels. Texels keep the top left origin of the file.
+class Ktx2Loader {
+public:
+    static constexpr uint32_t AllLevels = UINT32_MAX;
+
+    [[nodiscard]] static bool IsKtx2File(const std::string& filepath);
+
+    // the levelCount smallest levels of the chain, the largest of them goes to ByteData and the
+    // rest to MipLevels. Empty when the file can not be read, holds anything but one 2D image or
+    // stores only part of its mip chain, or a level is not the size its format and extent give.
+    static ImageData Load(const std::string& filepath, uint32_t levelCount = AllLevels);
+};
+} // namespace wind
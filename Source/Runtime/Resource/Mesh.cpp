@@ -7,47 +7,37 @@
 
 namespace wind {
 
-Model::Model(Builder builder)
-    : m_vertexCnt(builder.vertices.size()), m_indexCnt(builder.indices.size()) {
-    vk::DeviceSize vertexBufferSize = sizeof(builder.vertices[0]) * m_vertexCnt;
-    vk::DeviceSize indexBufferSize  = sizeof(builder.indices[0]) * m_indexCnt;
-
-    auto& backend     = RenderBackend::GetInstance();
-    auto& stageBuffer = backend.GetStagingBuffer();
-    auto  cmdBuffer   = backend.BeginSingleTimeCommand();
-
-    m_vertexBuffer = std::make_shared<Buffer>(
-        vertexBufferSize, BufferUsage::VERTEX_BUFFER | BufferUsage::TRANSFER_DESTINATION,
-        MemoryUsage::GPU_ONLY);
-    m_indexBuffer = std::make_shared<Buffer>(
-        indexBufferSize, BufferUsage::INDEX_BUFFER | BufferUsage::TRANSFER_DESTINATION,
-        MemoryUsage::GPU_ONLY);
-
-    const auto vertexAllocation = stageBuffer.Submit(utils::MakeView(builder.vertices));
-    const auto indexAllocation  = stageBuffer.Submit(utils::MakeView(builder.indices));
-
-    cmdBuffer.CopyBuffer(BufferInfo{stageBuffer.GetBuffer(), vertexAllocation.Offset},
-                         BufferInfo{*m_vertexBuffer, 0}, vertexAllocation.Size);
-    cmdBuffer.CopyBuffer(BufferInfo{stageBuffer.GetBuffer(), indexAllocation.Offset},
-                         BufferInfo{*m_indexBuffer, 0}, indexAllocation.Size);
+Model::Model(Builder builder, GeometryPool& geometryPool)
+    : m_geometryPool(&geometryPool), m_vertexCnt(builder.vertices.size()),
+      m_indexCnt(builder.indices.size()) {
+    // frames wait for the copies, the constructor does not
+    m_geometry = m_geometryPool->Allocate(std::as_bytes(utils::MakeView(builder.vertices)),
+                                          builder.indices);
+    (void)RenderBackend::GetInstance().GetUploadContext().Submit();
+
+    m_material      = std::move(builder.material);
+    m_materials     = std::move(builder.materials);
+    m_materialInfos = std::move(builder.materialInfos);
+    m_submeshes     = std::move(builder.submeshes);
+}
 
-    stageBuffer.Flush();
-    backend.SubmitSingleTimeCommand(cmdBuffer.GetNativeHandle());
+Model::~Model() { m_geometryPool->Free(m_geometry); }
 
-    stageBuffer.Reset();
+void Model::Bind(CommandBuffer& cmdbuffer) { m_geometryPool->Bind(cmdbuffer); }
 
-    m_material = builder.material;
+void Model::Draw(CommandBuffer& cmdbuffer) {
+    for (const auto& submesh : m_submeshes) Draw(cmdbuffer, submesh);
 }
 
-Model::~Model() {
-    m_indexBuffer.reset();
-    m_vertexBuffer.reset();
+void Model::Draw(CommandBuffer& cmdbuffer, const Submesh& submesh) {
+    // the submesh indices already point into the vertices of the whole model
+    const auto& range = m_geometryPool->Get(m_geometry);
+    cmdbuffer.DrawIndexed(submesh.indexCount, 1, range.firstIndex + submesh.firstIndex,
+                          range.vertexOffset, 0);
 }
 
-void Model::Bind(CommandBuffer& cmdbuffer) {
-    cmdbuffer.BindVertexBuffers(*m_vertexBuffer);
-    cmdbuffer.BindIndexBufferUInt32(*m_indexBuffer);
+const Material& Model::GetMaterial(const Submesh& submesh) const {
+    return submesh.materialIndex < m_materials.size() ? m_materials[submesh.materialIndex]
+                                                       : m_material;
 }
-
-void Model::Draw(CommandBuffer& cmdbuffer) { cmdbuffer.DrawIndexed(m_indexCnt, 1); }
 } // namespace wind
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include <glm/glm.hpp>
@@ -8,6 +9,7 @@
 
 #include "Runtime/Render/Rhi/Buffer.h"
 #include "Runtime/Render/Rhi/CommandBuffer.h"
+#include "Runtime/Render/Rhi/GeometryPool.h"
 #include "Runtime/Resource/Material.h"
 
 namespace wind {
@@ -65,31 +67,67 @@ struct Vertex {
 
 struct Model {
 public:
+    // one imported mesh, its indices already point into the shared vertex buffer
+    struct Submesh {
+        uint32_t firstIndex;
+        uint32_t indexCount;
+        uint32_t firstVertex;
+        uint32_t vertexCount;
+        uint32_t materialIndex;
+    };
+
+    // material slots of the source file, the texture paths are resolved against its directory and
+    // empty for textures the file embeds or does not have
+    struct MaterialInfo {
+        std::string name;
+        std::string albedoPath;
+        std::string normalPath;
+        std::string metallicPath;
+        std::string roughnessPath;
+    };
+
     struct Builder {
-        std::vector<Vertex>   vertices;
-        std::vector<uint32_t> indices;
-        Material              material;
+        std::vector<Vertex>       vertices;
+        std::vector<uint32_t>     indices;
+        std::vector<Submesh>      submeshes;
+        std::vector<MaterialInfo> materialInfos;
+        // used for every texture a material slot does not name
+        Material                  material;
+        // one per entry of materialInfos, Scene::AddModel loads them
+        std::vector<Material>     materials;
+        // files besides the source the importer read, keys the mesh cache
+        std::vector<std::string>  dependencies;
     };
 
-    Model(Builder builder);
+    // vertices and indices go into a range of the pool, which has to outlive the model
+    Model(Builder builder, GeometryPool& geometryPool);
     ~Model();
 
+    // binds the whole pool, models of the same pool drawn in a row only need it once
     void Bind(CommandBuffer& cmdbuffer);
+    // every submesh, for passes that do not bind materials
     void Draw(CommandBuffer& cmdbuffer);
+    void Draw(CommandBuffer& cmdbuffer, const Submesh& submesh);
 
-    [[nodiscard]] auto GetVerTexBuffer() { return m_vertexBuffer; }
-    [[nodiscard]] auto GetIndexBuffer() { return m_indexBuffer; }
+    [[nodiscard]] auto        GetGeometry() const { return m_geometry; }
+    [[nodiscard]] const auto& GetSubmeshes() const { return m_submeshes; }
+    [[nodiscard]] const auto& GetMaterialInfos() const { return m_materialInfos; }
+    // the material of a submesh, the model wide one when the file has no slot for it
+    [[nodiscard]] const Material& GetMaterial(const Submesh& submesh) const;
 
     void  SetMaterial(const Material& material) { m_material = material; }
     auto& GetMaterial() { return m_material; }
 
 private:
-    std::shared_ptr<Buffer> m_vertexBuffer{nullptr};
-    std::shared_ptr<Buffer> m_indexBuffer{nullptr};
-    Material                m_material;
-    uint32_t                m_vertexCnt{0};
-    uint32_t                m_indexCnt{0};
-    bool                    m_isDynamic{false};
+    GeometryPool*             m_geometryPool{nullptr};
+    GeometryPool::Handle      m_geometry{GeometryPool::InvalidHandle};
+    Material                  m_material;
+    std::vector<Material>     m_materials;
+    std::vector<MaterialInfo> m_materialInfos;
+    std::vector<Submesh>      m_submeshes;
+    uint32_t                  m_vertexCnt{0};
+    uint32_t                  m_indexCnt{0};
+    bool                      m_isDynamic{false};
 };
 
 } // namespace wind
@@ -0,0 +1,348 @@
+#include "MeshCache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "Runtime/Base/Io.h"
+#include "Runtime/Base/Macro.h"
+#include "Runtime/Base/Utils.h"
+
+namespace wind {
+static constexpr uint32_t MeshCacheMagic   = 0x48534D57; // "WMSH"
+static constexpr size_t   SectionAlignment = 16;
+
+enum class MeshCacheKind : uint32_t { GLTFModel = 0, ModelBuilder = 1 };
+
+struct MeshCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t kind;
+    uint32_t vertexSize;
+    uint64_t sourceSize;
+    uint64_t sourceHash;
+};
+
+static bool HashSourceFile(const std::string& sourcePath, uint64_t& size, uint64_t& hash) {
+    io::MappedFile source(sourcePath);
+    if (!source.IsValid()) return false;
+    size = source.GetSize();
+    hash = utils::HashBytes(source.GetView());
+    return true;
+}
+
+// Arrays are stored as a 64 bit count followed by the raw elements at a 16 byte aligned offset.
+// The reader copies them out of the mapped file, the alignment only keeps the layout stable.
+class CacheWriter {
+public:
+    explicit CacheWriter(const std::string& path)
+        : m_file(path, std::ios::binary | std::ios::trunc) {}
+
+    [[nodiscard]] bool IsOpen() const { return m_file.is_open(); }
+    [[nodiscard]] bool IsGood() const { return m_file.good(); }
+
+    template <typename T> void Write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        WriteBytes(&value, sizeof(T));
+    }
+
+    template <typename Container> void WriteArray(const Container& values) {
+        using ValueType = typename Container::value_type;
+        static_assert(std::is_trivially_copyable_v<ValueType>);
+        Write<uint64_t>(values.size());
+        Align();
+        WriteBytes(values.data(), values.size() * sizeof(ValueType));
+    }
+
+private:
+    void Align() {
+        static const char zeros[SectionAlignment]{};
+        WriteBytes(zeros, (SectionAlignment - m_offset % SectionAlignment) % SectionAlignment);
+    }
+
+    void WriteBytes(const void* data, size_t size) {
+        m_file.write(static_cast<const char*>(data), (std::streamsize)size);
+        m_offset += size;
+    }
+
+    std::ofstream m_file;
+    size_t        m_offset = 0;
+};
+
+class CacheReader {
+public:
+    explicit CacheReader(std::span<const uint8_t> data) : m_data(data) {}
+
+    template <typename T> bool Read(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        return ReadBytes(&value, sizeof(T));
+    }
+
+    template <typename Container> bool ReadArray(Container& values) {
+        using ValueType = typename Container::value_type;
+        uint64_t count  = 0;
+        if (!Read(count) || !Align()) return false;
+        if (count > (m_data.size() - m_offset) / sizeof(ValueType)) return false;
+        values.resize(count);
+        return ReadBytes(values.data(), count * sizeof(ValueType));
+    }
+
+private:
+    bool Align() {
+        m_offset = (m_offset + SectionAlignment - 1) / SectionAlignment * SectionAlignment;
+        return m_offset <= m_data.size();
+    }
+
+    bool ReadBytes(void* data, size_t size) {
+        if (size > m_data.size() - m_offset) return false;
+        std::memcpy(data, m_data.data() + m_offset, size);
+        m_offset += size;
+        return true;
+    }
+
+    std::span<const uint8_t> m_data;
+    size_t                   m_offset = 0;
+};
+
+// External buffers and images are keyed by size and modification time, hashing them would cost
+// about as much as the load the cache saves. A missing file is recorded as such.
+struct DependencyStamp {
+    uint64_t size;
+    int64_t  writeTime;
+};
+
+static DependencyStamp StampDependency(const std::string& path) {
+    std::error_code ec;
+    uint64_t        size = std::filesystem::file_size(path, ec);
+    if (ec) return {UINT64_MAX, 0};
+    auto writeTime = std::filesystem::last_write_time(path, ec);
+    if (ec) return {UINT64_MAX, 0};
+    return {size, (int64_t)writeTime.time_since_epoch().count()};
+}
+
+static bool WriteHeader(CacheWriter& writer, const std::string& sourcePath, MeshCacheKind kind,
+                        uint32_t vertexSize, const std::vector<std::string>& dependencies) {
+    MeshCacheHeader header{MeshCacheMagic, MeshCache::Version, (uint32_t)kind, vertexSize, 0, 0};
+    if (!HashSourceFile(sourcePath, header.sourceSize, header.sourceHash)) return false;
+    writer.Write(header);
+
+    writer.Write((uint32_t)dependencies.size());
+    for (const auto& dependency : dependencies) {
+        writer.WriteArray(dependency);
+        writer.Write(StampDependency(dependency));
+    }
+    return true;
+}
+
+static bool ReadHeader(CacheReader& reader, const std::string& sourcePath, MeshCacheKind kind,
+                       uint32_t vertexSize, std::vector<std::string>& dependencies) {
+    MeshCacheHeader header{};
+    if (!reader.Read(header)) return false;
+    if (header.magic != MeshCacheMagic || header.version != MeshCache::Version ||
+        header.kind != (uint32_t)kind || header.vertexSize != vertexSize)
+        return false;
+
+    std::error_code ec;
+    if (std::filesystem::file_size(sourcePath, ec) != header.sourceSize || ec) return false;
+
+    uint64_t sourceSize = 0, sourceHash = 0;
+    if (!HashSourceFile(sourcePath, sourceSize, sourceHash) || sourceHash != header.sourceHash)
+        return false;
+
+    uint32_t dependencyCount = 0;
+    if (!reader.Read(dependencyCount)) return false;
+    dependencies.resize(dependencyCount);
+    for (auto& dependency : dependencies) {
+        DependencyStamp stamp{};
+        if (!reader.ReadArray(dependency) || !reader.Read(stamp)) return false;
+        auto current = StampDependency(dependency);
+        if (current.size != stamp.size || current.writeTime != stamp.writeTime) {
+            WIND_CORE_INFO("{} changed, rebuild the mesh cache of {}", dependency, sourcePath);
+            return false;
+        }
+    }
+    return true;
+}
+
+// map the cache file if it exists, a missing cache is the normal first-run case
+static io::MappedFile OpenCache(const std::string& cachePath) {
+    std::error_code ec;
+    if (!std::filesystem::exists(cachePath, ec)) return {};
+    return io::MappedFile(cachePath);
+}
+
+// write into a temporary file first so a crash never leaves a half written cache behind
+template <typename WriteFunc>
+static void WriteCache(const std::string& sourcePath, MeshCacheKind kind, uint32_t vertexSize,
+                       const std::vector<std::string>& dependencies, WriteFunc&& writeBody) {
+    const auto cachePath = MeshCache::GetCachePath(sourcePath);
+    const auto tempPath  = cachePath + ".tmp";
+    {
+        CacheWriter writer(tempPath);
+        if (!writer.IsOpen()) {
+            WIND_CORE_WARN("Can not write mesh cache {}, skip caching", cachePath);
+            return;
+        }
+        if (!WriteHeader(writer, sourcePath, kind, vertexSize, dependencies)) return;
+        writeBody(writer);
+        if (!writer.IsGood()) {
+            WIND_CORE_WARN("Failed to write mesh cache {}", cachePath);
+            return;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, cachePath, ec);
+    if (ec) {
+        WIND_CORE_WARN("Failed to move mesh cache into place {}: {}", cachePath, ec.message());
+        std::filesystem::remove(tempPath, ec);
+    }
+}
+
+std::string MeshCache::GetCachePath(const std::string& sourcePath) { return sourcePath + ".wmesh"; }
+
+bool MeshCache::Load(const std::string& sourcePath, gltf::GLTFModelData& model) {
+    auto cache = OpenCache(GetCachePath(sourcePath));
+    if (!cache.IsValid()) return false;
+
+    CacheReader reader(cache.GetView());
+    gltf::GLTFModelData result;
+    if (!ReadHeader(reader, sourcePath, MeshCacheKind::GLTFModel, sizeof(gltf::GLTFVertex),
+                    result.dependencies))
+        return false;
+
+    uint32_t            shapeCount = 0, materialCount = 0, textureCount = 0;
+
+    if (!reader.Read(shapeCount)) return false;
+    result.shapes.resize(shapeCount);
+    for (auto& shape : result.shapes) {
+        if (!reader.ReadArray(shape.name) || !reader.Read(shape.materialIndex) ||
+            !reader.ReadArray(shape.vertices) || !reader.ReadArray(shape.indices) ||
+            !reader.ReadArray(shape.meshlets) || !reader.ReadArray(shape.lods))
+            return false;
+    }
+
+    if (!reader.Read(materialCount)) return false;
+    result.materials.resize(materialCount);
+    for (auto& material : result.materials) {
+        uint32_t doubleSided = 0;
+        if (!reader.ReadArray(material.name) || !reader.Read(material.roughnessScale) ||
+            !reader.Read(material.metallicScale) || !reader.Read(doubleSided) ||
+            !reader.Read(material.albedoImage) || !reader.Read(material.normalImage) ||
+            !reader.Read(material.metallicRoughnessImage))
+            return false;
+        material.doubleSided = doubleSided != 0;
+    }
+
+    if (!reader.Read(textureCount)) return false;
+    result.textures.resize(textureCount);
+    for (auto& texture : result.textures) {
+        uint32_t format = 0, mipCount = 0;
+        if (!reader.Read(format) || !reader.Read(texture.Width) || !reader.Read(texture.Height) ||
+            !reader.Read(texture.channels) || !reader.ReadArray(texture.ByteData) ||
+            !reader.Read(mipCount))
+            return false;
+        texture.ImageFormat = (Format)format;
+        texture.MipLevels.resize(mipCount);
+        for (auto& mip : texture.MipLevels) {
+            if (!reader.ReadArray(mip)) return false;
+        }
+    }
+    if (!reader.ReadArray(result.textureHashes)) return false;
+
+    model = std::move(result);
+    WIND_CORE_INFO("Load {} from mesh cache", sourcePath);
+    return true;
+}
+
+bool MeshCache::Load(const std::string& sourcePath, Model::Builder& builder) {
+    auto cache = OpenCache(GetCachePath(sourcePath));
+    if (!cache.IsValid()) return false;
+
+    CacheReader reader(cache.GetView());
+    Model::Builder result;
+    if (!ReadHeader(reader, sourcePath, MeshCacheKind::ModelBuilder, sizeof(Vertex),
+                    result.dependencies))
+        return false;
+
+    uint32_t       materialCount = 0;
+    if (!reader.ReadArray(result.vertices) || !reader.ReadArray(result.indices) ||
+        !reader.ReadArray(result.submeshes) || !reader.Read(materialCount))
+        return false;
+    result.materialInfos.resize(materialCount);
+    for (auto& info : result.materialInfos) {
+        if (!reader.ReadArray(info.name) || !reader.ReadArray(info.albedoPath) ||
+            !reader.ReadArray(info.normalPath) || !reader.ReadArray(info.metallicPath) ||
+            !reader.ReadArray(info.roughnessPath))
+            return false;
+    }
+
+    builder.vertices      = std::move(result.vertices);
+    builder.indices       = std::move(result.indices);
+    builder.submeshes     = std::move(result.submeshes);
+    builder.materialInfos = std::move(result.materialInfos);
+    builder.dependencies  = std::move(result.dependencies);
+    WIND_CORE_INFO("Load {} from mesh cache", sourcePath);
+    return true;
+}
+
+void MeshCache::Save(const std::string& sourcePath, const gltf::GLTFModelData& model) {
+    WriteCache(sourcePath, MeshCacheKind::GLTFModel, sizeof(gltf::GLTFVertex), model.dependencies,
+               [&](CacheWriter& writer) {
+                   writer.Write((uint32_t)model.shapes.size());
+                   for (const auto& shape : model.shapes) {
+                       writer.WriteArray(shape.name);
+                       writer.Write(shape.materialIndex);
+                       writer.WriteArray(shape.vertices);
+                       writer.WriteArray(shape.indices);
+                       writer.WriteArray(shape.meshlets);
+                       writer.WriteArray(shape.lods);
+                   }
+
+                   writer.Write((uint32_t)model.materials.size());
+                   for (const auto& material : model.materials) {
+                       writer.WriteArray(material.name);
+                       writer.Write(material.roughnessScale);
+                       writer.Write(material.metallicScale);
+                       writer.Write((uint32_t)material.doubleSided);
+                       writer.Write(material.albedoImage);
+                       writer.Write(material.normalImage);
+                       writer.Write(material.metallicRoughnessImage);
+                   }
+
+                   writer.Write((uint32_t)model.textures.size());
+                   for (const auto& texture : model.textures) {
+                       writer.Write((uint32_t)texture.ImageFormat);
+                       writer.Write(texture.Width);
+                       writer.Write(texture.Height);
+                       writer.Write(texture.channels);
+                       writer.WriteArray(texture.ByteData);
+                       writer.Write((uint32_t)texture.MipLevels.size());
+                       for (const auto& mip : texture.MipLevels) writer.WriteArray(mip);
+                   }
+                   writer.WriteArray(model.textureHashes);
+               });
+}
+
+void MeshCache::Save(const std::string& sourcePath, const Model::Builder& builder) {
+    // the material holds gpu images and is assigned by the caller, only geometry and the material
+    // slots are cooked
+    WriteCache(sourcePath, MeshCacheKind::ModelBuilder, sizeof(Vertex), builder.dependencies,
+               [&](CacheWriter& writer) {
+                   writer.WriteArray(builder.vertices);
+                   writer.WriteArray(builder.indices);
+                   writer.WriteArray(builder.submeshes);
+                   writer.Write((uint32_t)builder.materialInfos.size());
+                   for (const auto& info : builder.materialInfos) {
+                       writer.WriteArray(info.name);
+                       writer.WriteArray(info.albedoPath);
+                       writer.WriteArray(info.normalPath);
+                       writer.WriteArray(info.metallicPath);
+                       writer.WriteArray(info.roughnessPath);
+                   }
+               });
+}
+} // namespace wind
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "Runtime/Resource/GLTFLoader.h"
+#include "Runtime/Resource/Mesh.h"
+
+namespace wind {
+// Cooked binary copy of a loaded mesh (.wmesh) written next to the source file. It stores the final
+// vertex/index streams, submesh ranges and block compressed material textures, and is keyed by a
+// hash of the source bytes, the size and modification time of every file it depends on (external
+// buffers, images, material libraries) plus the format version, so any change to them silently
+// falls back to a reload.
+class MeshCache {
+public:
+    // bump whenever the layout of the cooked data or of the vertex structs changes
+    static constexpr uint32_t Version = 12;
+
+    static std::string GetCachePath(const std::string& sourcePath);
+
+    static bool Load(const std::string& sourcePath, gltf::GLTFModelData& model);
+    static bool Load(const std::string& sourcePath, Model::Builder& builder);
+    static void Save(const std::string& sourcePath, const gltf::GLTFModelData& model);
+    static void Save(const std::string& sourcePath, const Model::Builder& builder);
+};
+} // namespace wind
@@ -0,0 +1,227 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace wind {
+// murmur style mixing over 32 bit words, vertex structs are made of floats
+static uint64_t HashVertex(const uint8_t* vertex, size_t vertexSize) {
+    constexpr uint64_t multiplier = 0xc6a4a7935bd1e995ull;
+    uint64_t           hash       = vertexSize;
+
+    size_t i = 0;
+    for (; i + sizeof(uint32_t) <= vertexSize; i += sizeof(uint32_t)) {
+        uint32_t word;
+        std::memcpy(&word, vertex + i, sizeof(word));
+        hash = (hash ^ word) * multiplier;
+        hash ^= hash >> 47;
+    }
+    for (; i < vertexSize; ++i) hash = (hash ^ vertex[i]) * multiplier;
+    return hash;
+}
+
+// move every vertex to remap[i], duplicates of a welded vertex write the same value
+template <typename VertexType>
+static void RemapVertices(std::vector<VertexType>& vertices, std::span<const uint32_t> remap,
+                          size_t newCount) {
+    std::vector<VertexType> result(newCount);
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        if (remap[i] != MeshOptimizer::InvalidIndex) result[remap[i]] = vertices[i];
+    }
+    vertices = std::move(result);
+}
+
+template <typename VertexType>
+static MeshOptimizeResult OptimizeMesh(std::vector<VertexType>& vertices,
+                                       std::vector<uint32_t>&   indices) {
+    MeshOptimizeResult result;
+    if (vertices.empty() || indices.size() < 3) return result;
+    assert(indices.size() % 3 == 0);
+
+    result.before = MeshOptimizer::AnalyzeVertexCache(indices, vertices.size());
+
+    std::vector<uint32_t> remap(vertices.size());
+    size_t                vertexCount = MeshOptimizer::GenerateVertexRemap(
+        remap, vertices.data(), vertices.size(), sizeof(VertexType));
+    for (auto& index : indices) index = remap[index];
+    RemapVertices(vertices, remap, vertexCount);
+
+    MeshOptimizer::OptimizeVertexCache(indices, vertices.size());
+
+    remap.resize(vertices.size());
+    vertexCount = MeshOptimizer::OptimizeVertexFetch(remap, indices);
+    RemapVertices(vertices, remap, vertexCount);
+
+    result.after = MeshOptimizer::AnalyzeVertexCache(indices, vertices.size());
+    return result;
+}
+
+MeshOptimizeResult MeshOptimizer::Optimize(gltf::GLTFShape& shape) {
+    return OptimizeMesh(shape.vertices, shape.indices);
+}
+
+MeshOptimizeResult MeshOptimizer::Optimize(Model::Builder& builder) {
+    return OptimizeMesh(builder.vertices, builder.indices);
+}
+
+MeshOptimizeResult MeshOptimizer::OptimizeInPlace(std::span<Vertex>   vertices,
+                                                  std::span<uint32_t> indices) {
+    MeshOptimizeResult result;
+    if (vertices.empty() || indices.size() < 3) return result;
+    assert(indices.size() % 3 == 0);
+
+    result.before = AnalyzeVertexCache(indices, vertices.size());
+    OptimizeVertexCache(indices, vertices.size());
+
+    // unreferenced vertices keep their slots behind the referenced ones so the range size holds
+    std::vector<uint32_t> remap(vertices.size());
+    size_t                vertexCount = OptimizeVertexFetch(remap, indices);
+    for (auto& index : remap) {
+        if (index == InvalidIndex) index = (uint32_t)vertexCount++;
+    }
+    std::vector<Vertex> source(vertices.begin(), vertices.end());
+    for (size_t i = 0; i < source.size(); ++i) vertices[remap[i]] = source[i];
+
+    result.after = AnalyzeVertexCache(indices, vertices.size());
+    return result;
+}
+
+VertexCacheStatistics MeshOptimizer::AnalyzeVertexCache(std::span<const uint32_t> indices,
+                                                        size_t vertexCount, uint32_t cacheSize) {
+    VertexCacheStatistics statistics;
+    statistics.triangleCount = indices.size() / 3;
+
+    // a vertex is cached while fewer than cacheSize misses happened since it was transformed
+    std::vector<uint64_t> missTime(vertexCount, 0);
+    uint64_t              time = cacheSize + 1;
+    for (uint32_t index : indices) {
+        assert(index < vertexCount);
+        if (missTime[index] == 0) ++statistics.vertexCount;
+        if (time - missTime[index] > cacheSize) {
+            missTime[index] = time++;
+            ++statistics.transformedCount;
+        }
+    }
+    return statistics;
+}
+
+size_t MeshOptimizer::GenerateVertexRemap(std::span<uint32_t> remap, const void* vertices,
+                                          size_t vertexCount, size_t vertexSize) {
+    assert(remap.size() >= vertexCount);
+    const auto* bytes = static_cast<const uint8_t*>(vertices);
+
+    // open addressing table of first occurrences, at most half full
+    size_t capacity = 1;
+    while (capacity < vertexCount * 2) capacity <<= 1;
+    std::vector<uint32_t> table(capacity, InvalidIndex);
+
+    size_t uniqueCount = 0;
+    for (size_t i = 0; i < vertexCount; ++i) {
+        const uint8_t* vertex = bytes + i * vertexSize;
+        size_t         slot   = HashVertex(vertex, vertexSize) & (capacity - 1);
+        while (table[slot] != InvalidIndex &&
+               std::memcmp(bytes + table[slot] * vertexSize, vertex, vertexSize) != 0)
+            slot = (slot + 1) & (capacity - 1);
+
+        if (table[slot] == InvalidIndex) {
+            table[slot] = (uint32_t)i;
+            remap[i]    = (uint32_t)uniqueCount++;
+        } else {
+            remap[i] = remap[table[slot]];
+        }
+    }
+    return uniqueCount;
+}
+
+// Tipsify: fan around a vertex, emitting all of its remaining triangles, then continue with the
+// oldest neighbour that will still be cached after its own fan is emitted. Dead ends fall back to
+// recently used vertices and finally to a linear scan. Linear in the number of triangles.
+void MeshOptimizer::OptimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount,
+                                        uint32_t cacheSize) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) return;
+
+    // vertex to triangle adjacency in compressed rows
+    std::vector<uint32_t> liveCount(vertexCount, 0);
+    for (uint32_t index : indices) ++liveCount[index];
+
+    std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v)
+        adjacencyOffset[v + 1] = adjacencyOffset[v] + liveCount[v];
+
+    std::vector<uint32_t> adjacency(indices.size());
+    std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+    for (size_t i = 0; i < indices.size(); ++i) adjacency[fill[indices[i]]++] = (uint32_t)(i / 3);
+
+    std::vector<uint32_t> cacheTime(vertexCount, 0);
+    std::vector<bool>     emitted(triangleCount, false);
+    std::vector<uint32_t> deadEnd;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+
+    uint32_t time   = cacheSize + 1;
+    size_t   cursor = 0;
+
+    auto skipDeadEnd = [&]() -> int64_t {
+        while (!deadEnd.empty()) {
+            uint32_t vertex = deadEnd.back();
+            deadEnd.pop_back();
+            if (liveCount[vertex] > 0) return vertex;
+        }
+        for (; cursor < vertexCount; ++cursor) {
+            if (liveCount[cursor] > 0) return (int64_t)cursor;
+        }
+        return -1;
+    };
+
+    int64_t fanning = skipDeadEnd();
+    while (fanning >= 0) {
+        candidates.clear();
+        for (uint32_t a = adjacencyOffset[fanning]; a < adjacencyOffset[fanning + 1]; ++a) {
+            uint32_t triangle = adjacency[a];
+            if (emitted[triangle]) continue;
+            emitted[triangle] = true;
+
+            for (int corner = 0; corner < 3; ++corner) {
+                uint32_t vertex = indices[triangle * 3 + corner];
+                result.push_back(vertex);
+                deadEnd.push_back(vertex);
+                candidates.push_back(vertex);
+                --liveCount[vertex];
+                if (time - cacheTime[vertex] > cacheSize) cacheTime[vertex] = time++;
+            }
+        }
+
+        // prefer the candidate that stays in the cache while its remaining fan is emitted
+        int64_t next     = -1;
+        int64_t priority = -1;
+        for (uint32_t vertex : candidates) {
+            if (liveCount[vertex] == 0) continue;
+            int64_t age       = time - cacheTime[vertex];
+            int64_t candidate = age + 2 * liveCount[vertex] <= cacheSize ? age : 0;
+            if (candidate > priority) {
+                priority = candidate;
+                next     = vertex;
+            }
+        }
+        fanning = next >= 0 ? next : skipDeadEnd();
+    }
+
+    assert(result.size() == indices.size());
+    std::copy(result.begin(), result.end(), indices.begin());
+}
+
+size_t MeshOptimizer::OptimizeVertexFetch(std::span<uint32_t> remap, std::span<uint32_t> indices) {
+    std::fill(remap.begin(), remap.end(), InvalidIndex);
+
+    size_t vertexCount = 0;
+    for (auto& index : indices) {
+        assert(index < remap.size());
+        if (remap[index] == InvalidIndex) remap[index] = (uint32_t)vertexCount++;
+        index = remap[index];
+    }
+    return vertexCount;
+}
+} // namespace wind
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Runtime/Resource/GLTFLoader.h"
+#include "Runtime/Resource/Mesh.h"
+
+namespace wind {
+// Post-transform cache behaviour of an index buffer, simulated with a FIFO cache. Counts are kept
+// instead of ratios so the statistics of several meshes can simply be summed.
+struct VertexCacheStatistics {
+    uint64_t vertexCount      = 0; // unique vertices referenced by the indices
+    uint64_t triangleCount    = 0;
+    uint64_t transformedCount = 0; // cache misses, i.e. vertex shader invocations
+
+    // average cache miss ratio, transformed vertices per triangle: 3 is the worst case, ~0.5 ideal
+    [[nodiscard]] float GetACMR() const {
+        return triangleCount == 0 ? 0.0f : (float)transformedCount / (float)triangleCount;
+    }
+    // average transformed to vertex ratio, 1 means every vertex is shaded exactly once
+    [[nodiscard]] float GetATVR() const {
+        return vertexCount == 0 ? 0.0f : (float)transformedCount / (float)vertexCount;
+    }
+
+    VertexCacheStatistics& operator+=(const VertexCacheStatistics& other) {
+        vertexCount += other.vertexCount;
+        triangleCount += other.triangleCount;
+        transformedCount += other.transformedCount;
+        return *this;
+    }
+};
+
+struct MeshOptimizeResult {
+    VertexCacheStatistics before;
+    VertexCacheStatistics after;
+};
+
+// Import time mesh optimization: weld bitwise identical vertices, reorder triangles for the
+// post-transform cache with Tipsify (Sander et al. 2007) and reorder vertices into first use order
+// so vertex fetch walks the buffer mostly linearly.
+class MeshOptimizer {
+public:
+    // the size Tipsify optimizes for and the statistics simulate, a conservative guess for the
+    // effective post-transform cache of current GPUs
+    static constexpr uint32_t CacheSize = 16;
+
+    static MeshOptimizeResult Optimize(gltf::GLTFShape& shape);
+    static MeshOptimizeResult Optimize(Model::Builder& builder);
+    // cache and fetch reordering of one already welded range, the vertex count stays the same so
+    // ranges of a shared buffer can be optimized in place and in parallel
+    static MeshOptimizeResult OptimizeInPlace(std::span<Vertex>   vertices,
+                                              std::span<uint32_t> indices);
+
+    static VertexCacheStatistics AnalyzeVertexCache(std::span<const uint32_t> indices,
+                                                    size_t vertexCount,
+                                                    uint32_t cacheSize = CacheSize);
+
+    // remap[i] is the new index of vertex i after welding, returns the welded vertex count
+    static size_t GenerateVertexRemap(std::span<uint32_t> remap, const void* vertices,
+                                      size_t vertexCount, size_t vertexSize);
+    // reorder the triangles of the index buffer in place
+    static void OptimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount,
+                                    uint32_t cacheSize = CacheSize);
+    // number vertices in order of first use and rewrite the indices, unreferenced vertices get
+    // InvalidIndex in remap. Returns the number of referenced vertices.
+    static size_t OptimizeVertexFetch(std::span<uint32_t> remap, std::span<uint32_t> indices);
+
+    static constexpr uint32_t InvalidIndex = ~0u;
+};
+} // namespace wind
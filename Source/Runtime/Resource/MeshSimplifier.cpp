@@ -0,0 +1,178 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <unordered_set>
+
+namespace wind {
+// symmetric 4x4 quadric, error(p) = p^T A p + 2 b.p + c
+struct Quadric {
+    double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+    double b0 = 0, b1 = 0, b2 = 0;
+    double c = 0;
+
+    static Quadric FromPlane(const glm::dvec3& normal, double distance) {
+        return Quadric{normal.x * normal.x, normal.x * normal.y, normal.x * normal.z,
+                       normal.y * normal.y, normal.y * normal.z, normal.z * normal.z,
+                       normal.x * distance, normal.y * distance, normal.z * distance,
+                       distance * distance};
+    }
+
+    Quadric& operator+=(const Quadric& other) {
+        a00 += other.a00, a01 += other.a01, a02 += other.a02;
+        a11 += other.a11, a12 += other.a12, a22 += other.a22;
+        b0 += other.b0, b1 += other.b1, b2 += other.b2;
+        c += other.c;
+        return *this;
+    }
+
+    [[nodiscard]] double Error(const glm::vec3& p) const {
+        double x = p.x, y = p.y, z = p.z;
+        double error = a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z + a11 * y * y +
+                       2 * a12 * y * z + a22 * z * z + 2 * (b0 * x + b1 * y + b2 * z) + c;
+        return std::max(error, 0.0);
+    }
+};
+
+struct Collapse {
+    uint32_t from;
+    uint32_t to;
+    double   cost;
+};
+
+static uint64_t EdgeKey(uint32_t a, uint32_t b) { return (uint64_t)a << 32 | b; }
+
+// the collapse must not turn any remaining triangle around `from` upside down, rotating a normal by
+// more than ~75 degrees already counts so slivers can not flip over a few passes
+static bool FlipsTriangle(const Collapse& collapse, std::span<const uint32_t> indices,
+                          std::span<const uint32_t>  adjacency,
+                          std::span<const glm::vec3> positions) {
+    for (uint32_t triangle : adjacency) {
+        const uint32_t* corners = &indices[triangle * 3];
+        if (corners[0] == collapse.to || corners[1] == collapse.to || corners[2] == collapse.to)
+            continue;
+
+        glm::vec3 before[3], after[3];
+        for (int i = 0; i < 3; ++i) {
+            before[i] = positions[corners[i]];
+            after[i]  = corners[i] == collapse.from ? positions[collapse.to] : before[i];
+        }
+        glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+        glm::vec3 normalAfter  = glm::cross(after[1] - after[0], after[2] - after[0]);
+        float     lengthSq =
+            glm::dot(normalBefore, normalBefore) * glm::dot(normalAfter, normalAfter);
+        if (glm::dot(normalBefore, normalAfter) <= 0.25f * std::sqrt(lengthSq)) return true;
+    }
+    return false;
+}
+
+std::vector<uint32_t> MeshSimplifier::Simplify(std::span<const uint32_t>  indices,
+                                               std::span<const glm::vec3> positions,
+                                               size_t targetIndexCount, float maxError,
+                                               float& resultError) {
+    assert(indices.size() % 3 == 0);
+    const size_t          vertexCount = positions.size();
+    std::vector<uint32_t> result(indices.begin(), indices.end());
+    resultError = 0.0f;
+
+    // one unit weighted plane per adjacent triangle keeps the error in squared distance units
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t i = 0; i < result.size(); i += 3) {
+        glm::dvec3 p0 = positions[result[i]], p1 = positions[result[i + 1]];
+        glm::dvec3 p2     = positions[result[i + 2]];
+        glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+        double     length = std::sqrt(glm::dot(normal, normal));
+        if (length <= 0.0) continue;
+        normal /= length;
+        Quadric plane = Quadric::FromPlane(normal, -glm::dot(normal, p0));
+        for (int corner = 0; corner < 3; ++corner) quadrics[result[i + corner]] += plane;
+    }
+
+    // an edge without its reverse belongs to one triangle only, its vertices must stay put
+    std::vector<bool>            locked(vertexCount, false);
+    std::unordered_set<uint64_t> edges;
+    edges.reserve(result.size());
+    for (size_t i = 0; i < result.size(); i += 3) {
+        for (int e = 0; e < 3; ++e) edges.insert(EdgeKey(result[i + e], result[i + (e + 1) % 3]));
+    }
+    for (size_t i = 0; i < result.size(); i += 3) {
+        for (int e = 0; e < 3; ++e) {
+            uint32_t a = result[i + e], b = result[i + (e + 1) % 3];
+            if (!edges.count(EdgeKey(b, a))) locked[a] = locked[b] = true;
+        }
+    }
+
+    const double          maxCost = (double)maxError * maxError;
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<bool>     touched(vertexCount);
+    std::vector<uint32_t> adjacencyOffset(vertexCount + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<Collapse> collapses;
+
+    // Every pass collapses the cheapest edges whose neighbourhoods do not overlap, so the costs
+    // computed at the start of the pass stay valid. Passes repeat until the target is reached.
+    while (result.size() > targetIndexCount) {
+        std::fill(adjacencyOffset.begin(), adjacencyOffset.end(), 0);
+        for (uint32_t index : result) ++adjacencyOffset[index + 1];
+        for (size_t v = 0; v < vertexCount; ++v) adjacencyOffset[v + 1] += adjacencyOffset[v];
+        adjacency.resize(result.size());
+        std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+        for (size_t i = 0; i < result.size(); ++i) adjacency[fill[result[i]]++] = (uint32_t)(i / 3);
+
+        collapses.clear();
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (int e = 0; e < 3; ++e) {
+                uint32_t a = result[i + e], b = result[i + (e + 1) % 3];
+                for (auto [from, to] : {std::pair{a, b}, std::pair{b, a}}) {
+                    if (locked[from]) continue;
+                    Quadric quadric = quadrics[from];
+                    quadric += quadrics[to];
+                    double cost = quadric.Error(positions[to]);
+                    if (cost <= maxCost) collapses.push_back({from, to, cost});
+                }
+            }
+        }
+        if (collapses.empty()) break;
+        std::sort(collapses.begin(), collapses.end(),
+                  [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+        // every collapse of an interior vertex removes about two triangles
+        size_t collapseBudget = (result.size() - targetIndexCount) / 6 + 1;
+        size_t collapsed      = 0;
+        for (size_t v = 0; v < vertexCount; ++v) remap[v] = (uint32_t)v;
+        std::fill(touched.begin(), touched.end(), false);
+
+        for (const auto& collapse : collapses) {
+            if (collapsed >= collapseBudget) break;
+            if (touched[collapse.from] || touched[collapse.to]) continue;
+
+            std::span<const uint32_t> around(adjacency.data() + adjacencyOffset[collapse.from],
+                                             adjacency.data() + adjacencyOffset[collapse.from + 1]);
+            if (FlipsTriangle(collapse, result, around, positions)) continue;
+
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to] += quadrics[collapse.from];
+            for (uint32_t triangle : around) {
+                for (int corner = 0; corner < 3; ++corner)
+                    touched[result[triangle * 3 + corner]] = true;
+            }
+            resultError = std::max(resultError, (float)std::sqrt(collapse.cost));
+            ++collapsed;
+        }
+        if (collapsed == 0) break;
+
+        // apply the pass and drop the triangles that became degenerate
+        size_t write = 0;
+        for (size_t i = 0; i < result.size(); i += 3) {
+            uint32_t a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+            if (a == b || b == c || a == c) continue;
+            result[write++] = a;
+            result[write++] = b;
+            result[write++] = c;
+        }
+        result.resize(write);
+    }
+    return result;
+}
+} // namespace wind
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace wind {
+// One level of detail of a submesh: a range of its index buffer plus the meshlets covering it.
+// error is the geometric deviation from LOD 0 in mesh units, used for screen space selection.
+struct MeshLod {
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    uint32_t firstMeshlet;
+    uint32_t meshletCount;
+    float    error;
+};
+
+// Quadric error metric simplification (Garland and Heckbert 1997) restricted to half edge
+// collapses, so every LOD is a new index list over the unchanged vertex buffer. Vertices on open
+// edges are locked, which keeps mesh borders and uv / normal seams in place.
+class MeshSimplifier {
+public:
+    static constexpr uint32_t MaxLodCount = 5;
+
+    // Collapse edges until at most targetIndexCount indices remain or the next collapse would
+    // exceed maxError. The reached error is written to resultError.
+    static std::vector<uint32_t> Simplify(std::span<const uint32_t>  indices,
+                                          std::span<const glm::vec3> positions,
+                                          size_t targetIndexCount, float maxError,
+                                          float& resultError);
+};
+} // namespace wind
@@ -0,0 +1,131 @@
+#include "Meshlet.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace wind {
+// cones wider than this barely ever cull, keep the test cheap by disabling them
+static constexpr float MinConeDot = 0.1f;
+
+static void ComputeMeshletBounds(Meshlet& meshlet, std::span<const uint32_t> indices,
+                                 std::span<const glm::vec3> positions, bool doubleSided) {
+    auto triangles = indices.subspan(meshlet.firstIndex, meshlet.indexCount);
+
+    glm::vec3 minimum{std::numeric_limits<float>::max()};
+    glm::vec3 maximum{std::numeric_limits<float>::lowest()};
+    for (uint32_t index : triangles) {
+        minimum = glm::min(minimum, positions[index]);
+        maximum = glm::max(maximum, positions[index]);
+    }
+    meshlet.aabbMin = minimum;
+    meshlet.aabbMax = maximum;
+    meshlet.center  = (minimum + maximum) * 0.5f;
+
+    float radiusSquared = 0.0f;
+    for (uint32_t index : triangles) {
+        glm::vec3 offset = positions[index] - meshlet.center;
+        radiusSquared    = std::max(radiusSquared, glm::dot(offset, offset));
+    }
+    meshlet.radius = std::sqrt(radiusSquared);
+
+    meshlet.coneApex   = meshlet.center;
+    meshlet.coneAxis   = glm::vec3{0.0f};
+    meshlet.coneCutoff = 1.0f;
+    if (doubleSided) return;
+
+    // the cone axis is the average face normal, the cutoff comes from the widest deviation
+    struct Face {
+        glm::vec3 point;
+        glm::vec3 normal;
+    };
+    std::vector<Face> faces;
+    faces.reserve(triangles.size() / 3);
+    glm::vec3 axis{0.0f};
+    for (size_t i = 0; i < triangles.size(); i += 3) {
+        const auto& p0     = positions[triangles[i + 0]];
+        glm::vec3   normal = glm::cross(positions[triangles[i + 1]] - p0,
+                                        positions[triangles[i + 2]] - p0);
+        float       length = std::sqrt(glm::dot(normal, normal));
+        if (length <= 0.0f) continue;
+        faces.push_back({p0, normal / length});
+        axis += faces.back().normal;
+    }
+
+    float axisLength = std::sqrt(glm::dot(axis, axis));
+    if (faces.empty() || axisLength <= 0.0f) return;
+    axis /= axisLength;
+
+    float minDot = 1.0f;
+    for (const auto& face : faces) minDot = std::min(minDot, glm::dot(axis, face.normal));
+    if (minDot <= MinConeDot) return;
+
+    // move the apex back along the axis until it is behind every triangle plane, so the test is
+    // exact for viewers close to the meshlet
+    float maxDistance = 0.0f;
+    for (const auto& face : faces) {
+        float distance = glm::dot(meshlet.center - face.point, face.normal) /
+                         glm::dot(axis, face.normal);
+        maxDistance = std::max(maxDistance, distance);
+    }
+
+    meshlet.coneApex   = meshlet.center - axis * maxDistance;
+    meshlet.coneAxis   = axis;
+    meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+}
+
+std::vector<Meshlet> MeshletBuilder::Build(std::span<const uint32_t>  indices,
+                                           std::span<const glm::vec3> positions,
+                                           bool                       doubleSided) {
+    assert(indices.size() % 3 == 0);
+    std::vector<Meshlet> meshlets;
+    if (indices.empty()) return meshlets;
+
+    // lastMeshlet[v] is the meshlet that last referenced v, so counting new vertices is O(1)
+    std::vector<uint32_t> lastMeshlet(positions.size(), ~0u);
+    uint32_t              current       = 0;
+    uint32_t              vertexCount   = 0;
+    uint32_t              triangleCount = 0;
+    uint32_t              firstIndex    = 0;
+
+    auto finish = [&](uint32_t endIndex) {
+        Meshlet meshlet{};
+        meshlet.firstIndex = firstIndex;
+        meshlet.indexCount = endIndex - firstIndex;
+        ComputeMeshletBounds(meshlet, indices, positions, doubleSided);
+        meshlets.push_back(meshlet);
+
+        firstIndex    = endIndex;
+        vertexCount   = 0;
+        triangleCount = 0;
+        ++current;
+    };
+
+    auto countNewVertices = [&](uint32_t i) {
+        uint32_t count = 0;
+        for (uint32_t corner = 0; corner < 3; ++corner) {
+            uint32_t index = indices[i + corner];
+            bool     seen  = lastMeshlet[index] == current;
+            for (uint32_t previous = 0; previous < corner && !seen; ++previous)
+                seen = indices[i + previous] == index;
+            count += seen ? 0 : 1;
+        }
+        return count;
+    };
+
+    for (uint32_t i = 0; i < indices.size(); i += 3) {
+        uint32_t newVertices = countNewVertices(i);
+        if (vertexCount + newVertices > MaxVertices || triangleCount + 1 > MaxTriangles) {
+            finish(i);
+            newVertices = countNewVertices(i);
+        }
+
+        for (uint32_t corner = 0; corner < 3; ++corner) lastMeshlet[indices[i + corner]] = current;
+        vertexCount += newVertices;
+        ++triangleCount;
+    }
+    finish((uint32_t)indices.size());
+    return meshlets;
+}
+} // namespace wind
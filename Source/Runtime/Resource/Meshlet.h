@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace wind {
+// A cluster of up to MeshletBuilder::MaxVertices vertices / MaxTriangles triangles. Meshlets are
+// contiguous index ranges of their submesh, so a visible run of them is one indexed draw.
+struct Meshlet {
+    uint32_t  firstIndex;
+    uint32_t  indexCount;
+    glm::vec3 center; // bounding sphere
+    float     radius;
+    glm::vec3 aabbMin;
+    glm::vec3 aabbMax;
+    // normal cone: the meshlet is backfacing for every viewer with
+    // dot(normalize(coneApex - viewer), coneAxis) >= coneCutoff. A zero axis never culls.
+    glm::vec3 coneApex;
+    glm::vec3 coneAxis;
+    float     coneCutoff;
+};
+
+class MeshletBuilder {
+public:
+    static constexpr uint32_t MaxVertices  = 64;
+    static constexpr uint32_t MaxTriangles = 124;
+
+    // Split the index buffer into meshlets without reordering it, the vertex cache order produced
+    // by MeshOptimizer is already spatially coherent. Double sided geometry gets no normal cone.
+    static std::vector<Meshlet> Build(std::span<const uint32_t>  indices,
+                                      std::span<const glm::vec3> positions, bool doubleSided);
+};
+} // namespace wind
@@ -0,0 +1,221 @@
+#include "MipGenerator.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include "Runtime/Base/Parallel.h"
+#include "Runtime/Base/Simd.h"
+
+namespace wind {
+using simd::FloatN;
+
+enum class ChannelKind { Linear, Srgb, Normal };
+
+// the encode table is indexed by sqrt(linear), which spreads the dark range that sRGB resolves
+// finely over many entries
+static constexpr size_t EncodeTableSize = 4096;
+static constexpr float  NormalEpsilon   = 1e-12f;
+
+// one float plane per channel, linear values for sRGB channels and [-1, 1] for normals
+struct FloatLevel {
+    uint32_t           width  = 0;
+    uint32_t           height = 0;
+    std::vector<float> texels;
+
+    float* Row(uint32_t channel, uint32_t y) {
+        return texels.data() + ((size_t)channel * height + y) * width;
+    }
+};
+
+static float SrgbToLinear(float value) {
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+static float LinearToSrgb(float value) {
+    return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+}
+
+static const std::array<float, 256>& GetDecodeTable() {
+    static const auto table = [] {
+        std::array<float, 256> result;
+        for (size_t i = 0; i < result.size(); ++i) result[i] = SrgbToLinear(i / 255.0f);
+        return result;
+    }();
+    return table;
+}
+
+static const std::array<uint8_t, EncodeTableSize>& GetEncodeTable() {
+    static const auto table = [] {
+        std::array<uint8_t, EncodeTableSize> result;
+        for (size_t i = 0; i < result.size(); ++i) {
+            float root = i / float(EncodeTableSize - 1);
+            result[i]  = (uint8_t)(LinearToSrgb(root * root) * 255.0f + 0.5f);
+        }
+        return result;
+    }();
+    return table;
+}
+
+static bool IsSrgbFormat(Format format) {
+    return format == Format::R8G8B8A8_SRGB || format == Format::B8G8R8A8_SRGB;
+}
+
+static void DecodeRow(const ImageData& image, uint32_t channels, uint32_t channel,
+                      ChannelKind kind, uint32_t y, float* row) {
+    const uint8_t* source = image.ByteData.data() + ((size_t)y * image.Width) * channels + channel;
+    if (kind == ChannelKind::Srgb) {
+        const auto& decodeTable = GetDecodeTable();
+        for (uint32_t x = 0; x < image.Width; ++x) row[x] = decodeTable[source[x * channels]];
+        return;
+    }
+    float scale = kind == ChannelKind::Normal ? 2.0f / 255.0f : 1.0f / 255.0f;
+    float bias  = kind == ChannelKind::Normal ? -1.0f : 0.0f;
+    for (uint32_t x = 0; x < image.Width; ++x) row[x] = source[x * channels] * scale + bias;
+}
+
+template <typename T>
+WIND_FORCE_INLINE static void FilterTexels(const float* row0, const float* row1,
+                                           float* destination, size_t x) {
+    T sum = simd::LoadPairSum<T>(row0 + 2 * x) + simd::LoadPairSum<T>(row1 + 2 * x);
+    simd::Store(destination + x, sum * T(0.25f));
+}
+
+// destination[x] is the mean of the 2x2 block at 2x, an odd source width drops its last column
+static void FilterRow(const float* row0, const float* row1, float* destination,
+                      uint32_t sourceWidth, uint32_t width) {
+    if (sourceWidth == 1) {
+        destination[0] = (row0[0] + row1[0]) * 0.5f;
+        return;
+    }
+    size_t x = 0;
+    for (; x + FloatN::Width <= width; x += FloatN::Width)
+        FilterTexels<FloatN>(row0, row1, destination, x);
+    for (; x < width; ++x) FilterTexels<float>(row0, row1, destination, x);
+}
+
+// a direction that averaged out entirely falls back to the tangent space z axis
+template <typename T>
+WIND_FORCE_INLINE static void RenormalizeTexels(float* x, float* y, float* z, size_t i) {
+    T nx = simd::Load<T>(x + i), ny = simd::Load<T>(y + i), nz = simd::Load<T>(z + i);
+    T lengthSquared = nx * nx + ny * ny + nz * nz;
+    T scale         = simd::RSqrt(simd::Max(lengthSquared, T(NormalEpsilon)));
+    auto valid      = simd::Greater(lengthSquared, T(NormalEpsilon));
+    simd::Store(x + i, simd::Select(valid, nx * scale, T(0.0f)));
+    simd::Store(y + i, simd::Select(valid, ny * scale, T(0.0f)));
+    simd::Store(z + i, simd::Select(valid, nz * scale, T(1.0f)));
+}
+
+static void RenormalizeLevel(FloatLevel& level) {
+    const size_t texelCount = (size_t)level.width * level.height;
+    float *      x = level.Row(0, 0), *y = level.Row(1, 0), *z = level.Row(2, 0);
+    size_t       i = 0;
+    for (; i + FloatN::Width <= texelCount; i += FloatN::Width)
+        RenormalizeTexels<FloatN>(x, y, z, i);
+    for (; i < texelCount; ++i) RenormalizeTexels<float>(x, y, z, i);
+}
+
+// the rounded integer code of a texel, an index into the encode table for sRGB channels
+template <typename T>
+WIND_FORCE_INLINE static void QuantizeTexels(const float* source, float* destination, size_t i,
+                                             ChannelKind kind) {
+    T value = simd::Load<T>(source + i);
+    if (kind == ChannelKind::Normal) value = value * T(0.5f) + T(0.5f);
+    value = simd::Min(simd::Max(value, T(0.0f)), T(1.0f));
+    value = kind == ChannelKind::Srgb ? simd::Sqrt(value) * T(float(EncodeTableSize - 1))
+                                      : value * T(255.0f);
+    simd::Store(destination + i, value + T(0.5f));
+}
+
+static void EncodeLevel(FloatLevel& level, std::span<const ChannelKind> kinds,
+                        std::vector<uint8_t>& bytes, std::vector<float>& scratch) {
+    const auto&    encodeTable = GetEncodeTable();
+    const uint32_t channels    = (uint32_t)kinds.size();
+    const size_t   texelCount  = (size_t)level.width * level.height;
+    scratch.resize(texelCount);
+
+    for (uint32_t c = 0; c < channels; ++c) {
+        const float* plane = level.Row(c, 0);
+        size_t       i     = 0;
+        for (; i + FloatN::Width <= texelCount; i += FloatN::Width)
+            QuantizeTexels<FloatN>(plane, scratch.data(), i, kinds[c]);
+        for (; i < texelCount; ++i) QuantizeTexels<float>(plane, scratch.data(), i, kinds[c]);
+
+        uint8_t* destination = bytes.data() + c;
+        if (kinds[c] == ChannelKind::Srgb) {
+            for (size_t t = 0; t < texelCount; ++t)
+                destination[t * channels] = encodeTable[(uint32_t)scratch[t]];
+        } else {
+            for (size_t t = 0; t < texelCount; ++t)
+                destination[t * channels] = (uint8_t)scratch[t];
+        }
+    }
+}
+
+bool MipGenerator::IsSupported(const ImageData& image) {
+    const uint32_t channels = FormatToChannelNum(image.ImageFormat);
+    return !image.isHdr && FormatToBlockByteSize(image.ImageFormat) == 0 && channels <= 4 &&
+           image.Width > 0 &&
+           image.ByteData.size() == (size_t)image.Width * image.Height * channels;
+}
+
+void MipGenerator::Generate(ImageData& image, MipOptions::Value options) {
+    image.MipLevels.clear();
+    if (!IsSupported(image)) return;
+
+    const uint32_t             channels = FormatToChannelNum(image.ImageFormat);
+    const bool                 isNormal = (options & MipOptions::NORMAL_MAP) && channels >= 3;
+    std::array<ChannelKind, 4> kinds;
+    for (uint32_t c = 0; c < channels; ++c) {
+        if (c < 3 && isNormal) kinds[c] = ChannelKind::Normal;
+        else if (c < 3 && IsSrgbFormat(image.ImageFormat))
+            kinds[c] = ChannelKind::Srgb;
+        else
+            kinds[c] = ChannelKind::Linear;
+    }
+    std::span<const ChannelKind> channelKinds(kinds.data(), channels);
+
+    // the first level is filtered straight from the bytes two decoded rows at a time, so the base
+    // image never exists as floats. Every later level is filtered from the previous float level.
+    FloatLevel         source, destination;
+    std::vector<float> rows(image.Width * 2), scratch;
+    bool               fromBytes = true;
+
+    source.width  = image.Width;
+    source.height = image.Height;
+    while (source.width > 1 || source.height > 1) {
+        destination.width  = std::max(source.width / 2, 1u);
+        destination.height = std::max(source.height / 2, 1u);
+        destination.texels.resize((size_t)destination.width * destination.height * channels);
+
+        for (uint32_t c = 0; c < channels; ++c) {
+            for (uint32_t y = 0; y < destination.height; ++y) {
+                uint32_t     y0 = std::min(y * 2, source.height - 1);
+                uint32_t     y1 = std::min(y * 2 + 1, source.height - 1);
+                const float *row0, *row1;
+                if (fromBytes) {
+                    DecodeRow(image, channels, c, kinds[c], y0, rows.data());
+                    DecodeRow(image, channels, c, kinds[c], y1, rows.data() + source.width);
+                    row0 = rows.data();
+                    row1 = rows.data() + source.width;
+                } else {
+                    row0 = source.Row(c, y0);
+                    row1 = source.Row(c, y1);
+                }
+                FilterRow(row0, row1, destination.Row(c, y), source.width, destination.width);
+            }
+        }
+        if (isNormal) RenormalizeLevel(destination);
+
+        auto& mip = image.MipLevels.emplace_back(destination.texels.size());
+        EncodeLevel(destination, channelKinds, mip, scratch);
+        std::swap(source, destination);
+        fromBytes = false;
+    }
+}
+
+void MipGenerator::Generate(std::span<ImageData> images, MipOptions::Value options) {
+    utils::ParallelFor(images.size(), [&](size_t i) { Generate(images[i], options); });
+}
+} // namespace wind
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "Runtime/Resource/ImageData.h"
+
+namespace wind {
+struct MipOptions {
+    using Value = uint32_t;
+
+    enum Bits : Value {
+        DEFAULT    = 0,
+        // rgb holds a unit vector, every texel of every level is renormalized
+        NORMAL_MAP = 1 << 0,
+    };
+};
+
+// CPU mip chains with a 2x2 box filter, vectorized over the lanes of Base/Simd.h. Each level is
+// filtered from the float copy of the previous one rather than its quantized bytes, sRGB formats
+// are filtered in linear space with alpha kept linear. The chain goes to ImageData::MipLevels,
+// which ImageLoader::FillImage uploads as is instead of blitting it on the GPU.
+class MipGenerator {
+public:
+    // replace MipLevels with the full chain down to 1x1, 8 bit per channel images only
+    static void Generate(ImageData& image, MipOptions::Value options = MipOptions::DEFAULT);
+    // one image per worker thread
+    static void Generate(std::span<ImageData> images,
+                         MipOptions::Value    options = MipOptions::DEFAULT);
+
+    [[nodiscard]] static bool IsSupported(const ImageData& image);
+};
+} // namespace wind
@@ -0,0 +1,66 @@
+#include "PackedVertex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <glm/gtc/packing.hpp>
+
+namespace wind {
+static uint16_t QuantizeUnorm16(float value) {
+    return (uint16_t)std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f);
+}
+
+static int16_t QuantizeSnorm16(float value) {
+    return (int16_t)std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f);
+}
+
+// Octahedral mapping (Cigolle et al. 2014), a zero vector maps to +z
+static glm::vec2 EncodeOctahedral(const glm::vec3& direction) {
+    float sum = std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z);
+    if (sum <= 0.0f) return glm::vec2{0.0f};
+
+    glm::vec3 n = direction / sum;
+    if (n.z >= 0.0f) return glm::vec2{n.x, n.y};
+
+    auto signNotZero = [](float value) { return value >= 0.0f ? 1.0f : -1.0f; };
+    return glm::vec2{(1.0f - std::abs(n.y)) * signNotZero(n.x),
+                     (1.0f - std::abs(n.x)) * signNotZero(n.y)};
+}
+
+PackedVertexBounds ComputePackedVertexBounds(std::span<const glm::vec3> positions) {
+    if (positions.empty()) return {};
+
+    glm::vec3 minimum{std::numeric_limits<float>::max()};
+    glm::vec3 maximum{std::numeric_limits<float>::lowest()};
+    for (const auto& position : positions) {
+        minimum = glm::min(minimum, position);
+        maximum = glm::max(maximum, position);
+    }
+    return PackedVertexBounds{glm::vec4{minimum, 0.0f}, glm::vec4{maximum - minimum, 0.0f}};
+}
+
+PackedVertex EncodePackedVertex(const PackedVertexBounds& bounds, const glm::vec3& position,
+                                const glm::vec2& texcoord, const glm::vec3& normal,
+                                const glm::vec3& tangent, const glm::vec3& bitangent) {
+    PackedVertex packed{};
+    for (int axis = 0; axis < 3; ++axis) {
+        float extent = bounds.scale[axis];
+        packed.position[axis] =
+            QuantizeUnorm16(extent > 0.0f ? (position[axis] - bounds.offset[axis]) / extent : 0.0f);
+    }
+    float handedness   = glm::dot(glm::cross(normal, tangent), bitangent) < 0.0f ? 0.0f : 1.0f;
+    packed.position[3] = QuantizeUnorm16(handedness);
+
+    glm::vec2 octNormal  = EncodeOctahedral(normal);
+    glm::vec2 octTangent = EncodeOctahedral(tangent);
+    packed.normal[0]     = QuantizeSnorm16(octNormal.x);
+    packed.normal[1]     = QuantizeSnorm16(octNormal.y);
+    packed.tangent[0]    = QuantizeSnorm16(octTangent.x);
+    packed.tangent[1]    = QuantizeSnorm16(octTangent.y);
+
+    packed.texcoord[0] = glm::packHalf1x16(texcoord.x);
+    packed.texcoord[1] = glm::packHalf1x16(texcoord.y);
+    return packed;
+}
+} // namespace wind
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.hpp>
+
+namespace wind {
+// Dequantization constants of one mesh, the vertex shader computes offset + unorm * scale
+struct PackedVertexBounds {
+    glm::vec4 offset{0.0f};
+    glm::vec4 scale{0.0f};
+};
+
+// 20 byte vertex factory for static geometry, decoded in BasePassPacked.vert / ShadowPacked.vert.
+// The bitangent is not stored, it is rebuilt as cross(normal, tangent) * handedness.
+struct PackedVertex {
+    uint16_t position[4]; // unorm16 inside the mesh bounds, w is the handedness (0 => -1, 1 => +1)
+    int16_t  normal[2];   // octahedral, snorm16
+    int16_t  tangent[2];  // octahedral, snorm16
+    uint16_t texcoord[2]; // half float
+
+    static vk::VertexInputBindingDescription GetInputBindingDescription() {
+        vk::VertexInputBindingDescription vertexInputBindingDescription{};
+        vertexInputBindingDescription.setBinding(0)
+            .setStride(sizeof(PackedVertex))
+            .setInputRate(vk::VertexInputRate::eVertex);
+        return vertexInputBindingDescription;
+    };
+
+    static std::vector<vk::VertexInputAttributeDescription> GetVertexInputAttributeDescriptions() {
+        std::vector<vk::VertexInputAttributeDescription> vertexInputAttributeDescription(4);
+
+        vertexInputAttributeDescription[0]
+            .setBinding(0)
+            .setLocation(0)
+            .setFormat(vk::Format::eR16G16B16A16Unorm)
+            .setOffset(offsetof(PackedVertex, position));
+
+        vertexInputAttributeDescription[1]
+            .setBinding(0)
+            .setLocation(1)
+            .setFormat(vk::Format::eR16G16Snorm)
+            .setOffset(offsetof(PackedVertex, normal));
+
+        vertexInputAttributeDescription[2]
+            .setBinding(0)
+            .setLocation(2)
+            .setFormat(vk::Format::eR16G16Snorm)
+            .setOffset(offsetof(PackedVertex, tangent));
+
+        vertexInputAttributeDescription[3]
+            .setBinding(0)
+            .setLocation(3)
+            .setFormat(vk::Format::eR16G16Sfloat)
+            .setOffset(offsetof(PackedVertex, texcoord));
+
+        return vertexInputAttributeDescription;
+    }
+};
+static_assert(sizeof(PackedVertex) == 20);
+
+PackedVertexBounds ComputePackedVertexBounds(std::span<const glm::vec3> positions);
+
+PackedVertex EncodePackedVertex(const PackedVertexBounds& bounds, const glm::vec3& position,
+                                const glm::vec2& texcoord, const glm::vec3& normal,
+                                const glm::vec3& tangent, const glm::vec3& bitangent);
+
+// Works for every vertex struct with position, texcoord, normal, tangent and bitangent members,
+// i.e. gltf::GLTFVertex and wind::Vertex
+template <typename VertexType>
+PackedVertexBounds PackVertices(std::span<const VertexType> vertices,
+                                std::vector<PackedVertex>&  packedVertices) {
+    std::vector<glm::vec3> positions(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) positions[i] = vertices[i].position;
+    PackedVertexBounds bounds = ComputePackedVertexBounds(positions);
+
+    packedVertices.resize(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        const auto& vertex = vertices[i];
+        packedVertices[i]  = EncodePackedVertex(bounds, vertex.position, vertex.texcoord,
+                                                vertex.normal, vertex.tangent, vertex.bitangent);
+    }
+    return bounds;
+}
+} // namespace wind
@@ -0,0 +1,120 @@
+#include "TextureCache.h"
+
+#include <filesystem>
+#include <vector>
+
+#include "Runtime/Base/Macro.h"
+#include "Runtime/Base/Utils.h"
+#include "Runtime/Resource/EnvironmentBaker.h"
+#include "Runtime/Resource/ImageLoader.h"
+
+namespace wind {
+// what the image occupies once uploaded, every level of every layer
+static size_t GetImageByteSize(const Image& image) {
+    const Format format = TryFromNative(image.GetFormat());
+    size_t       size   = 0;
+    for (uint32_t level = 0; level < image.GetMipLevelCount(); ++level)
+        size += GetImageLevelByteSize(format, image.GetMipLevelWidth(level),
+                                      image.GetMipLevelHeight(level));
+    return size * image.GetLayerCount();
+}
+
+TextureCache::Key TextureCache::MakeKey(const std::string& filepath, Format format,
+                                        ImageOptions::Value options) {
+    auto normalized = std::filesystem::path(filepath).lexically_normal().string();
+    return {utils::HashBytes(normalized), format, options};
+}
+
+TextureCache::Key TextureCache::MakeKey(uint64_t contentHash, Format format,
+                                        ImageOptions::Value options) {
+    return {contentHash, format, options};
+}
+
+std::shared_ptr<Image> TextureCache::Find(const Key& key) {
+    if (auto it = m_entries.find(key); it != m_entries.end()) {
+        if (auto image = it->second.image.lock()) {
+            ++m_hits;
+            m_bytesSaved += it->second.byteSize;
+            return image;
+        }
+        m_entries.erase(it);
+    }
+    ++m_misses;
+    return nullptr;
+}
+
+void TextureCache::Insert(const Key& key, const std::shared_ptr<Image>& image) {
+    m_entries[key] = Entry{image, GetImageByteSize(*image)};
+}
+
+std::shared_ptr<Image> TextureCache::LoadFromFile(const std::string& filepath, Format format,
+                                                  ImageOptions::Value options) {
+    auto key = MakeKey(filepath, format, options);
+    if (auto image = Find(key)) return image;
+
+    auto image = std::make_shared<Image>();
+    ImageLoader::FillImage(*image, format, filepath, options);
+    Insert(key, image);
+    return image;
+}
+
+std::shared_ptr<Image> TextureCache::LoadCubemap(const std::string& filepath, Format format) {
+    auto key = MakeKey(filepath, format, ImageOptions::CUBEMAP | ImageOptions::MIPMAPS);
+    if (auto image = Find(key)) return image;
+
+    auto image = std::make_shared<Image>();
+    ImageLoader::LoadCubemap(*image, format, filepath);
+    Insert(key, image);
+    return image;
+}
+
+TextureCache::EnvironmentImages TextureCache::LoadEnvironment(const std::string& filepath) {
+    constexpr Format format        = EnvironmentBaker::CubemapFormat;
+    constexpr auto   options       = ImageOptions::CUBEMAP | ImageOptions::MIPMAPS;
+    auto             specularKey   = MakeKey(filepath, format, options);
+    auto             irradianceKey = MakeKey(filepath + "#irradiance", format, options);
+
+    EnvironmentImages images{Find(specularKey), Find(irradianceKey)};
+    if (images.specular && images.irradiance) return images;
+
+    auto data = EnvironmentBaker::Load(filepath);
+    if (data.Specular.FaceWidth == 0) return {};
+    images.specular   = std::make_shared<Image>();
+    images.irradiance = std::make_shared<Image>();
+    ImageLoader::LoadCubemap(*images.specular, data.Specular);
+    ImageLoader::LoadCubemap(*images.irradiance, data.Irradiance);
+    Insert(specularKey, images.specular);
+    Insert(irradianceKey, images.irradiance);
+    return images;
+}
+
+std::shared_ptr<Image> TextureCache::GetSolidColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+    std::vector<uint8_t> color{r, g, b, a};
+    auto key = MakeKey(utils::HashBytes(color), Format::R8G8B8A8_UNORM, ImageOptions::DEFAULT);
+    if (auto image = Find(key)) return image;
+
+    auto      image = std::make_shared<Image>();
+    ImageData data{std::move(color), Format::R8G8B8A8_UNORM, 1, 1, 4};
+    ImageLoader::FillImage(*image, data, ImageOptions::DEFAULT);
+    Insert(key, image);
+    return image;
+}
+
+TextureCache::Stats TextureCache::GetStats() const {
+    Stats stats{m_hits, m_misses, m_bytesSaved};
+    for (const auto& [key, entry] : m_entries) {
+        if (entry.image.expired()) continue;
+        ++stats.liveCount;
+        stats.liveBytes += entry.byteSize;
+    }
+    return stats;
+}
+
+void TextureCache::LogStats() const {
+    constexpr float MB    = 1024.0f * 1024.0f;
+    auto            stats = GetStats();
+    WIND_CORE_INFO("Texture cache: {} hits, {} misses, {:.1f} MB saved, {} images in {:.1f} MB",
+                   stats.hits, stats.misses, stats.bytesSaved / MB, stats.liveCount,
+                   stats.liveBytes / MB);
+}
+} // namespace wind
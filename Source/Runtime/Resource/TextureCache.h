@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "Runtime/Render/RHI/Image.h"
+
+namespace wind {
+// Shared GPU images keyed by their source (a file path or a hash of the image content) plus the
+// format and image options they were created with. Entries only hold weak references: an image
+// lives as long as some material, skybox or texture array still holds its shared_ptr and is
+// created again on the next request after that. Render thread only.
+class TextureCache {
+public:
+    struct Key {
+        uint64_t            sourceHash;
+        Format              format;
+        ImageOptions::Value options;
+
+        bool operator==(const Key& other) const = default;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return key.sourceHash ^ ((size_t)key.format << 8 | key.options) * 0x9E3779B97F4A7C15ull;
+        }
+    };
+
+    struct EnvironmentImages {
+        std::shared_ptr<Image> specular;
+        std::shared_ptr<Image> irradiance;
+    };
+
+    struct Stats {
+        size_t hits       = 0;
+        size_t misses     = 0;
+        // upload bytes the hits did not have to load and upload again
+        size_t bytesSaved = 0;
+        size_t liveCount  = 0;
+        size_t liveBytes  = 0;
+    };
+
+    static Key MakeKey(const std::string& filepath, Format format, ImageOptions::Value options);
+    static Key MakeKey(uint64_t contentHash, Format format, ImageOptions::Value options);
+
+    // nullptr when the key is not cached or its image was already released, counts a hit or miss
+    std::shared_ptr<Image> Find(const Key& key);
+    // register an image created elsewhere, e.g. by the texture streamer
+    void                   Insert(const Key& key, const std::shared_ptr<Image>& image);
+
+    std::shared_ptr<Image> LoadFromFile(const std::string& filepath, Format format,
+                                        ImageOptions::Value options);
+    std::shared_ptr<Image> LoadCubemap(const std::string& filepath, Format format);
+    // the prefiltered specular and irradiance cubemaps EnvironmentBaker makes of an .hdr or cross
+    EnvironmentImages      LoadEnvironment(const std::string& filepath);
+    // 1x1 rgba8 unorm image, the placeholders every material slot starts on
+    std::shared_ptr<Image> GetSolidColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a);
+
+    [[nodiscard]] Stats GetStats() const;
+    void                LogStats() const;
+
+private:
+    struct Entry {
+        std::weak_ptr<Image> image;
+        size_t               byteSize;
+    };
+
+    std::unordered_map<Key, Entry, KeyHash> m_entries;
+    size_t                                  m_hits       = 0;
+    size_t                                  m_misses     = 0;
+    size_t                                  m_bytesSaved = 0;
+};
+} // namespace wind
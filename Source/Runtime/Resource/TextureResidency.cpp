@@ -0,0 +1,201 @@
+#include "TextureResidency.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Runtime/Render/RHI/Backend.h"
+#include "Runtime/Resource/ImageLoader.h"
+
+namespace wind {
+void TextureResidency::Track(const TextureCache::Key& key, const TextureStreamer::Slot& slot,
+                             std::shared_ptr<const ImageData> source) {
+    if (slot.registryIndex == TextureRegistry::InvalidIndex || !source ||
+        source->ByteData.empty())
+        return;
+    // the image uploaded for this slot is dropped in favour of the one already resident
+    if (Share(key, slot)) return;
+
+    Texture  texture;
+    uint32_t levels = (uint32_t)source->MipLevels.size() + 1;
+    texture.slots   = {slot};
+    texture.image   = (*slot.textures)[slot.index];
+    texture.chainBytes.assign(levels + 1, 0);
+    for (uint32_t level = levels; level-- > 0;) {
+        const auto& bytes = level == 0 ? source->ByteData : source->MipLevels[level - 1];
+        texture.chainBytes[level] = texture.chainBytes[level + 1] + bytes.size();
+    }
+    // the coarsest level that still is at least MinResidentSize, or the last one
+    uint32_t width = source->Width, height = source->Height;
+    while (texture.minResidentMip + 1 < levels &&
+           std::max(width, height) / 2 >= MinResidentSize) {
+        width  = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
+        ++texture.minResidentMip;
+    }
+    texture.source          = std::move(source);
+    texture.lastUsedFrame   = m_frame;
+    texture.lastChangeFrame = m_frame;
+    m_textures[key]         = std::move(texture);
+}
+
+bool TextureResidency::Share(const TextureCache::Key& key, const TextureStreamer::Slot& slot) {
+    auto it = m_textures.find(key);
+    if (slot.registryIndex == TextureRegistry::InvalidIndex || it == m_textures.end())
+        return false;
+    auto& texture = it->second;
+    (*slot.textures)[slot.index] = texture.image;
+    RenderBackend::GetInstance().GetTextureRegistry().Update(slot.registryIndex, texture.image);
+    texture.slots.push_back(slot);
+    return true;
+}
+
+void TextureResidency::Untrack(const std::vector<std::shared_ptr<Image>>* textures) {
+    std::erase_if(m_textures, [this, textures](auto& entry) {
+        Texture& texture = entry.second;
+        std::erase_if(texture.slots, [textures](const TextureStreamer::Slot& slot) {
+            return slot.textures == textures;
+        });
+        if (!texture.slots.empty()) return false;
+        // its resident levels go away with the last table entry sampling them
+        m_releases.push_back({texture.chainBytes[texture.residentMip], m_frame});
+        return true;
+    });
+}
+
+void TextureResidency::CreateFeedbackBuffers() {
+    auto& backend = RenderBackend::GetInstance();
+    for (uint32_t i = 0; i < backend.GetMaxFrameInFlight(); ++i) {
+        auto buffer = std::make_shared<Buffer>(TextureRegistry::MaxTextureCount * sizeof(uint32_t),
+                                               BufferUsage::STORAGE_BUFFER,
+                                               MemoryUsage::GPU_TO_CPU);
+        std::memset(buffer->MapMemory(), 0xFF, buffer->GetByteSize());
+        buffer->FlushMemory();
+        m_feedbackBuffers.push_back(std::move(buffer));
+    }
+}
+
+void TextureResidency::ReadFeedback() {
+    auto& buffer = *m_feedbackBuffers[m_frameIndex];
+    buffer.InvalidateMemory(buffer.GetByteSize(), 0);
+    auto* requestedMips = (uint32_t*)buffer.MapMemory();
+
+    for (auto& [key, texture] : m_textures) {
+        // the finest level any slot sharing the image asks for
+        uint32_t requested = NoFeedback;
+        for (const auto& slot : texture.slots)
+            requested = std::min(requested, requestedMips[slot.registryIndex]);
+        if (requested == NoFeedback) continue;
+        texture.lastUsedFrame = m_frame;
+        // frames recorded before the last change report levels of the previous image
+        if (texture.lastChangeFrame + m_feedbackBuffers.size() >= m_frame) continue;
+        uint32_t levels      = (uint32_t)texture.chainBytes.size() - 1;
+        texture.requestedMip = std::min(texture.residentMip + requested, levels - 1);
+    }
+    std::memset(requestedMips, 0xFF, buffer.GetByteSize());
+    buffer.FlushMemory();
+}
+
+bool TextureResidency::MakeResident(CommandBuffer& commandBuffer, Texture& texture,
+                                    uint32_t mip) {
+    auto&       backend     = RenderBackend::GetInstance();
+    auto&       stageBuffer = backend.GetStagingBuffer();
+    const auto& source      = *texture.source;
+    uint32_t    levels      = (uint32_t)texture.chainBytes.size() - 1;
+    // including the worst case alignment padding FillImage puts in front of every level
+    size_t uploadSize = texture.chainBytes[mip] + (levels - mip) * ImageLoader::ImageCopyAlignment;
+    if (uploadSize > stageBuffer.GetAvailableSize()) return false;
+
+    ImageData image;
+    image.ImageFormat = source.ImageFormat;
+    image.Width       = std::max(source.Width >> mip, 1u);
+    image.Height      = std::max(source.Height >> mip, 1u);
+    image.channels    = source.channels;
+    image.ByteData    = mip == 0 ? source.ByteData : source.MipLevels[mip - 1];
+    image.MipLevels.assign(source.MipLevels.begin() + mip, source.MipLevels.end());
+
+    // the table keeps the previous image alive until no frame in flight samples it
+    auto residentImage = std::make_shared<Image>();
+    ImageLoader::FillImage(commandBuffer, *residentImage, image, ImageOptions::MIPMAPS);
+    for (const auto& slot : texture.slots) {
+        (*slot.textures)[slot.index] = residentImage;
+        backend.GetTextureRegistry().Update(slot.registryIndex, residentImage);
+    }
+    texture.image = std::move(residentImage);
+    m_releases.push_back({texture.chainBytes[texture.residentMip], m_frame});
+
+    texture.residentMip     = mip;
+    texture.lastChangeFrame = m_frame;
+    return true;
+}
+
+void TextureResidency::Update(CommandBuffer& commandBuffer) {
+    auto& backend = RenderBackend::GetInstance();
+    if (m_feedbackBuffers.empty()) CreateFeedbackBuffers();
+    ++m_frame;
+    m_frameIndex = backend.GetCurrentFrameIndex();
+
+    // the frame that wrote this buffer has waited on its fence by now
+    ReadFeedback();
+    if (m_textures.empty()) return;
+
+    // replaced images are released by the texture table one frame after it may reuse their slot
+    std::erase_if(m_releases, [this](const Release& release) {
+        return release.frame + m_feedbackBuffers.size() + 1 < m_frame;
+    });
+    MemoryBudget memory       = GetDeviceMemoryBudget();
+    size_t       budget       = m_budgetOverride != 0 ? m_budgetOverride : memory.budget;
+    auto         evictLimit   = (int64_t)(budget * EvictThreshold);
+    auto         promoteLimit = (int64_t)(budget * PromoteThreshold);
+    // usage as it will be once the replaced images still alive are released
+    auto usage = (int64_t)memory.usage;
+    for (const auto& release : m_releases) usage -= (int64_t)release.byteSize;
+
+    auto isSettled = [this](const Texture& texture) {
+        return texture.lastChangeFrame + m_feedbackBuffers.size() < m_frame;
+    };
+    uint32_t changeCount = 0;
+
+    std::vector<Texture*> candidates;
+    if (usage > evictLimit) {
+        // least recently sampled first, one level per texture and frame
+        for (auto& [key, texture] : m_textures) {
+            if (texture.residentMip < texture.minResidentMip && isSettled(texture))
+                candidates.push_back(&texture);
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const Texture* a, const Texture* b) {
+            return a->lastUsedFrame < b->lastUsedFrame;
+        });
+        for (Texture* texture : candidates) {
+            if (usage <= evictLimit || changeCount == MaxChangesPerFrame) break;
+            uint32_t mip   = texture->residentMip;
+            int64_t  freed = (int64_t)(texture->chainBytes[mip] - texture->chainBytes[mip + 1]);
+            if (!MakeResident(commandBuffer, *texture, mip + 1)) break;
+            usage -= freed;
+            ++changeCount;
+        }
+        return;
+    }
+
+    // most recently sampled first, straight to the requested level
+    for (auto& [key, texture] : m_textures) {
+        if (texture.requestedMip < texture.residentMip && isSettled(texture))
+            candidates.push_back(&texture);
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Texture* a, const Texture* b) {
+        return a->lastUsedFrame > b->lastUsedFrame;
+    });
+    size_t uploaded = 0;
+    for (Texture* texture : candidates) {
+        if (changeCount == MaxChangesPerFrame) break;
+        uint32_t mip   = texture->requestedMip;
+        size_t   bytes = texture->chainBytes[mip];
+        auto     added = (int64_t)(bytes - texture->chainBytes[texture->residentMip]);
+        if (usage + added > promoteLimit) continue;
+        if (uploaded > 0 && uploaded + bytes > UploadBudget) break;
+        if (!MakeResident(commandBuffer, *texture, mip)) break;
+        usage += added;
+        uploaded += bytes;
+        ++changeCount;
+    }
+}
+} // namespace wind
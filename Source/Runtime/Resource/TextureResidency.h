@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "Runtime/Base/Macro.h"
+#include "Runtime/Render/RHI/Buffer.h"
+#include "Runtime/Render/RHI/CommandBuffer.h"
+#include "Runtime/Resource/ImageData.h"
+#include "Runtime/Resource/TextureCache.h"
+#include "Runtime/Resource/TextureStreamer.h"
+
+namespace wind {
+// Keeps the bindless material textures within the device memory budget VMA reports. Every tracked
+// texture keeps its cooked mip chain in host memory and only the levels from residentMip down are
+// on the GPU. Shaders write the finest mip level they would sample into a feedback buffer indexed
+// by the bindless table index, one buffer per frame in flight that is read back once its frame
+// retired. Over budget, the least recently sampled textures drop their top mip until the usage is
+// back under the budget; under budget, textures whose feedback asks for finer levels than resident
+// get them uploaded again within a per frame byte budget. Textures are tracked once per cache key,
+// every slot sampling the same source shares one image and the finest level any of them asks for.
+// Changing the resident levels creates a new image from the host copy and repoints every slot and
+// its table entry at it. Render thread only.
+class TextureResidency {
+public:
+    // evict above this fraction of the budget, promote only while staying below the lower one
+    static constexpr float    EvictThreshold     = 0.9f;
+    static constexpr float    PromoteThreshold   = 0.8f;
+    // bytes uploaded per frame for promotions, a single larger chain is still uploaded alone
+    static constexpr size_t   UploadBudget       = 8 * 1024 * 1024;
+    static constexpr uint32_t MaxChangesPerFrame = 16;
+    // largest dimension every texture keeps resident however far it is evicted
+    static constexpr uint32_t MinResidentSize    = TextureStreamer::PreviewSize;
+    // feedback is written by one pixel of every FeedbackTileSize square, cycling through the tile
+    static constexpr uint32_t FeedbackTileSize   = 8;
+    // entries of the feedback buffer hold the level relative to the bound image, NoFeedback when
+    // the texture was not sampled
+    static constexpr uint32_t NoFeedback         = UINT32_MAX;
+
+    TextureResidency() = default;
+    PERMIT_COPY(TextureResidency)
+    PERMIT_MOVE(TextureResidency)
+
+    // start managing a slot once its full chain is resident, source is the chain the slot's image
+    // was made of. A key already tracked shares its image with the slot instead.
+    void Track(const TextureCache::Key& key, const TextureStreamer::Slot& slot,
+               std::shared_ptr<const ImageData> source);
+    // point the slot and its table entry at the image tracked for key, false when there is none
+    bool Share(const TextureCache::Key& key, const TextureStreamer::Slot& slot);
+    // stop managing every slot of textures, before the vector is cleared or resized
+    void Untrack(const std::vector<std::shared_ptr<Image>>* textures);
+    // call once per frame on the render thread after the frame command buffer began
+    void Update(CommandBuffer& commandBuffer);
+    // 0 uses the budget VMA reports for the device local heaps
+    void SetBudget(size_t byteSize) { m_budgetOverride = byteSize; }
+
+    // the feedback buffer of the current frame, bound as a storage buffer of uints
+    [[nodiscard]] const auto& GetFeedbackBuffer() const { return m_feedbackBuffers[m_frameIndex]; }
+    // selects the pixel of every feedback tile that writes this frame
+    [[nodiscard]] uint32_t    GetFeedbackFrame() const { return (uint32_t)m_frame; }
+
+private:
+    struct Texture {
+        std::vector<TextureStreamer::Slot> slots;
+        std::shared_ptr<Image>             image;
+        std::shared_ptr<const ImageData>   source;
+        // bytes of the chain from each level down, one past the end is 0
+        std::vector<size_t>                chainBytes;
+        uint32_t                           residentMip     = 0;
+        uint32_t                           minResidentMip  = 0;
+        uint32_t                           requestedMip    = 0;
+        uint64_t                           lastUsedFrame   = 0;
+        uint64_t                           lastChangeFrame = 0;
+    };
+
+    struct Release {
+        size_t   byteSize;
+        uint64_t frame;
+    };
+
+    void CreateFeedbackBuffers();
+    void ReadFeedback();
+    bool MakeResident(CommandBuffer& commandBuffer, Texture& texture, uint32_t mip);
+
+    std::unordered_map<TextureCache::Key, Texture, TextureCache::KeyHash> m_textures;
+    std::vector<std::shared_ptr<Buffer>>                                 m_feedbackBuffers;
+    std::vector<Release>                                                 m_releases;
+    size_t                                                               m_budgetOverride = 0;
+    uint32_t                                                             m_frameIndex     = 0;
+    uint64_t                                                             m_frame          = 0;
+};
+} // namespace wind
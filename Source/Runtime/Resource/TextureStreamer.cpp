@@ -0,0 +1,203 @@
+#include "TextureStreamer.h"
+
+#include <algorithm>
+
+#include "Runtime/Base/Parallel.h"
+#include "Runtime/Render/RHI/Backend.h"
+#include "Runtime/Resource/ImageLoader.h"
+
+namespace wind {
+// including the worst case alignment padding FillImage puts in front of every level
+static size_t GetUploadSize(const ImageData& image) {
+    size_t size = image.ByteData.size() + ImageLoader::ImageCopyAlignment;
+    for (const auto& mip : image.MipLevels) size += mip.size() + ImageLoader::ImageCopyAlignment;
+    return size;
+}
+
+// the tail of the mip chain starting at the first level that fits into maxSize, empty when the
+// full image is already that small
+static ImageData ExtractPreview(const ImageData& image, uint32_t maxSize) {
+    uint32_t width = image.Width, height = image.Height;
+    size_t   level = 0;
+    while (std::max(width, height) > maxSize && level < image.MipLevels.size()) {
+        width  = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
+        ++level;
+    }
+    if (level == 0) return {};
+
+    ImageData preview;
+    preview.ByteData    = image.MipLevels[level - 1];
+    preview.ImageFormat = image.ImageFormat;
+    preview.Width       = width;
+    preview.Height      = height;
+    preview.channels    = image.channels;
+    preview.MipLevels.assign(image.MipLevels.begin() + level, image.MipLevels.end());
+    return preview;
+}
+
+TextureStreamer::TextureStreamer() {
+    // leave half of the cores to the render thread and the scene loading running beside us
+    size_t workerCount = std::max<size_t>(1, utils::GetWorkerCount() / 2);
+    for (size_t i = 0; i < workerCount; ++i) m_workers.emplace_back([this] { WorkerLoop(); });
+}
+
+TextureStreamer::~TextureStreamer() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wakeup.notify_all();
+    for (auto& worker : m_workers) worker.join();
+}
+
+void TextureStreamer::Request(std::vector<uint8_t> encoded, Format format,
+                              MipOptions::Value mipOptions, std::vector<Slot> slots) {
+    auto load = [encoded = std::move(encoded), format, mipOptions] {
+        ImageData image = ImageLoader::LoadImageDataFromMemory(encoded, format);
+        MipGenerator::Generate(image, mipOptions);
+        return std::make_shared<const ImageData>(std::move(image));
+    };
+    Enqueue({std::move(load), std::move(slots), {}});
+}
+
+void TextureStreamer::Request(std::shared_ptr<const ImageData> image, std::vector<Slot> slots,
+                              UploadedCallback onUploaded) {
+    Enqueue({[image = std::move(image)] { return image; }, std::move(slots),
+             std::move(onUploaded)});
+}
+
+void TextureStreamer::Enqueue(DecodeJob job) {
+    if (m_pendingCount == 0) m_streamStart = std::chrono::steady_clock::now();
+    ++m_pendingCount;
+    {
+        std::lock_guard lock(m_mutex);
+        job.sequence = ++m_sequence;
+        m_jobs.push_back(std::move(job));
+    }
+    m_wakeup.notify_one();
+}
+
+void TextureStreamer::Cancel(const std::vector<std::shared_ptr<Image>>* textures) {
+    std::lock_guard lock(m_mutex);
+    m_cancellations[textures] = m_sequence;
+}
+
+void TextureStreamer::DropCancelled(std::vector<Slot>& slots, uint64_t sequence) const {
+    std::erase_if(slots, [this, sequence](const Slot& slot) {
+        auto it = m_cancellations.find(slot.textures);
+        return it != m_cancellations.end() && sequence <= it->second;
+    });
+}
+
+void TextureStreamer::WorkerLoop() {
+    while (true) {
+        DecodeJob job;
+        {
+            std::unique_lock lock(m_mutex);
+            m_wakeup.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+            if (m_stopping) return;
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+            // nothing left to load for, the empty final upload only settles the pending count
+            DropCancelled(job.slots, job.sequence);
+            if (job.slots.empty()) {
+                m_finalUploads.push_back({{}, {}, true, {}, job.sequence});
+                continue;
+            }
+        }
+
+        auto image = job.load();
+        job.load   = {};
+        if (image && image->ByteData.empty()) image = nullptr;
+        ImageData preview = image ? ExtractPreview(*image, PreviewSize) : ImageData{};
+
+        std::lock_guard lock(m_mutex);
+        if (!preview.ByteData.empty())
+            m_previewUploads.push_back({std::make_shared<const ImageData>(std::move(preview)),
+                                        job.slots, false, {}, job.sequence});
+        m_finalUploads.push_back({std::move(image), std::move(job.slots), true,
+                                  std::move(job.onUploaded), job.sequence});
+    }
+}
+
+bool TextureStreamer::PopUpload(Upload& upload) {
+    std::lock_guard lock(m_mutex);
+    auto&           queue = m_previewUploads.empty() ? m_finalUploads : m_previewUploads;
+    if (queue.empty()) return false;
+    upload = std::move(queue.front());
+    queue.pop_front();
+    // a cancelled request is dropped like a failed decode
+    DropCancelled(upload.slots, upload.sequence);
+    if (upload.slots.empty()) {
+        upload.image      = nullptr;
+        upload.onUploaded = {};
+    }
+    return true;
+}
+
+void TextureStreamer::Update(CommandBuffer& commandBuffer) {
+    auto& backend = RenderBackend::GetInstance();
+    ++m_frame;
+
+    // every frame that could still sample a replaced image has waited on its fence by now
+    std::erase_if(m_retiredImages, [this, &backend](const RetiredImage& retired) {
+        return retired.frame + backend.GetMaxFrameInFlight() < m_frame;
+    });
+
+    if (m_pendingCount == 0) return;
+
+    auto&  stageBuffer = backend.GetStagingBuffer();
+    size_t uploaded    = 0;
+    Upload upload;
+    while (uploaded < UploadBudget && PopUpload(upload)) {
+        if (!upload.image) {
+            // a failed decode or a cancelled request, the placeholder stays
+            if (upload.isFinal) --m_pendingCount;
+            continue;
+        }
+        const auto& imageData  = *upload.image;
+        size_t      uploadSize = GetUploadSize(imageData);
+        // levels are staged one at a time, the ring waits for room between them
+        size_t levelSize = imageData.ByteData.size();
+        for (const auto& mip : imageData.MipLevels) levelSize = std::max(levelSize, mip.size());
+
+        if (levelSize + ImageLoader::ImageCopyAlignment > stageBuffer.GetByteSize()) {
+            WIND_CORE_WARN("Texture of {}x{} does not fit the staging buffer", imageData.Width,
+                           imageData.Height);
+            if (upload.isFinal) --m_pendingCount;
+            continue;
+        }
+        // the first upload of a frame may wait on the GPU for staging room, the others do not
+        if (uploaded > 0 && (uploadSize > stageBuffer.GetAvailableSize() ||
+                             uploaded + uploadSize > UploadBudget)) {
+            std::lock_guard lock(m_mutex);
+            (upload.isFinal ? m_finalUploads : m_previewUploads).push_front(std::move(upload));
+            break;
+        }
+
+        auto image = std::make_shared<Image>();
+        ImageLoader::FillImage(commandBuffer, *image, imageData, ImageOptions::MIPMAPS);
+        for (const auto& slot : upload.slots) {
+            auto& texture = (*slot.textures)[slot.index];
+            m_retiredImages.push_back({std::move(texture), m_frame});
+            texture = image;
+            if (slot.registryIndex != TextureRegistry::InvalidIndex)
+                backend.GetTextureRegistry().Update(slot.registryIndex, image);
+        }
+        if (upload.onUploaded) upload.onUploaded(image);
+        uploaded += uploadSize;
+
+        if (upload.isFinal) {
+            ++m_uploadedCount;
+            if (--m_pendingCount == 0) {
+                auto elapsed = std::chrono::duration<float>(std::chrono::steady_clock::now() -
+                                                            m_streamStart);
+                WIND_CORE_INFO("Streamed {} textures in {:.2f}s", m_uploadedCount,
+                               elapsed.count());
+                m_uploadedCount = 0;
+            }
+        }
+    }
+}
+} // namespace wind
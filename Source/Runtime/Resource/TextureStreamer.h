@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Runtime/Base/Macro.h"
+#include "Runtime/Render/RHI/CommandBuffer.h"
+#include "Runtime/Render/RHI/Image.h"
+#include "Runtime/Render/RHI/TextureRegistry.h"
+#include "Runtime/Resource/ImageData.h"
+#include "Runtime/Resource/MipGenerator.h"
+
+namespace wind {
+// Background loading for vectors of images that are bound every frame, optionally mirrored into the
+// bindless texture table. Slots start on a placeholder owned by the caller, images are decoded (or
+// handed over already cooked) on worker threads and uploaded from the frame command buffer within a
+// per frame byte budget. Every image is uploaded twice: first a preview made of its coarse mips,
+// then the full mip chain, and all pending previews go before any full upload. Each upload creates
+// one image shared by all the slots of its request. A replaced image is kept alive until every
+// frame that may still sample it has retired. Cancel drops the slots of a vector from every request
+// made so far, before the vector is cleared or resized.
+class TextureStreamer {
+public:
+    struct Slot {
+        // must not be resized while the request is pending
+        std::vector<std::shared_ptr<Image>>* textures;
+        uint32_t                             index;
+        // bindless table entry pointed at the same image, if any
+        uint32_t                             registryIndex = TextureRegistry::InvalidIndex;
+    };
+    // called on the render thread once the full image is recorded for upload
+    using UploadedCallback = std::function<void(const std::shared_ptr<Image>&)>;
+
+    // bytes uploaded per frame, a single larger image is still uploaded alone
+    static constexpr size_t   UploadBudget = 16 * 1024 * 1024;
+    // largest dimension of the preview mip chain
+    static constexpr uint32_t PreviewSize  = 64;
+
+    TextureStreamer();
+    ~TextureStreamer();
+
+    PERMIT_COPY(TextureStreamer)
+    PERMIT_MOVE(TextureStreamer)
+
+    // decode encoded into format and stream it into every slot, mipOptions selects the filtering
+    void Request(std::vector<uint8_t> encoded, Format format, MipOptions::Value mipOptions,
+                 std::vector<Slot> slots);
+    // stream an already cooked image with its mip chain, block compressed formats included. The
+    // chain is shared, not copied, and kept until its upload is recorded.
+    void Request(std::shared_ptr<const ImageData> image, std::vector<Slot> slots,
+                 UploadedCallback onUploaded = {});
+    // call once per frame on the render thread after the frame command buffer began
+    void Update(CommandBuffer& commandBuffer);
+    // no request made so far writes to textures any more, nor calls its UploadedCallback for it
+    void Cancel(const std::vector<std::shared_ptr<Image>>* textures);
+
+    [[nodiscard]] bool IsIdle() const { return m_pendingCount == 0; }
+
+private:
+    struct DecodeJob {
+        // runs on a worker thread, an empty result keeps the placeholder
+        std::function<std::shared_ptr<const ImageData>()> load;
+        std::vector<Slot>                                 slots;
+        UploadedCallback                                  onUploaded;
+        uint64_t                                          sequence = 0;
+    };
+
+    struct Upload {
+        // null for a failed decode or a cancelled request
+        std::shared_ptr<const ImageData> image;
+        std::vector<Slot>                slots;
+        bool                             isFinal;
+        UploadedCallback                 onUploaded;
+        uint64_t                         sequence = 0;
+    };
+
+    struct RetiredImage {
+        std::shared_ptr<Image> image;
+        uint64_t               frame;
+    };
+
+    void Enqueue(DecodeJob job);
+    void WorkerLoop();
+    bool PopUpload(Upload& upload);
+    // erase the slots cancelled after the request of sequence was made, m_mutex held
+    void DropCancelled(std::vector<Slot>& slots, uint64_t sequence) const;
+
+    std::vector<std::thread> m_workers;
+    std::mutex               m_mutex;
+    std::condition_variable  m_wakeup;
+    std::deque<DecodeJob>    m_jobs;
+    std::deque<Upload>       m_previewUploads;
+    std::deque<Upload>       m_finalUploads;
+    bool                     m_stopping = false;
+    std::atomic<size_t>      m_pendingCount{0};
+    // requests are numbered, a vector cancels every request up to the number it maps to
+    uint64_t                 m_sequence = 0;
+    std::unordered_map<const std::vector<std::shared_ptr<Image>>*, uint64_t> m_cancellations;
+
+    // render thread only
+    std::vector<RetiredImage>             m_retiredImages;
+    uint64_t                              m_frame         = 0;
+    size_t                                m_uploadedCount = 0;
+    std::chrono::steady_clock::time_point m_streamStart;
+};
+} // namespace wind
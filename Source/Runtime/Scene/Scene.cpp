@@ -1,5 +1,9 @@
 #include "Scene.h"
 
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <limits>
 #include <memory>
 #include <random>
 
@@ -9,6 +13,7 @@
 #include "Runtime/Render/RHI/Backend.h"
 #include "Runtime/Resource/GLTFLoader.h"
 #include "Runtime/Resource/ImageLoader.h"
+#include "Runtime/Resource/MeshCache.h"
 #include "Runtime/Scene/Scene.h"
 
 namespace wind {
@@ -16,6 +21,28 @@ SkyBox::SkyBox() {
     skyBoxImage           = std::make_shared<Image>();
     skyBoxIrradianceImage = std::make_shared<Image>();
 }
+void Scene::AddModel(Model::Builder modelBuilder) {
+    auto loadTexture = [this](const std::string& path, Format format,
+                              std::shared_ptr<Image>& texture) {
+        if (path.empty() || !std::filesystem::exists(path)) return;
+        texture = m_textureCache.LoadFromFile(path, format, ImageOptions::MIPMAPS);
+    };
+    modelBuilder.materials.assign(modelBuilder.materialInfos.size(), modelBuilder.material);
+    for (size_t i = 0; i < modelBuilder.materialInfos.size(); ++i) {
+        const auto& info     = modelBuilder.materialInfos[i];
+        auto&       material = modelBuilder.materials[i];
+        loadTexture(info.albedoPath, Format::R8G8B8A8_SRGB, material.albedoTexture);
+        loadTexture(info.normalPath, Format::R8G8B8A8_UNORM, material.normalTexture);
+        loadTexture(info.metallicPath, Format::R8_UNORM, material.metallicTexture);
+        loadTexture(info.roughnessPath, Format::R8_UNORM, material.roughnessTexture);
+    }
+
+    auto model       = std::make_shared<Model>(std::move(modelBuilder), m_modelGeometryPool);
+    auto gameobject  = GameObject::CreateGameObject();
+    gameobject.model = model;
+    m_worldObjects.push_back(std::move(gameobject));
+}
+
 void Scene::AddLightData(const DirectionalLight& directionalLight) {
     m_directionalLights.push_back(directionalLight);
 }
@@ -26,79 +53,133 @@ void Scene::LoadSkyBox(const std::string& skyBoxModelPath, const std::string& sk
                        const std::string& irradianceImagePath) {
     m_skybox               = std::make_shared<SkyBox>();
     Model::Builder builder = io::LoadModelFromFilePath(skyBoxModelPath);
-    ImageLoader::LoadCubemap(*m_skybox->skyBoxImage, Format::R8G8B8A8_UNORM, skyboxImagePath);
-    m_skybox->skyBoxModel = std::make_shared<Model>(builder);
-    ImageLoader::LoadCubemap(*m_skybox->skyBoxIrradianceImage, Format::R8G8B8A8_UNORM,
-                             skyboxImagePath);
+    m_skybox->skyBoxModel  = std::make_shared<Model>(std::move(builder), m_modelGeometryPool);
+    // both IBL cubemaps are baked from the sky itself, the irradiance image path is not needed
+    auto environment                = m_textureCache.LoadEnvironment(skyboxImagePath);
+    m_skybox->skyBoxImage           = environment.specular;
+    m_skybox->skyBoxIrradianceImage = environment.irradiance;
+    m_textureCache.LogStats();
 }
 
 void Scene::LoadGLTFScene(const std::string& resourceName, std::string_view filePath) {
-    gltf::GLTFModelData model =
-        gltf::GLTFLoader::LoadFromGLTF(R"(..\..\..\..\Assets\Scene\Sponza\glTF\Sponza.gltf)");
-    gltf::GLTFMesh mesh;
-
-    auto& backend       = RenderBackend::GetInstance();
-    auto& stageBuffer   = backend.GetStagingBuffer();
-    auto& commandBuffer = backend.GetCurrentCommands();
+    std::string         sourcePath{filePath};
+    gltf::GLTFModelData model;
+    if (!MeshCache::Load(sourcePath, model)) {
+        model = gltf::GLTFLoader::LoadFromFile(sourcePath);
+        gltf::GLTFLoader::CookTextures(model);
+        MeshCache::Save(sourcePath, model);
+    }
+    // geometry copies run on the transfer queue while the next shapes are packed, the first frame
+    // waits for them
+    auto& backend         = RenderBackend::GetInstance();
+    auto& uploadContext   = backend.GetUploadContext();
+    auto& textureRegistry = backend.GetTextureRegistry();
+
+    // built in place, the texture streamer and residency manager keep pointers to mesh.textures.
+    // A reload drops them from both before the slots change under them.
+    auto& mesh = m_gltfModel[resourceName];
+    m_textureStreamer.Cancel(&mesh.textures);
+    m_textureResidency.Untrack(&mesh.textures);
+    for (uint32_t index : mesh.textureIndices) {
+        if (index != TextureRegistry::InvalidIndex) textureRegistry.Unregister(index);
+    }
+    for (const auto& submesh : mesh.submeshes) m_geometryPool.Free(submesh.geometry);
+    mesh = gltf::GLTFMesh{};
 
-    commandBuffer.Begin();
     for (const auto& shape : model.shapes) {
         auto& submesh = mesh.submeshes.emplace_back();
         // process vertexBuffer
-        submesh.vertexBuffer.Init(shape.vertices.size() * sizeof(gltf::GLTFVertex),
-                                  BufferUsage::VERTEX_BUFFER | BufferUsage::TRANSFER_DESTINATION,
-                                  MemoryUsage::GPU_ONLY);
-        auto vertexAllocation = stageBuffer.Submit(utils::MakeView(shape.vertices));
-        commandBuffer.CopyBuffer(BufferInfo{stageBuffer.GetBuffer(), vertexAllocation.Offset},
-                                 BufferInfo{submesh.vertexBuffer, 0}, vertexAllocation.Size);
-        // process index buffer
-        submesh.indexBuffer.Init(shape.indices.size() * sizeof(uint32_t),
-                                 BufferUsage::INDEX_BUFFER | BufferUsage::TRANSFER_DESTINATION,
-                                 MemoryUsage::GPU_ONLY);
-        auto indexAllocation = stageBuffer.Submit(utils::MakeView(shape.indices));
-        commandBuffer.CopyBuffer(BufferInfo{stageBuffer.GetBuffer(), indexAllocation.Offset},
-                                 BufferInfo{submesh.indexBuffer, 0}, indexAllocation.Size);
+        std::vector<PackedVertex>  packedVertices;
+        std::span<const std::byte> vertexData = std::as_bytes(utils::MakeView(shape.vertices));
+        if constexpr (gltf::GLTFMesh::UsePackedVertex) {
+            submesh.bounds =
+                PackVertices(std::span<const gltf::GLTFVertex>(shape.vertices), packedVertices);
+            vertexData = std::as_bytes(utils::MakeView(packedVertices));
+        }
+        // vertices and indices share the scene mega buffers
+        submesh.geometry      = m_geometryPool.Allocate(vertexData, shape.indices);
         submesh.materialIndex = shape.materialIndex;
+        submesh.doubleSided   = shape.materialIndex < model.materials.size() &&
+                                model.materials[shape.materialIndex].doubleSided;
+        submesh.meshlets      = shape.meshlets;
+        submesh.lods          = shape.lods;
+
+        glm::vec3 minimum{std::numeric_limits<float>::max()};
+        glm::vec3 maximum{std::numeric_limits<float>::lowest()};
+        for (const auto& vertex : shape.vertices) {
+            minimum = glm::min(minimum, vertex.position);
+            maximum = glm::max(maximum, vertex.position);
+        }
+        if (!shape.vertices.empty())
+            submesh.boundingSphere = glm::vec4{(minimum + maximum) * 0.5f,
+                                               glm::length(maximum - minimum) * 0.5f};
     }
 
-    stageBuffer.Flush();
-    commandBuffer.End();
-    backend.SubmitCommandBuffer(commandBuffer);
-    stageBuffer.Reset();
-
-    uint32_t textureIndex = 0;
+    (void)uploadContext.Submit();
+
+    // every texture starts on a shared 1x1 placeholder of its role until it is streamed in
+    auto addTexture = [&](std::shared_ptr<Image> image) {
+        mesh.textureIndices.push_back(textureRegistry.Register(image));
+        mesh.textures.push_back(std::move(image));
+        return (uint32_t)mesh.textures.size() - 1;
+    };
+    std::array<std::shared_ptr<Image>, 3> stubs = {m_textureCache.GetSolidColor(255, 255, 255, 255),
+                                                   m_textureCache.GetSolidColor(127, 127, 255, 255),
+                                                   m_textureCache.GetSolidColor(0, 255, 0, 255)};
+    for (const auto& stub : stubs) addTexture(stub);
+
+    // one slot per texture however many materials sample it, its role is the first one seen
+    std::vector<uint32_t> textureSlots(model.textures.size(), UINT32_MAX);
     for (const auto& material : model.materials) {
-        commandBuffer.Begin();
-        ImageLoader::FillImage(commandBuffer, mesh.textures.emplace_back(), material.albedoTexture,
-                               ImageOptions::MIPMAPS);
-        ImageLoader::FillImage(commandBuffer, mesh.textures.emplace_back(), material.normalTexture,
-                               ImageOptions::MIPMAPS);
-        ImageLoader::FillImage(commandBuffer, mesh.textures.emplace_back(),
-                               material.metallicRoughness, ImageOptions::MIPMAPS);
-
-        mesh.materials.push_back(
-            gltf::GLTFMesh::Material{textureIndex, textureIndex + 1, textureIndex + 2, 1.0f, 1.0f});
-
-        textureIndex += 3;
-        stageBuffer.Flush();
-        commandBuffer.End();
-        backend.SubmitCommandBuffer(commandBuffer);
-        stageBuffer.Reset();
+        int32_t  images[]       = {material.albedoImage, material.normalImage,
+                                   material.metallicRoughnessImage};
+        uint32_t slotIndices[3] = {0, 1, 2};
+        for (uint32_t role = 0; role < 3; ++role) {
+            if (images[role] < 0) continue;
+            auto& slot = textureSlots[images[role]];
+            if (slot == UINT32_MAX) slot = addTexture(stubs[role]);
+            slotIndices[role] = slot;
+        }
+        mesh.materials.push_back(gltf::GLTFMesh::Material{
+            mesh.textureIndices[slotIndices[0]], mesh.textureIndices[slotIndices[1]],
+            mesh.textureIndices[slotIndices[2]], 1.0f, 1.0f});
     }
+
+    // one upload per cooked texture, however many meshes sample it. The cooked chain stays in host
+    // memory for the residency manager to upload evicted levels again.
+    for (size_t i = 0; i < model.textures.size(); ++i) {
+        auto& texture = model.textures[i];
+        if (textureSlots[i] == UINT32_MAX || texture.ByteData.empty()) continue;
+        TextureStreamer::Slot slot{&mesh.textures, textureSlots[i],
+                                   mesh.textureIndices[textureSlots[i]]};
+        auto source = std::make_shared<const ImageData>(std::move(texture));
+
+        // a texture another mesh already holds is shared without streaming it again, along with
+        // the levels the residency manager keeps resident for it
+        auto key = TextureCache::MakeKey(model.textureHashes[i], source->ImageFormat,
+                                         ImageOptions::MIPMAPS);
+        if (m_textureResidency.Share(key, slot)) continue;
+        if (auto image = m_textureCache.Find(key)) {
+            textureRegistry.Update(slot.registryIndex, image);
+            mesh.textures[slot.index] = image;
+            m_textureResidency.Track(key, slot, source);
+            continue;
+        }
+        auto onUploaded = [this, key, slot, source](const std::shared_ptr<Image>& image) {
+            m_textureCache.Insert(key, image);
+            m_textureResidency.Track(key, slot, source);
+        };
+        m_textureStreamer.Request(source, {slot}, onUploaded);
+    }
+
     // generate material rhi buffer
-    commandBuffer.Begin();
-    auto allocatioin    = stageBuffer.Submit(utils::MakeView(mesh.materials));
     mesh.materialBuffer = std::make_shared<Buffer>(
-        sizeof(gltf::GLTFMesh::Material) * gltf::GLTFMesh::MaxMaterialCount,
-        BufferUsage::UNIFORM_BUFFER | BufferUsage::TRANSFER_DESTINATION, MemoryUsage::GPU_ONLY);
-    commandBuffer.CopyBuffer(BufferInfo{stageBuffer.GetBuffer(), allocatioin.Offset},
-                             BufferInfo{*mesh.materialBuffer, 0}, allocatioin.Size);
-    stageBuffer.Flush();
-    commandBuffer.End();
-    backend.SubmitCommandBuffer(commandBuffer);
-    stageBuffer.Reset();
-
-    m_gltfModel[std::string(resourceName)] = std::move(mesh);
+        sizeof(gltf::GLTFMesh::Material) * std::max<size_t>(mesh.materials.size(), 1),
+        BufferUsage::STORAGE_BUFFER | BufferUsage::TRANSFER_DESTINATION, MemoryUsage::GPU_ONLY);
+    uploadContext.CopyToBuffer(std::as_bytes(utils::MakeView(mesh.materials)),
+                               *mesh.materialBuffer);
+    (void)uploadContext.Submit();
+    m_textureCache.LogStats();
 }
 
 void Scene::AddPointLight(const PointLight& pointLight) { m_pointLights.push_back(pointLight); }
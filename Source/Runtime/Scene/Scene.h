@@ -5,9 +5,13 @@
 
 #include "Runtime/Base/Macro.h"
 #include "Runtime/Render/RHI/Buffer.h"
+#include "Runtime/Render/RHI/GeometryPool.h"
 #include "Runtime/Resource/GLTFLoader.h"
 #include "Runtime/Resource/ImageData.h"
 #include "Runtime/Resource/Mesh.h"
+#include "Runtime/Resource/TextureCache.h"
+#include "Runtime/Resource/TextureResidency.h"
+#include "Runtime/Resource/TextureStreamer.h"
 #include "Runtime/Scene/Camera.h"
 #include "Runtime/Scene/GameObject.h"
 #include "Runtime/Scene/Light.h"
@@ -31,12 +35,8 @@ public:
         return world;
     }
 
-    void AddModel(const Model::Builder& modelBuilder) {
-        auto model       = std::make_shared<Model>(modelBuilder);
-        auto gameobject  = GameObject::CreateGameObject();
-        gameobject.model = model;
-        m_worldObjects.push_back(std::move(gameobject));
-    }
+    // the textures the material slots of the file name are loaded on top of modelBuilder.material
+    void AddModel(Model::Builder modelBuilder);
     void AddLightData(const DirectionalLight& directionalLight);
     void AddPointLight(const PointLight& pointLight);
 
@@ -49,6 +49,11 @@ public:
     void LoadGLTFScene(const std::string& resourceName, std::string_view filePath);
 
     auto& GetSkybox() { return m_skybox; }
+    auto& GetTextureStreamer() { return m_textureStreamer; }
+    auto& GetTextureCache() { return m_textureCache; }
+    auto& GetTextureResidency() { return m_textureResidency; }
+    auto& GetGeometryPool() { return m_geometryPool; }
+    auto& GetModelGeometryPool() { return m_modelGeometryPool; }
     auto& GetRequiredGLTFModel(const std::string& resourname) { return m_gltfModel[resourname]; }
     auto  GetPointLightCnt() { return m_pointLights.size(); }
     auto& GetPointLightArray() { return m_pointLights; }
@@ -57,6 +62,9 @@ public:
 
 private:
     Scene() = default;
+    // declared first so the meshes and models holding ranges in them go away before the pools
+    GeometryPool                  m_geometryPool{gltf::GLTFMesh::VertexStride, 1u << 20, 1u << 22};
+    GeometryPool                  m_modelGeometryPool{sizeof(Vertex), 1u << 16, 1u << 18};
     std::vector<GameObject>       m_worldObjects;
     std::shared_ptr<BaseCamera>   m_activeCamera;
     std::vector<DirectionalLight> m_directionalLights;
@@ -64,5 +72,9 @@ private:
     std::shared_ptr<SkyBox>       m_skybox;
     // gltf part
     std::unordered_map<std::string, gltf::GLTFMesh> m_gltfModel;
+    TextureCache                                    m_textureCache;
+    TextureResidency                                m_textureResidency;
+    // declared last so pending uploads stop before the meshes they write into go away
+    TextureStreamer m_textureStreamer;
 };
 } // namespace wind
\ No newline at end of file
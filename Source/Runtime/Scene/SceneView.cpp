@@ -11,7 +11,6 @@
 #include "Runtime/Render/RHI/Image.h"
 #include "Runtime/Render/RHI/Vma.h"
 #include "Runtime/Render/RenderGraph/RenderResource.h"
-#include "Runtime/Resource/ImageLoader.h"
 #include "Runtime/Scene/Light.h"
 #include "Runtime/Scene/SceneView.h"
 
@@ -85,14 +84,10 @@ void SceneView::Init() {
     lightProjectionBuffer = std::make_shared<LightProjectionBuffer>();
     projectPlaneBuffer    = std::make_shared<ProjectPlane>();
 
-    // size_t byteSize, BufferUsage::Value usage, MemoryUsage memoryUsage
-
-    pointLightBuffers = std::make_shared<Buffer>(
-        sizeof(PointLight) * MaxPointLight, BufferUsage::UNIFORM_BUFFER, MemoryUsage::CPU_TO_GPU);
     // Load brdf lut
-    iblBrdfLut = std::make_shared<Image>();
-    ImageLoader::FillImage(*iblBrdfLut, Format::R8G8B8A8_SRGB,
-                           R"(..\..\..\..\Assets\Textures\brdf_lut.dds)", ImageOptions::DEFAULT);
+    iblBrdfLut = Scene::GetWorld().GetTextureCache().LoadFromFile(
+        R"(..\..\..\..\Assets\Textures\brdf_lut.dds)", Format::R8G8B8A8_SRGB,
+        ImageOptions::DEFAULT);
     // InitSceneTextureDesc
     const auto [width, height] = RenderBackend::GetInstance().GetSurfaceExtent();
 
@@ -85,7 +85,6 @@ public:
     std::shared_ptr<SkyBoxUniformBuffer>   skyBoxBuffer;
     std::shared_ptr<LightProjectionBuffer> lightProjectionBuffer;
     std::shared_ptr<ProjectPlane>          projectPlaneBuffer;
-    std::shared_ptr<Buffer>                pointLightBuffers;
 
     // For ibl calc
     std::shared_ptr<Image> iblBrdfLut;
@@ -1,6 +1,6 @@
 set_project("WindEngine")
 
-add_requires("glm", "glfw", "glad", "vulkansdk", "spdlog", 'assimp', 'stb', 'vulkan-memory-allocator', 'spirv-cross', 'imgui', 'tracy')
+add_requires("glm", "glfw", "glad", "vulkansdk", "spdlog", 'assimp', 'stb', 'vulkan-memory-allocator', 'spirv-cross', 'imgui', 'tracy', 'zstd')
 
 add_rules("mode.debug", "mode.release")
 
@@ -8,6 +8,12 @@ add_includedirs("Source/")
 add_includedirs("Source/ThirdParty")
 
 set_languages("cxx20")
+
+option("avx2")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Build the SIMD kernels for AVX2 instead of SSE2")
+option_end()
 set_runtimes("MD")
 
 before_build(function (target) 
@@ -33,5 +39,14 @@ target("Sandbox")
 target("Runtime")
     set_kind("static")
     add_files("Source/Runtime/**.cpp")
-    add_packages("glfw", "glad", "vulkansdk", "spdlog", "assimp", "stb", "vulkan-memory-allocator", "spirv-cross", "imgui")
+    if has_config("avx2") then
+        add_vectorexts("avx2")
+    end
+    add_packages("glfw", "glad", "vulkansdk", "spdlog", "assimp", "stb", "vulkan-memory-allocator", "spirv-cross", "imgui", "zstd")
 
+target("GLTFLoadBenchmark")
+    set_kind("binary")
+    set_default(false)
+    add_files("Source/Benchmark/GLTFLoadBenchmark.cpp")
+    add_packages("glm", "spdlog", "vulkansdk")
+    add_deps("Runtime")